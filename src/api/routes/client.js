@@ -1,101 +1,431 @@
-import { readClientConf, getHttpPort } from '../../lib/config.js';
+import { readClientConf, perInstanceNumber } from '../../lib/config.js';
 import { launchClient } from '../../lib/client.js';
 import { sendJSON, sendSSE } from '../server.js';
 import {
   getClientPort, isClientRunning, isProxyReady, getClientStartedAt,
-  setClientState, clearClientState, getDefaultVerbosity,
-  setProxyReady,
+  setClientState, clearClientState, getDefaultVerbosity, getDefaultPoolSize,
+  setProxyReady, listInstances, setInstanceConnections, setHandshaking, getClientPhase, onPhaseChange,
+  setStandby, getDefaultSupervision,
 } from '../../services/client-state.js';
 import { clearProxyCache } from './proxy.js';
-import { request as httpRequest } from 'http';
-import { classifyEvent, createMilestone, resetClassifier } from '../../lib/event-classifier.js';
+import { startSampler, stopSampler, subscribeStats, getStatsSnapshot } from '../../services/stats-publisher.js';
+import { classifyEvent, createMilestone, createWarning, resetClassifier } from '../../lib/event-classifier.js';
+import { createRestartPolicy, exitReason } from '../../lib/supervisor.js';
+import { summarizeConnections, totalTokensPayed, countReadyConnections } from '../../lib/connections.js';
 import { clientLogger } from '../../lib/logger.js';
+import { metrics } from '../../lib/metrics.js';
+import { startTrace, getStartupHistory, STARTUP_PHASES } from '../../services/startup-history.js';
+import { createBroadcaster } from '../../lib/sse-broadcaster.js';
+import { createLogAggregator } from '../../lib/log-aggregator.js';
 
 // Module state for tracking the running client process handles and events.
 // The shared running/httpPort/startedAt live in services/client-state.js.
 const state = {
-  cleanup: null,
-  kill: null,
-  eventBuffer: [],
-  sseClients: new Set(),
-  proxyPollTimer: null,
+  handles: new Map(),  // instance number → { cleanup, kill, sampling, tracker, trace }
+  supervisor: null,    // { config, launchOpts, roles: Map(instance → 'serving'|'standby'), policies, timers }
 };
 
 // State tracker for detecting milestone transitions from jsonstats
-const lastState = {
-  seqno: 0,
-  tokensPayed: 0,
-  isReady: false,
-  balance: 0,
-  seenFirstSeqno: false,
-  seenFirstStake: false,
-};
-
-function resetStateTracker() {
-  lastState.seqno = 0;
-  lastState.tokensPayed = 0;
-  lastState.isReady = false;
-  lastState.balance = 0;
-  lastState.seenFirstSeqno = false;
-  lastState.seenFirstStake = false;
+function createStateTracker() {
+  return {
+    seqno: 0,
+    tokensPayed: 0,
+    isReady: false,
+    balance: 0,
+    seenFirstSeqno: false,
+    seenFirstStake: false,
+    readyConnections: new Set(),  // indexes of proxy connections last seen ready
+  };
 }
 
 /**
- * Kill all child processes and clean up temp directory.
+ * Kill one instance's child processes and clean up its temp directory.
  * Called on crash exit AND on manual stop — safe to call multiple times.
+ * @param {number} instance
+ * @param {'crashed' | 'stopped'} [outcome='crashed'] - recorded in the startup trace
  */
-function teardown() {
-  if (state.kill) {
-    try { state.kill(); } catch {}
-    state.kill = null;
-  }
-  if (state.cleanup) {
-    try { state.cleanup(); } catch {}
-    state.cleanup = null;
+function teardownInstance(instance, outcome = 'crashed') {
+  const handle = state.handles.get(instance);
+  if (handle) {
+    handle.trace?.finish(outcome);
+    if (handle.kill) {
+      try { handle.kill(); } catch {}
+    }
+    if (handle.cleanup) {
+      try { handle.cleanup(); } catch {}
+    }
+    state.handles.delete(instance);
   }
-  if (state.proxyPollTimer) {
-    clearInterval(state.proxyPollTimer);
-    state.proxyPollTimer = null;
+  stopSampler(instance);
+  clearClientState(instance);
+  clearProxyCache();
+  if (state.handles.size === 0) resetClassifier();
+}
+
+/** Tear down every running instance. */
+function teardown() {
+  for (const instance of [...state.handles.keys()]) {
+    teardownInstance(instance, 'stopped');
   }
   clearClientState();
-  clearProxyCache();
   resetClassifier();
-  resetStateTracker();
 }
 
 const MAX_EVENT_BUFFER = 200;
 
+const sseShed = metrics.counter('cocoon_sse_shed_total', 'SSE messages dropped for / clients disconnected for being slow');
+const events = createBroadcaster({
+  capacity: MAX_EVENT_BUFFER,
+  onShed: (reason) => sseShed.inc({ reason }),
+});
+// Raw binary lines reach tabs as batched log_batch frames (not buffered or replayed)
+const logs = createLogAggregator({ onFrame: (frame) => events.send(frame) });
+
+const sseSubscribers = metrics.gauge('cocoon_sse_subscribers', 'Connected /api/client/events streams');
+const instanceInFlight = metrics.gauge('cocoon_client_inflight_requests', 'In-flight chat completions per client-runner instance');
+const instanceUp = metrics.gauge('cocoon_client_up', 'Client-runner instance is running (1) with its current phase label');
+
+metrics.addCollector(() => {
+  sseSubscribers.set(events.size);
+  instanceInFlight.reset();
+  instanceUp.reset();
+  for (const inst of listInstances()) {
+    instanceInFlight.set({ instance: inst.instance }, inst.inFlight);
+    instanceUp.set({ instance: inst.instance, phase: inst.phase }, 1);
+  }
+});
+
+// Launch → TonLib synced / proxy ready, split by warm (persisted state) vs cold start
+const startupSeconds = metrics.histogram(
+  'cocoon_client_startup_seconds', 'Time from launch to a startup stage',
+  [1, 2.5, 5, 10, 15, 20, 30, 45, 60, 90, 120, 180, 300],
+);
+
+function observeStartup(handle, instance, stage) {
+  const seconds = (Date.now() - handle.launchedAt) / 1000;
+  const start = handle.warmStart ? 'warm' : 'cold';
+  startupSeconds.observe({ stage, start }, seconds);
+  clientLogger.info({ instance, stage, start, seconds }, `Startup: ${stage} after ${seconds.toFixed(1)}s (${start} start)`);
+}
+
+const startupPhaseSeconds = metrics.histogram(
+  'cocoon_client_startup_phase_seconds', 'Time spent in each startup phase until proxy ready',
+  [0.25, 0.5, 1, 2.5, 5, 10, 20, 30, 60, 120],
+);
+
+function observePhases(handle, instance, phases) {
+  const start = handle.warmStart ? 'warm' : 'cold';
+  const timeline = {};
+  for (const { phase, ms } of phases) {
+    if (phase === 'ready') continue;
+    startupPhaseSeconds.observe({ phase, start }, ms / 1000);
+    timeline[phase] = ms;
+  }
+  clientLogger.info({ instance, start, phases: timeline }, 'Startup timeline');
+}
+
 function pushEvent(event) {
-  state.eventBuffer.push(event);
-  if (state.eventBuffer.length > MAX_EVENT_BUFFER) {
-    state.eventBuffer.shift();
+  if (event.level === 'debug') {
+    logs.add(event);
+    return;
   }
-  // Broadcast to all SSE clients
-  for (const client of state.sseClients) {
-    try {
-      sendSSE(client, event);
-    } catch {
-      state.sseClients.delete(client);
+  // Deliver pending log lines first so the stream stays in order
+  logs.flush();
+  events.publish(event);
+}
+
+/**
+ * Turn one /jsonstats sample into milestone events and per-connection state.
+ */
+function trackStats(handle, instance, stats, { tag, label }) {
+  const { tracker } = handle;
+  const connections = summarizeConnections(stats);
+  setInstanceConnections(instance, connections);
+
+  // State tracker: detect milestone transitions
+  if (connections.length > 0) {
+    const seqno = Math.max(...connections.map(c => c.seqno));
+    const tokensPayed = totalTokensPayed(stats);
+
+    // seqno 0 -> 1: registering on-chain
+    if (seqno > 0 && tracker.seqno === 0 && !tracker.seenFirstSeqno) {
+      tracker.seenFirstSeqno = true;
+      handle.trace?.mark('first_seqno');
+      const milestone = createMilestone(`${label}Registering on-chain...`);
+      clientLogger.info(milestone.message);
+      pushEvent(tag(milestone));
+    }
+    tracker.seqno = seqno;
+
+    // tokensPayed went from 0 to >0: stake deposited
+    if (tokensPayed > 0 && tracker.tokensPayed === 0 && !tracker.seenFirstStake) {
+      tracker.seenFirstStake = true;
+      handle.trace?.mark('stake_visible');
+      const amount = tokensPayed.toFixed(2);
+      const milestone = createMilestone(`${label}Stake deposited: ${amount} TON`);
+      clientLogger.info(milestone.message);
+      pushEvent(tag(milestone));
     }
+    tracker.tokensPayed = tokensPayed;
   }
+
+  // Per-connection transitions (only worth reporting with several connections)
+  if (connections.length > 1) {
+    for (const conn of connections) {
+      const was = tracker.readyConnections.has(conn.index);
+      if (conn.ready === was) continue;
+      const name = `${label}Proxy connection ${conn.index + 1}/${connections.length}`;
+      const connEvent = conn.ready
+        ? createMilestone(`${name} ready${conn.address ? ` (${conn.address})` : ''}`)
+        : createWarning(`${name} lost — traffic continues on the remaining connections`);
+      clientLogger.info({ instance, connection: conn.index, ready: conn.ready }, connEvent.message);
+      pushEvent(tag(connEvent));
+    }
+  }
+  tracker.readyConnections = new Set(connections.filter(c => c.ready).map(c => c.index));
+
+  // Instance is usable as soon as any connection is ready
+  if (!isProxyReady(instance) && tracker.readyConnections.size > 0) {
+    setProxyReady(instance);
+    const readyEvent = classifyEvent('connection_ready', null);
+    clientLogger.info({ instance }, readyEvent.message);
+    pushEvent(tag(readyEvent));
+  }
+}
+
+/**
+ * Supervisor (opt-in): restart instances that die, and with a warm standby
+ * move traffic to it as soon as a serving instance dies. The dead instance
+ * is then relaunched as the new standby (roles swap).
+ */
+function onInstanceDown(instance, reason, message) {
+  const sup = state.supervisor;
+  if (!sup) {
+    if (!isClientRunning()) pushEvent(classifyEvent('stopped', { message }));
+    return;
+  }
+  const label = `#${instance} `;
+
+  // Failover: promote a live standby in place of a dead serving instance
+  if (sup.roles.get(instance) === 'serving') {
+    const standby = [...sup.roles].find(([i, role]) => role === 'standby' && state.handles.has(i))?.[0];
+    if (standby !== undefined) {
+      setStandby(standby, false);
+      sup.roles.set(standby, 'serving');
+      sup.roles.set(instance, 'standby');
+      const event = createMilestone(`Failover: traffic moved from #${instance} to standby #${standby}`);
+      clientLogger.warn({ from: instance, to: standby }, event.message);
+      pushEvent({ ...event, instance: standby });
+    }
+  }
+
+  let policy = sup.policies.get(instance);
+  if (!policy) {
+    policy = createRestartPolicy();
+    sup.policies.set(instance, policy);
+  }
+  const decision = policy.onExit(reason);
+  if (decision.action === 'give_up') {
+    const event = classifyEvent('error', { message: `${label}Supervisor stopped restarting: ${decision.why}` });
+    clientLogger.error({ instance, reason }, event.message);
+    pushEvent({ ...event, instance });
+    if (!isClientRunning() && sup.timers.size === 0) {
+      state.supervisor = null;
+      pushEvent(classifyEvent('stopped', { message }));
+    }
+    return;
+  }
+
+  const seconds = Math.round(decision.delayMs / 1000);
+  const event = createWarning(`${label}Restarting in ${seconds}s${reason === 'stake_unconfirmed' ? ' (waiting for stake)' : ''}`);
+  clientLogger.warn({ instance, reason, delayMs: decision.delayMs }, event.message);
+  pushEvent({ ...event, instance });
+
+  const timer = setTimeout(() => {
+    sup.timers.delete(instance);
+    if (state.supervisor !== sup || state.handles.has(instance)) return;
+    try {
+      launchInstance(sup.config, instance, { ...sup.launchOpts, standby: sup.roles.get(instance) === 'standby' });
+    } catch (err) {
+      clientLogger.error({ instance, err: err.message }, 'Supervised restart failed');
+      onInstanceDown(instance, 'crash', `Restart failed: ${err.message}`);
+    }
+  }, decision.delayMs);
+  sup.timers.set(instance, { timer, at: Date.now() + decision.delayMs });
+}
+
+/** Stop supervising (cancels pending restarts). */
+function stopSupervisor() {
+  const sup = state.supervisor;
+  if (!sup) return;
+  for (const { timer } of sup.timers.values()) clearTimeout(timer);
+  state.supervisor = null;
+}
+
+/** Supervisor part of /api/client/status. */
+function supervisorStatus() {
+  const sup = state.supervisor;
+  if (!sup) return { enabled: false };
+  return {
+    enabled: true,
+    standby: [...sup.roles].filter(([, role]) => role === 'standby').map(([i]) => i),
+    restarting: [...sup.timers].map(([instance, { at }]) => ({ instance, at })),
+  };
+}
+
+/**
+ * Launch one router + client-runner pair and wire its events into the
+ * shared event stream. In pool mode events are tagged with their instance.
+ */
+function launchInstance(config, instance, { routerPolicy, verbosity, pooled, persistState, coldStart, standby = false }) {
+  const tag = (event) => (pooled ? { ...event, instance } : event);
+  const label = pooled ? `#${instance} ` : '';
+  const handle = {
+    cleanup: null, kill: null, sampling: false, tracker: createStateTracker(),
+    launchedAt: Date.now(), warmStart: false, synced: false,
+  };
+  // Late events from a previous launch of the same instance must not tear down this one
+  const isCurrent = () => state.handles.get(instance) === handle;
+
+  // Position in the pool picks this instance's entry of per-instance lists (max_coefficient)
+  const poolIndex = instance - parseInt(config.instance || '0', 10);
+  const { cleanup, kill, httpPort, warmStart, ready, phases } = launchClient({ ...config, instance: String(instance), pool_index: String(poolIndex) }, {
+    routerPolicy,
+    verbosity,
+    persistState,
+    coldStart,
+    quiet: true,
+    // Usable as soon as any connection is ready; readiness probes (see
+    // lib/readiness.js) feed milestones and mark the instance ready
+    isReady: (stats) => countReadyConnections(stats) > 0,
+    onProbe: (stats) => { if (stats && isCurrent()) trackStats(handle, instance, stats, { tag, label }); },
+    onEvent: (event, data) => {
+      if (event === 'exit') {
+        const proc = data?.prefix || 'UNKNOWN';
+        const code = data?.code ?? 'null';
+        const last = (data?.lastLines || []).slice(-5).join(' | ');
+        const msg = `${label}${proc} exited (code ${code})${last ? ': ' + last : ''}`;
+        const classified = classifyEvent('exit', { message: msg });
+        clientLogger.info({ proc, code, instance }, classified.message);
+        pushEvent(tag(classified));
+
+        // When CLIENT exits or ROUTER crashes (code !== 0 or signal-killed = null): tear down
+        if (isCurrent() && (proc === 'CLIENT' || (proc === 'ROUTER' && data?.code !== 0))) {
+          teardownInstance(instance);
+          const reason = exitReason(last);
+          // Detect proxy rejection (stake not visible on-chain yet)
+          if (reason === 'stake_unconfirmed') {
+            const hint = state.supervisor ? 'Retrying automatically.' : 'Wait ~60s and try again.';
+            const warnEvent = classifyEvent('error', { message: `Proxy rejected connection — stake may not be confirmed on-chain yet. ${hint}` });
+            clientLogger.warn(warnEvent.message);
+            pushEvent(tag(warnEvent));
+          }
+          onInstanceDown(instance, reason, msg);
+        }
+        return;
+      }
+
+      if (event === 'fatal') {
+        if (!isCurrent()) return;
+        teardownInstance(instance);
+        const fatalEvent = classifyEvent('fatal', data);
+        clientLogger.fatal({ instance }, fatalEvent.message);
+        pushEvent(tag(fatalEvent));
+        onInstanceDown(instance, 'crash', 'Client crashed');
+        return;
+      }
+
+      if (STARTUP_PHASES.includes(event) && isCurrent()) handle.trace?.mark(event);
+
+      if (event === 'ton_synced' && isCurrent() && !handle.synced) {
+        handle.synced = true;
+        observeStartup(handle, instance, 'ton_synced');
+      }
+
+      // Proxy connection setup begins — keep the binary on one-shot sockets
+      if (event === 'proxy_connecting' || event === 'listening') {
+        if (isCurrent()) setHandshaking(instance);
+      }
+
+      // Classify all other events
+      const classified = tag(classifyEvent(event, data));
+      if (classified.level === 'error') {
+        clientLogger.error({ instance }, classified.message);
+      } else if (classified.level === 'warn') {
+        clientLogger.warn({ instance }, classified.message);
+      } else if (classified.level !== 'debug') {
+        clientLogger.info({ instance }, classified.message);
+      } else {
+        clientLogger.debug({ instance }, classified.message);
+      }
+      pushEvent(classified);
+    },
+  });
+
+  handle.cleanup = cleanup;
+  handle.kill = kill;
+  handle.warmStart = warmStart;
+  handle.trace = startTrace(instance, { warm: warmStart });
+
+  // Once ready (or after the readiness timeout), keep the binary sampled:
+  // milestones, per-connection state for status / the WebUI, and the stats
+  // stream to SSE subscribers
+  ready.then((stats) => {
+    if (!isCurrent()) return;
+    if (stats) observePhases(handle, instance, phases());
+    if (!handle.sampling) {
+      handle.sampling = true;
+      startSampler(instance, httpPort, {
+        onSample: (s) => { if (isCurrent()) trackStats(handle, instance, s, { tag, label }); },
+      });
+    }
+  });
+  state.handles.set(instance, handle);
+  setClientState(httpPort, instance, { standby, maxCoefficient: perInstanceNumber(config.max_coefficient, poolIndex) });
+  return httpPort;
 }
 
 export function register(router) {
+  // Stats patches go straight to connected tabs (not into the event buffer)
+  // A tab that had a patch dropped gets the current snapshot instead of the next one
+  subscribeStats((message) => events.send(message, { resync: getStatsSnapshot }));
+
+  // First time an instance becomes usable
+  onPhaseChange(({ instance, phase, prev }) => {
+    if ((phase !== 'ready' && phase !== 'degraded') || (prev !== 'starting' && prev !== 'handshaking')) return;
+    const handle = state.handles.get(instance);
+    if (!handle) return;
+    state.supervisor?.policies.get(instance)?.onHealthy();
+    observeStartup(handle, instance, 'ready');
+    handle.trace?.mark('ready');
+  });
+
   /**
    * GET /api/client/status
    */
   router.get('/api/client/status', async ({ res }) => {
-    const recentEvents = state.eventBuffer.slice(-50);
+    const recentEvents = events.recent(50);
     const startedAt = getClientStartedAt();
     sendJSON(res, 200, {
       running: isClientRunning(),
+      phase: getClientPhase(),
       httpPort: getClientPort(),
       startedAt,
       uptime: startedAt ? Math.floor((Date.now() - startedAt) / 1000) : null,
+      instances: listInstances(),
+      supervisor: supervisorStatus(),
       recentEvents,
     });
   });
 
+  /**
+   * GET /api/client/startup-history
+   * Last recorded launches with per-phase timestamps and p50/p95.
+   */
+  router.get('/api/client/startup-history', async ({ res }) => {
+    sendJSON(res, 200, getStartupHistory());
+  });
+
   /**
    * POST /api/client/start
    * Start the COCOON client (router + client-runner).
@@ -115,146 +445,49 @@ export function register(router) {
     try {
       const routerPolicy = body.routerPolicy || 'any';
       const verbosity = body.verbosity || getDefaultVerbosity();
-
-      state.eventBuffer = [];
-      resetStateTracker();
+      const poolSize = Math.max(1, parseInt(body.instances || getDefaultPoolSize(), 10) || 1);
+      const baseInstance = parseInt(config.instance || '0', 10);
+      const defaults = getDefaultSupervision();
+      const standby = body.standby ?? defaults.standby;
+      const supervise = standby || (body.supervise ?? defaults.supervise);
+      const pooled = poolSize > 1 || standby;
+
+      stopSupervisor();
+      events.clear();
+      logs.reset();
       resetClassifier();
 
-      const { cleanup, kill, httpPort } = launchClient(config, {
-        routerPolicy,
-        verbosity,
-        quiet: true,
-        onEvent: (event, data) => {
-          if (event === 'exit') {
-            const proc = data?.prefix || 'UNKNOWN';
-            const code = data?.code ?? 'null';
-            const last = (data?.lastLines || []).slice(-5).join(' | ');
-            const msg = `${proc} exited (code ${code})${last ? ': ' + last : ''}`;
-            const classified = classifyEvent('exit', { message: msg });
-            clientLogger.info({ proc, code }, classified.message);
-            pushEvent(classified);
-
-            // When CLIENT exits or ROUTER crashes (code !== 0 or signal-killed = null): tear down
-            if (proc === 'CLIENT' || (proc === 'ROUTER' && data?.code !== 0)) {
-              teardown();
-              // Detect proxy rejection (stake not visible on-chain yet)
-              if (last.includes('cancelled') || last.includes('Error : 653')) {
-                const warnEvent = classifyEvent('error', { message: 'Proxy rejected connection — stake may not be confirmed on-chain yet. Wait ~60s and try again.' });
-                clientLogger.warn(warnEvent.message);
-                pushEvent(warnEvent);
-              }
-              pushEvent(classifyEvent('stopped', { message: msg }));
-            }
-            return;
-          }
-
-          if (event === 'fatal') {
-            teardown();
-            const fatalEvent = classifyEvent('fatal', data);
-            clientLogger.fatal(fatalEvent.message);
-            pushEvent(fatalEvent);
-            pushEvent(classifyEvent('stopped', { message: 'Client crashed' }));
-            return;
-          }
-
-          // After TCP connection is up, wait for handshake+auth to finish
-          // before allowing /jsonstats (binary crashes if polled mid-handshake).
-          if (event === 'connection_ready') {
-            setTimeout(() => setProxyReady(), 10_000);
-          }
+      // Restarts reuse these (never with coldStart: only the first launch wipes state)
+      const launchOpts = { routerPolicy, verbosity, pooled, persistState: body.persistState };
+      const ports = [];
+      try {
+        for (let i = 0; i < poolSize; i++) {
+          ports.push(launchInstance(config, baseInstance + i, { ...launchOpts, coldStart: body.coldStart === true }));
+        }
+        // Warm standby on the next free port block
+        if (standby) {
+          launchInstance(config, baseInstance + poolSize, { ...launchOpts, coldStart: body.coldStart === true, standby: true });
+        }
+      } catch (err) {
+        teardown();
+        throw err;
+      }
+      const httpPort = ports[0];
 
-          // Fallback: if connection_ready never fires (e.g. Error 653 during
-          // initial connections), poll the binary directly once listening is up.
-          if (event === 'listening' && !state.proxyPollTimer) {
-            state.proxyPollTimer = setInterval(() => {
-              if (!isClientRunning()) {
-                clearInterval(state.proxyPollTimer);
-                state.proxyPollTimer = null;
-                return;
-              }
-
-              const req = httpRequest(
-                { hostname: '127.0.0.1', port: httpPort, path: '/jsonstats', method: 'GET', timeout: 2000 },
-                (pollRes) => {
-                  const chunks = [];
-                  pollRes.on('data', c => chunks.push(c));
-                  pollRes.on('end', () => {
-                    try {
-                      const stats = JSON.parse(Buffer.concat(chunks).toString());
-                      const conn = stats.proxy_connections?.[0];
-
-                      // State tracker: detect milestone transitions
-                      if (conn) {
-                        const seqno = conn.seqno ?? 0;
-                        const tokensPayed = parseFloat(conn.tokens_payed ?? 0);
-
-                        // seqno 0 -> 1: registering on-chain
-                        if (seqno > 0 && lastState.seqno === 0 && !lastState.seenFirstSeqno) {
-                          lastState.seenFirstSeqno = true;
-                          const milestone = createMilestone('Registering on-chain...');
-                          clientLogger.info(milestone.message);
-                          pushEvent(milestone);
-                        }
-                        lastState.seqno = seqno;
-
-                        // tokensPayed went from 0 to >0: stake deposited
-                        if (tokensPayed > 0 && lastState.tokensPayed === 0 && !lastState.seenFirstStake) {
-                          lastState.seenFirstStake = true;
-                          const amount = tokensPayed.toFixed(2);
-                          const milestone = createMilestone(`Stake deposited: ${amount} TON`);
-                          clientLogger.info(milestone.message);
-                          pushEvent(milestone);
-                        }
-                        lastState.tokensPayed = tokensPayed;
-                      }
-
-                      // Existing proxy readiness check
-                      if (!isProxyReady() && conn?.is_ready) {
-                        setProxyReady();
-                        if (!state.proxyPollTimer) return;
-                        const readyEvent = classifyEvent('connection_ready', null);
-                        clientLogger.info(readyEvent.message);
-                        pushEvent(readyEvent);
-                      }
-
-                      // Stop polling once proxy is ready
-                      if (isProxyReady()) {
-                        clearInterval(state.proxyPollTimer);
-                        state.proxyPollTimer = null;
-                      }
-                    } catch {}
-                  });
-                },
-              );
-              req.on('error', () => {});
-              req.end();
-            }, 5_000);
-          }
+      if (supervise) {
+        const roles = new Map();
+        for (let i = 0; i < poolSize; i++) roles.set(baseInstance + i, 'serving');
+        if (standby) roles.set(baseInstance + poolSize, 'standby');
+        state.supervisor = { config, launchOpts, roles, policies: new Map(), timers: new Map() };
+      }
 
-          // Classify all other events
-          const classified = classifyEvent(event, data);
-          if (classified.level === 'error') {
-            clientLogger.error(classified.message);
-          } else if (classified.level === 'warn') {
-            clientLogger.warn(classified.message);
-          } else if (classified.level !== 'debug') {
-            clientLogger.info(classified.message);
-          } else {
-            clientLogger.debug(classified.message);
-          }
-          pushEvent(classified);
-        },
+      const startEvent = classifyEvent('starting', {
+        message: poolSize > 1 ? `Client pool starting (${poolSize} instances)...` : 'Client starting...',
       });
-
-      state.cleanup = cleanup;
-      state.kill = kill;
-      setClientState(httpPort);
-
-      const startEvent = classifyEvent('starting', { message: 'Client starting...' });
-      clientLogger.info({ httpPort }, startEvent.message);
+      clientLogger.info({ httpPort, instances: poolSize, supervise, standby }, startEvent.message);
       pushEvent(startEvent);
 
-      sendJSON(res, 200, { status: 'starting', httpPort });
+      sendJSON(res, 200, { status: 'starting', httpPort, ...(poolSize > 1 ? { httpPorts: ports } : {}) });
     } catch (err) {
       clientLogger.error({ err: err.message }, 'Failed to start client');
       sendJSON(res, 500, { error: `Failed to start client: ${err.message}` });
@@ -266,7 +499,8 @@ export function register(router) {
    * Stop the running client.
    */
   router.post('/api/client/stop', async ({ res }) => {
-    if (!isClientRunning()) {
+    // A supervised client waiting to be restarted can be stopped too
+    if (!isClientRunning() && !state.supervisor) {
       sendJSON(res, 409, { error: 'Client is not running' });
       return;
     }
@@ -274,6 +508,7 @@ export function register(router) {
     const stoppingEvent = classifyEvent('stopping', { message: 'Stopping client...' });
     clientLogger.info(stoppingEvent.message);
     pushEvent(stoppingEvent);
+    stopSupervisor();
     teardown();
     const stoppedEvent = classifyEvent('stopped', { message: 'Client stopped' });
     clientLogger.info(stoppedEvent.message);
@@ -284,22 +519,20 @@ export function register(router) {
 
   /**
    * GET /api/client/events
-   * SSE stream for lifecycle events.
+   * SSE stream for lifecycle events. Resumes after the Last-Event-ID header
+   * (or ?lastEventId= for clients that reconnect with a new EventSource).
    */
-  router.get('/api/client/events', async ({ req, res }) => {
+  router.get('/api/client/events', async ({ req, res, query }) => {
     res.writeHead(200, {
       'Content-Type': 'text/event-stream',
       'Cache-Control': 'no-cache',
       'Connection': 'keep-alive',
     });
 
-    // Replay last 50 events
-    const replay = state.eventBuffer.slice(-50);
-    for (const event of replay) {
-      sendSSE(res, event);
-    }
-
-    state.sseClients.add(res);
+    // Replay missed events (last 50 on a fresh connection), then the
+    // current stats so the tab can apply subsequent patches
+    const remove = events.add(res, req.headers['last-event-id'] ?? query.lastEventId);
+    sendSSE(res, getStatsSnapshot());
 
     const keepAlive = setInterval(() => {
       try {
@@ -311,7 +544,7 @@ export function register(router) {
 
     req.on('close', () => {
       clearInterval(keepAlive);
-      state.sseClients.delete(res);
+      remove();
     });
-  });
+  }, { stream: true });
 }
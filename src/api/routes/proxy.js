@@ -1,28 +1,332 @@
 import { request as httpRequest, Agent } from 'http';
-import { getClientPort, isClientRunning, isProxyReady } from '../../services/client-state.js';
+import { pipeline } from 'stream';
+import { randomUUID } from 'crypto';
+import { resolve } from 'path';
+import {
+  getReadyPort, isClientRunning, acquireInstance, getPhaseForPort, onPhaseChange, servingCapacity, listInstances,
+} from '../../services/client-state.js';
 import { sendJSON } from '../server.js';
+import { createSwrCache } from '../../lib/swr-cache.js';
+import { createAdmission, PRIORITIES } from '../../lib/admission.js';
+import { createCompletionCache, completionKey, isCacheable } from '../../lib/completion-cache.js';
+import { createRouteStats, parseRouteHint, ROUTE_HINTS } from '../../lib/route-stats.js';
+import { STATE_ROOT } from '../../lib/state-dir.js';
+import { proxyLogger } from '../../lib/logger.js';
+import { metrics } from '../../lib/metrics.js';
+import { readClientConf } from '../../lib/config.js';
 
 const PROXY_TIMEOUT_MS = 5000;
 
+// OpenAI routes stream the request body upstream unparsed; long-context
+// prompts are allowed well past the 1 MB JSON-route limit.
+const DEFAULT_MAX_REQUEST_BODY_MB = 32;
+let maxRequestBodyBytes = DEFAULT_MAX_REQUEST_BODY_MB * 1024 * 1024;
+
+/** Read a raw route's body into one Buffer (413 past the route limit). */
+function readBody(req, maxBytes) {
+  return new Promise((resolve, reject) => {
+    const chunks = [];
+    let size = 0;
+    req.on('data', (chunk) => {
+      size += chunk.length;
+      if (size > maxBytes) {
+        req.destroy();
+        const err = new Error('Request body too large');
+        err.statusCode = 413;
+        return reject(err);
+      }
+      chunks.push(chunk);
+    });
+    req.on('end', () => resolve(Buffer.concat(chunks)));
+    req.on('error', reject);
+  });
+}
+
+/** A positive number from client.conf, else `fallback`. */
+function confNumber(key, fallback) {
+  try {
+    const value = parseFloat(readClientConf()?.[key]);
+    if (value > 0) return value;
+  } catch {}
+  return fallback;
+}
+
 // Disable keep-alive: each request opens and closes its own socket.
 // The C++ binary's HTTP server crashes on concurrent persistent connections
-// during proxy-connection establishment (~20s after start).
+// during proxy-connection establishment (~20s after start), so this is the
+// agent for every phase except `ready` (see services/client-state.js).
 const noKeepAliveAgent = new Agent({ keepAlive: false });
 
+// Once an instance is ready, reuse a small bounded pool of sockets to it.
+// Streams beyond KEEPALIVE_MAX_SOCKETS queue on the agent instead of
+// opening more connections.
+const KEEPALIVE_MAX_SOCKETS = 32;
+const KEEPALIVE_MAX_FREE_SOCKETS = 4;
+const KEEPALIVE_IDLE_MS = 15_000;
+const keepAliveAgents = new Map();  // httpPort → Agent
+
+/**
+ * Pick the agent for a request: pooled keep-alive to a ready instance,
+ * one-shot sockets otherwise.
+ */
+function agentFor(port) {
+  if (getPhaseForPort(port) !== 'ready') return { agent: noKeepAliveAgent, keepAlive: false };
+  let agent = keepAliveAgents.get(port);
+  if (!agent) {
+    agent = new Agent({
+      keepAlive: true,
+      maxSockets: KEEPALIVE_MAX_SOCKETS,
+      maxFreeSockets: KEEPALIVE_MAX_FREE_SOCKETS,
+    });
+    // Idle timeout only while parked; the agent destroys free sockets on timeout
+    agent.on('free', (socket) => socket.setTimeout(KEEPALIVE_IDLE_MS));
+    keepAliveAgents.set(port, agent);
+  }
+  return { agent, keepAlive: true };
+}
+
+/**
+ * Retire the keep-alive pool of a port: close idle sockets now, and close
+ * in-flight ones as soon as their response finishes (instead of parking
+ * them in the free list while the binary re-handshakes).
+ */
+function retireAgent(port) {
+  const agent = keepAliveAgents.get(port);
+  if (!agent) return;
+  keepAliveAgents.delete(port);
+  agent.on('free', (socket) => socket.destroy());
+  for (const sockets of Object.values(agent.freeSockets)) {
+    for (const socket of sockets) socket.destroy();
+  }
+}
+
+onPhaseChange(({ httpPort, phase, prev }) => {
+  if (prev === 'ready' && phase !== 'ready') retireAgent(httpPort);
+});
+
+// --- Admission ---
+// At most `max_inflight_per_instance` completions per instance reach the
+// binary; the rest queue here, WebUI chat (X-Priority: interactive) ahead
+// of API callers, and get a 429 + Retry-After instead of waiting past
+// `queue_budget_ms`.
+const DEFAULT_MAX_INFLIGHT_PER_INSTANCE = 16;
+const DEFAULT_QUEUE_BUDGET_MS = 30_000;
+let maxInFlightPerInstance = DEFAULT_MAX_INFLIGHT_PER_INSTANCE;
+
+const admissionDepth = metrics.gauge('cocoon_admission_queue_depth',
+  'Completions waiting for an instance slot');
+const admissionWait = metrics.histogram('cocoon_admission_wait_seconds',
+  'Time completions waited for an instance slot', [0.01, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30]);
+const admissionRejected = metrics.counter('cocoon_admission_rejected_total',
+  'Completions turned away by admission control (queue_full, budget, timeout)');
+
+// --- Routing ---
+// Measured TTFT / tokens per second / error rate per instance and model
+// (lib/route-stats.js). X-Route-Hint: latency | price picks the instance
+// by them instead of by load alone.
+const routeStats = createRouteStats();
+
+const routeTtft = metrics.gauge('cocoon_route_ttft_seconds', 'Smoothed time to first event per instance and model');
+const routeRate = metrics.gauge('cocoon_route_tokens_per_second', 'Smoothed streamed events per second per instance and model');
+const routeErrors = metrics.gauge('cocoon_route_error_ratio', 'Smoothed share of failed completions per instance and model');
+
+/**
+ * Routing statistics: per instance its price cap and load, and the
+ * measured series per model ('*' = all models).
+ */
+export function getRoutingStats() {
+  const series = routeStats.snapshot();
+  return {
+    hints: ROUTE_HINTS,
+    instances: listInstances().map(inst => ({
+      instance: inst.instance,
+      standby: inst.standby,
+      proxyReady: inst.proxyReady,
+      inFlight: inst.inFlight,
+      maxCoefficient: inst.maxCoefficient ?? 0,
+      models: series.filter(s => s.instance === inst.instance).map(({ instance, ...s }) => s),
+    })),
+  };
+}
+
+/** Samples from before a restart describe other proxy connections */
+onPhaseChange(({ instance, phase }) => {
+  if (phase === 'starting') routeStats.forget(instance);
+});
+
+const admission = createAdmission({
+  tryAcquire: (route) => acquireInstance({
+    maxInFlight: maxInFlightPerInstance,
+    rank: route ? routeStats.rank(route.hint, route.model) : null,
+  }),
+  capacity: () => Math.max(1, servingCapacity()) * maxInFlightPerInstance,
+  budgetMs: DEFAULT_QUEUE_BUDGET_MS,
+  onAdmit: (priority, waitMs) => admissionWait.observe({ priority }, waitMs / 1000),
+  onReject: (priority, reason) => admissionRejected.inc({ priority, reason }),
+});
+
+// An instance becoming ready (or coming back) frees slots for the queue
+onPhaseChange(() => admission.pump());
+
+// --- Completion cache ---
+// Opt-in (`completion_cache_mb` > 0): deterministic completions
+// (temperature 0) are answered from lib/completion-cache.js instead of
+// paying for inference again. Only then is the body buffered and parsed;
+// otherwise it is piped through untouched.
+const COMPLETION_CACHE_DIR = resolve(STATE_ROOT, 'completions');
+// Responses larger than this are passed through but not recorded
+const COMPLETION_CACHE_MAX_ENTRY_BYTES = 8 * 1024 * 1024;
+let completionCache = null;
+
+const completionCacheRequests = metrics.counter('cocoon_completion_cache_requests_total',
+  'Cacheable completions by result (hit, miss)');
+const completionCacheTokens = metrics.counter('cocoon_completion_cache_tokens_saved_total',
+  'Tokens served from the completion cache instead of the proxy network');
+
+/**
+ * Completion cache counters (hits, misses, stores, tokensSaved, sizes);
+ * `{ enabled: false }` when the cache is off.
+ */
+export function getCompletionCacheStats() {
+  return completionCache ? { enabled: true, ...completionCache.stats() } : { enabled: false };
+}
+
+/** Replay a cached response with the chunking it was recorded with. */
+function replayCompletion(res, entry, requestId) {
+  res.writeHead(entry.status, {
+    'Content-Type': entry.contentType,
+    'Cache-Control': 'no-cache',
+    'X-Request-Id': requestId,
+    'X-Cache': 'HIT',
+  });
+  for (const chunk of entry.chunks) res.write(chunk);
+  res.end();
+}
+
+/**
+ * Admission counters and current queue depth per priority.
+ */
+export function getAdmissionStats() {
+  return { ...admission.stats(), maxInFlightPerInstance };
+}
+
 // --- Response cache ---
 // Prevents multiple browser polls from hammering the binary concurrently.
-// Only one in-flight request per path; subsequent requests get the cached response.
-const cache = new Map();  // path → { data, status, contentType, ts }
+// Only one in-flight upstream request per port:path: concurrent misses wait
+// on the same promise. Within the stale window the last good body is served
+// immediately while a single background refresh runs.
 const CACHE_TTL_MS = 2000;
+const CACHE_STALE_MS = 10_000;
+const cache = createSwrCache({
+  ttlMs: CACHE_TTL_MS,
+  staleMs: CACHE_STALE_MS,
+  shouldCache: (result) => result.status < 400,
+});
+
+// --- Metrics ---
+// Streamed SSE events stand in for tokens: the runner sends one delta per event.
+const ttftSeconds = metrics.histogram('cocoon_inference_ttft_seconds',
+  'Time from request to the first streamed event', [0.1, 0.25, 0.5, 1, 2, 5, 10, 30, 60]);
+const interTokenSeconds = metrics.histogram('cocoon_inference_inter_token_seconds',
+  'Gap between consecutive streamed events (0 for events sharing a chunk)', [0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5]);
+const tokensPerSecond = metrics.histogram('cocoon_inference_tokens_per_second',
+  'Streamed events per second from first to last event', [1, 5, 10, 20, 30, 50, 75, 100, 150, 200]);
+const completionsTotal = metrics.counter('cocoon_inference_completions_total',
+  'Streaming completions by outcome (completed, aborted, error)');
+const cancelsTotal = metrics.counter('cocoon_inference_cancels_total',
+  'Completions cancelled through /api/v1/chat/cancel');
+const cacheRequests = metrics.counter('cocoon_proxy_cache_requests_total',
+  'Cached proxy lookups by result (hit, stale, miss, coalesced)');
+const cacheErrors = metrics.counter('cocoon_proxy_cache_upstream_errors_total',
+  'Failed upstream loads behind the proxy cache');
+const cacheHitRatio = metrics.gauge('cocoon_proxy_cache_hit_ratio',
+  'Share of cached proxy lookups answered without waiting on the binary');
+const activeStreamsGauge = metrics.gauge('cocoon_inference_active_streams',
+  'Streaming completions currently in flight');
+
+metrics.addCollector(() => {
+  const st = cache.stats();
+  cacheRequests.set({ result: 'hit' }, st.hits);
+  cacheRequests.set({ result: 'stale' }, st.staleHits);
+  cacheRequests.set({ result: 'miss' }, st.misses);
+  cacheRequests.set({ result: 'coalesced' }, st.coalesced);
+  cacheErrors.set({}, st.errors);
+  const total = st.hits + st.staleHits + st.misses + st.coalesced;
+  cacheHitRatio.set(total ? (st.hits + st.staleHits) / total : 0);
+  activeStreamsGauge.set(activeStreams.size);
+  for (const p of PRIORITIES) admissionDepth.set({ priority: p }, admission.depth(p));
+  for (const g of [routeTtft, routeRate, routeErrors]) g.reset();
+  for (const s of routeStats.snapshot()) {
+    const labels = { instance: s.instance, model: s.model };
+    if (s.ttftMs != null) routeTtft.set(labels, s.ttftMs / 1000);
+    if (s.tokensPerSec != null) routeRate.set(labels, s.tokensPerSec);
+    routeErrors.set(labels, s.errorRate);
+  }
+  if (completionCache) {
+    const cc = completionCache.stats();
+    completionCacheRequests.set({ result: 'hit' }, cc.hits);
+    completionCacheRequests.set({ result: 'miss' }, cc.misses);
+    completionCacheTokens.set({}, cc.tokensSaved);
+  }
+});
+
+/** Count SSE `data:` events in a chunk, skipping the final [DONE]. */
+function countEvents(chunk) {
+  let n = 0;
+  let i = chunk.indexOf('data: ');
+  while (i !== -1) {
+    if (chunk[i + 6] !== 0x5b /* [ */ || chunk.toString('latin1', i + 6, i + 12) !== '[DONE]') n++;
+    i = chunk.indexOf('data: ', i + 6);
+  }
+  return n;
+}
+
+const MODEL_RE = /"model"\s*:\s*"([^"]{1,200})"/;
 
-function getCached(path) {
-  const entry = cache.get(path);
-  if (entry && Date.now() - entry.ts < CACHE_TTL_MS) return entry;
-  return null;
+/**
+ * Record latency/throughput of one streamed completion.
+ * `onEnd` gets the per-request summary (model read from the first event).
+ * @param {(summary: { outcome: string, ttftMs: number | null, tokensPerSec: number | null, model: string | null }) => void} [onEnd]
+ * @returns {(outcome: string) => void} call once when the stream ends
+ */
+function observeStream(proxyRes, startedAt, onEnd) {
+  let first = 0;
+  let last = 0;
+  let events = 0;
+  let model = null;
+  proxyRes.on('data', (chunk) => {
+    const n = countEvents(chunk);
+    if (n === 0) return;
+    const now = performance.now();
+    if (!first) {
+      first = now;
+      ttftSeconds.observe((now - startedAt) / 1000);
+      model = MODEL_RE.exec(chunk.toString())?.[1] ?? null;
+    } else {
+      interTokenSeconds.observe((now - last) / 1000);
+    }
+    // Events coalesced into one chunk arrived together: 0 s apart
+    for (let k = 1; k < n; k++) interTokenSeconds.observe(0);
+    last = now;
+    events += n;
+  });
+  let done = false;
+  return (outcome) => {
+    if (done) return;
+    done = true;
+    completionsTotal.inc({ outcome });
+    const rate = events > 1 && last > first ? (events - 1) / ((last - first) / 1000) : null;
+    if (rate !== null) tokensPerSecond.observe(rate);
+    onEnd?.({ outcome, ttftMs: first ? first - startedAt : null, tokensPerSec: rate, model });
+  };
 }
 
-function setCache(path, status, contentType, data) {
-  cache.set(path, { data, status, contentType, ts: Date.now() });
+/**
+ * Cache counters for monitoring (hits, staleHits, misses, coalesced,
+ * refreshes, errors — cumulative since process start).
+ */
+export function getProxyCacheStats() {
+  return cache.stats();
 }
 
 /**
@@ -32,76 +336,170 @@ export function clearProxyCache() {
   cache.clear();
 }
 
+// --- Active streams ---
+// Streaming completions by request id, so they can be cancelled explicitly
+// (POST /api/v1/chat/cancel/:id) and not only by closing the connection.
+const activeStreams = new Map();  // requestId → { proxyReq, res, port, startedAt }
+const REQUEST_ID_RE = /^[\w-]{8,64}$/;
+
+/**
+ * Cancel an in-flight streaming completion: aborts the upstream request
+ * (the binary stops generating) and closes the downstream response.
+ * @returns {boolean} whether a stream with that id was active
+ */
+export function cancelStream(requestId) {
+  const entry = activeStreams.get(requestId);
+  if (!entry) return false;
+  activeStreams.delete(requestId);
+  entry.proxyReq.destroy();
+  entry.res.destroy();
+  cancelsTotal.inc();
+  return true;
+}
+
+function sendCached(res, entry) {
+  res.writeHead(entry.status, {
+    'Content-Type': entry.contentType,
+    'Cache-Control': 'no-store',
+  });
+  res.end(entry.data);
+}
+
 /**
  * Proxy a request to the client-runner HTTP API.
+ * Buffered (non-stream) requests resolve with { status, contentType, data };
+ * pass `res = null` to only collect the response.
+ * `reqBody` is a value to serialize, a Buffer sent as-is, or the incoming
+ * request itself, piped upstream (Content-Length preserved, no parse).
+ * Stream hooks: `record` gets a successful response as { status,
+ * contentType, chunks } once fully delivered (completion cache); `onEnd`
+ * gets every completion's outcome and timings (routing stats).
+ * Streaming requests are registered under `requestId` and aborted upstream
+ * as soon as the downstream connection goes away (and vice versa).
  */
-function proxyRequest(targetPort, targetPath, method, reqHeaders, reqBody, res, stream = false) {
+function proxyRequest(targetPort, targetPath, method, reqHeaders, reqBody, res, stream = false, requestId = null, { record, onEnd } = {}) {
   return new Promise((resolve, reject) => {
+    const startedAt = performance.now();
+    let finishStream = null;
+    const { agent, keepAlive } = agentFor(targetPort);
     const options = {
       hostname: '127.0.0.1',
       port: targetPort,
       path: targetPath,
       method,
-      headers: { Connection: 'close' },
+      headers: { Connection: keepAlive ? 'keep-alive' : 'close' },
       timeout: stream ? 0 : PROXY_TIMEOUT_MS,
-      agent: noKeepAliveAgent,
+      agent,
     };
 
     // Forward content-type for POST requests
     if (reqHeaders['content-type']) {
       options.headers['Content-Type'] = reqHeaders['content-type'];
     }
+    const passthrough = typeof reqBody?.pipe === 'function';
+    if (passthrough && reqHeaders['content-length']) {
+      options.headers['Content-Length'] = reqHeaders['content-length'];
+    }
+    if (Buffer.isBuffer(reqBody)) options.headers['Content-Length'] = reqBody.length;
 
     const proxyReq = httpRequest(options, (proxyRes) => {
       if (stream) {
-        // For streaming responses, pipe directly (CORS handled by main server)
+        // For streaming responses, pipe directly (CORS handled by main server).
+        // pipeline() applies backpressure and destroys both sides if either
+        // fails, so an upstream abort also ends the browser's stream.
         res.writeHead(proxyRes.statusCode, {
           'Content-Type': proxyRes.headers['content-type'] || 'text/event-stream',
           'Cache-Control': 'no-cache',
           'Connection': 'keep-alive',
+          ...(requestId ? { 'X-Request-Id': requestId } : {}),
+        });
+        finishStream = observeStream(proxyRes, startedAt,
+          onEnd && ((summary) => onEnd({ ...summary, status: proxyRes.statusCode })));
+        let recorded = record && proxyRes.statusCode === 200 ? [] : null;
+        let recordedBytes = 0;
+        if (recorded) {
+          proxyRes.on('data', (chunk) => {
+            if (!recorded) return;
+            recordedBytes += chunk.length;
+            if (recordedBytes > COMPLETION_CACHE_MAX_ENTRY_BYTES) recorded = null;
+            else recorded.push(chunk);
+          });
+        }
+        pipeline(proxyRes, res, (err) => {
+          if (err) proxyReq.destroy();
+          finishStream(err ? 'aborted' : 'completed');
+          if (!err && recorded) {
+            record({ status: proxyRes.statusCode, contentType: proxyRes.headers['content-type'] || 'text/event-stream', chunks: recorded });
+          }
+          resolve();
         });
-        proxyRes.pipe(res);
-        proxyRes.on('end', resolve);
       } else {
         // Buffer the response
         const chunks = [];
         proxyRes.on('data', (chunk) => chunks.push(chunk));
         proxyRes.on('end', () => {
-          const body = Buffer.concat(chunks).toString();
-          const ct = proxyRes.headers['content-type'] || 'application/json';
-
-          // Cache successful GET responses
-          if (method === 'GET' && proxyRes.statusCode < 400) {
-            setCache(targetPath, proxyRes.statusCode, ct, body);
-          }
-
-          res.writeHead(proxyRes.statusCode, {
-            'Content-Type': ct,
-            'Cache-Control': 'no-store',
-          });
-          res.end(body);
-          resolve();
+          const result = {
+            status: proxyRes.statusCode,
+            contentType: proxyRes.headers['content-type'] || 'application/json',
+            data: Buffer.concat(chunks).toString(),
+          };
+          if (res) sendCached(res, result);
+          resolve(result);
         });
       }
     });
 
+    if (stream) {
+      if (requestId) activeStreams.set(requestId, { proxyReq, res, port: targetPort, startedAt: Date.now() });
+      // Downstream gone before the upstream finished: stop generation
+      res.on('close', () => {
+        if (requestId && activeStreams.get(requestId)?.proxyReq === proxyReq) activeStreams.delete(requestId);
+        if (!res.writableFinished && !proxyReq.destroyed) {
+          if (!finishStream) completionsTotal.inc({ outcome: 'aborted' });
+          proxyLogger.info({ requestId, port: targetPort }, 'Downstream closed, aborting upstream completion');
+          proxyReq.destroy();
+          resolve();
+        }
+      });
+    }
+
+    // A reused socket still carries the idle timeout from the free list
+    if (keepAlive) {
+      proxyReq.on('socket', (socket) => socket.setTimeout(stream ? 0 : PROXY_TIMEOUT_MS));
+    }
+
     proxyReq.on('timeout', () => {
       proxyReq.destroy();
-      if (!res.headersSent) {
-        sendJSON(res, 504, { error: 'Client not ready (timeout)' });
-      }
-      reject(new Error('proxy timeout'));
+      const err = new Error('proxy timeout');
+      if (res) sendUpstreamError(res, err);
+      reject(err);
     });
 
     proxyReq.on('error', (err) => {
-      if (!res.headersSent) {
-        sendJSON(res, 502, { error: `Client unreachable: ${err.message}` });
+      if (stream && !finishStream && !res.destroyed) {
+        completionsTotal.inc({ outcome: 'error' });
+        onEnd?.({ outcome: 'error', ttftMs: null, tokensPerSec: null, model: null, status: null });
       }
+      if (res) sendUpstreamError(res, err);
       reject(err);
     });
 
+    if (passthrough) {
+      // Content-Length was checked by the server; chunked bodies are counted here
+      let size = 0;
+      reqBody.on('data', (chunk) => {
+        size += chunk.length;
+        if (size <= maxRequestBodyBytes) return;
+        if (!res.headersSent) sendJSON(res, 413, { error: 'Request body too large' });
+        reqBody.destroy();
+      });
+      // Ends proxyReq when the body is done; destroys it if the client aborts the upload
+      pipeline(reqBody, proxyReq, () => {});
+      return;
+    }
+
     if (reqBody && method === 'POST') {
-      const bodyStr = typeof reqBody === 'string' ? reqBody : JSON.stringify(reqBody);
+      const bodyStr = typeof reqBody === 'string' || Buffer.isBuffer(reqBody) ? reqBody : JSON.stringify(reqBody);
       proxyReq.write(bodyStr);
     }
 
@@ -110,36 +508,47 @@ function proxyRequest(targetPort, targetPath, method, reqHeaders, reqBody, res,
 }
 
 /**
- * Serve from cache or proxy to binary (one request at a time per path).
+ * Error response for a failed upstream request (no-op once headers are out).
  */
-function cachedProxy(port, path, reqHeaders, res) {
-  const cached = getCached(path);
-  if (cached) {
-    res.writeHead(cached.status, {
-      'Content-Type': cached.contentType,
-      'Cache-Control': 'no-store',
-    });
-    res.end(cached.data);
-    return Promise.resolve();
+function sendUpstreamError(res, err) {
+  if (res.headersSent || res.destroyed) return;
+  if (err.message === 'proxy timeout') {
+    sendJSON(res, 504, { error: 'Client not ready (timeout)' });
+  } else {
+    sendJSON(res, 502, { error: `Client unreachable: ${err.message}` });
+  }
+}
+
+/**
+ * Serve from cache or proxy to binary (one upstream request at a time per path).
+ */
+async function cachedProxy(port, path, reqHeaders, res) {
+  try {
+    const { value } = await cache.get(`${port}:${path}`,
+      () => proxyRequest(port, path, 'GET', reqHeaders, null, null));
+    sendCached(res, value);
+  } catch (err) {
+    sendUpstreamError(res, err);
+    throw err;
   }
-  return proxyRequest(port, path, 'GET', reqHeaders, null, res);
 }
 
 export function register(router) {
   /**
    * GET /api/jsonstats
-   * Proxy to client-runner /jsonstats (cached 2s).
+   * Proxy to client-runner /jsonstats (cached 2s, served stale up to 10s while refreshing).
    */
   router.get('/api/jsonstats', async ({ req, res }) => {
-    const port = getClientPort();
-    if (!port || !isClientRunning()) {
+    if (!isClientRunning()) {
       sendJSON(res, 503, { error: 'Client is not running' });
       return;
     }
     // Block jsonstats until proxy handshake completes — the C++ binary crashes
     // (SIGSEGV) if /jsonstats is called while a proxy connection exists but
     // the handshake hasn't finished yet (conn->proxy() is null).
-    if (!isProxyReady()) {
+    // In pool mode, stats come from the lowest-numbered ready instance.
+    const port = getReadyPort();
+    if (!port) {
       sendJSON(res, 503, { error: 'Client starting, proxy not ready yet' });
       return;
     }
@@ -152,15 +561,15 @@ export function register(router) {
 
   /**
    * GET /api/v1/models
-   * Proxy to client-runner /v1/models (cached 2s).
+   * Proxy to client-runner /v1/models (cached 2s, served stale up to 10s while refreshing).
    */
   router.get('/api/v1/models', async ({ req, res }) => {
-    const port = getClientPort();
-    if (!port || !isClientRunning()) {
+    if (!isClientRunning()) {
       sendJSON(res, 503, { error: 'Client is not running' });
       return;
     }
-    if (!isProxyReady()) {
+    const port = getReadyPort();
+    if (!port) {
       sendJSON(res, 503, { error: 'Client starting, proxy not ready yet' });
       return;
     }
@@ -171,20 +580,142 @@ export function register(router) {
     }
   });
 
+  /**
+   * GET /api/proxy/cache
+   * Response cache counters.
+   */
+  router.get('/api/proxy/cache', async ({ res }) => {
+    sendJSON(res, 200, getProxyCacheStats());
+  });
+
+  /**
+   * GET /api/proxy/admission
+   * Admission queue depth, limits and counters.
+   */
+  router.get('/api/proxy/admission', async ({ res }) => {
+    sendJSON(res, 200, getAdmissionStats());
+  });
+
+  maxRequestBodyBytes = Math.round(confNumber('max_request_body_mb', DEFAULT_MAX_REQUEST_BODY_MB) * 1024 * 1024);
+  maxInFlightPerInstance = Math.floor(confNumber('max_inflight_per_instance', DEFAULT_MAX_INFLIGHT_PER_INSTANCE)) || 1;
+  admission.configure({ budgetMs: confNumber('queue_budget_ms', DEFAULT_QUEUE_BUDGET_MS) });
+  const cacheMb = confNumber('completion_cache_mb', 0);
+  completionCache = cacheMb > 0 ? createCompletionCache({
+    dir: COMPLETION_CACHE_DIR,
+    maxMemoryBytes: cacheMb * 1024 * 1024,
+    maxDiskBytes: confNumber('completion_cache_disk_mb', cacheMb * 8) * 1024 * 1024,
+    ttlMs: confNumber('completion_cache_ttl_h', 24) * 3600_000,
+  }) : null;
+
+  /**
+   * GET /api/proxy/routing
+   * Per-instance, per-model latency / throughput / error stats and price caps.
+   */
+  router.get('/api/proxy/routing', async ({ res }) => {
+    sendJSON(res, 200, getRoutingStats());
+  });
+
+  /**
+   * GET /api/proxy/completion-cache
+   * Completion cache hit rate and tokens saved.
+   */
+  router.get('/api/proxy/completion-cache', async ({ res }) => {
+    sendJSON(res, 200, getCompletionCacheStats());
+  });
+
   /**
    * POST /api/v1/chat/completions
-   * Streaming proxy to client-runner /v1/chat/completions.
+   * Streaming proxy to client-runner /v1/chat/completions. The request body
+   * is piped through unparsed (raw route, up to `max_request_body_mb`),
+   * unless the completion cache is on and needs to hash it. Only one success
+   * in ten is logged as an API request; its lifetime is recorded as a stream
+   * (latency has the cocoon_inference_* histograms).
+   * In pool mode each request goes to the instance with the fewest in-flight streams,
+   * once admission control (see above) grants it a slot.
    */
-  router.post('/api/v1/chat/completions', async ({ req, res, body }) => {
-    const port = getClientPort();
-    if (!port || !isClientRunning()) {
+  router.post('/api/v1/chat/completions', async ({ req, res }) => {
+    if (!isClientRunning()) {
       sendJSON(res, 503, { error: 'Client is not running' });
       return;
     }
+    // Callers may pick the id (to cancel before the first byte arrives)
+    const clientId = req.headers['x-request-id'];
+    const requestId = REQUEST_ID_RE.test(clientId || '') && !activeStreams.has(clientId) ? clientId : randomUUID();
+
+    // The body is only buffered when the cache or a latency hint needs to read it
+    const hint = parseRouteHint(req.headers['x-route-hint']);
+    const useCache = !!completionCache && !/no-(cache|store)/.test(req.headers['cache-control'] || '');
+    let upstreamBody = req;
+    let parsed = null;
+    if (useCache || hint === 'latency') {
+      upstreamBody = await readBody(req, maxRequestBodyBytes);
+      try { parsed = JSON.parse(upstreamBody.toString()); } catch {}
+    }
+
+    // Cache hits are answered before taking an instance slot
+    let record;
+    if (useCache) {
+      if (isCacheable(parsed)) {
+        const key = completionKey(parsed);
+        const hit = await completionCache.get(key);
+        if (hit) {
+          replayCompletion(res, hit, requestId);
+          return;
+        }
+        res.setHeader('X-Cache', 'MISS');
+        record = (response) => completionCache.put(key, response);
+      }
+    }
+    // Leave the queue if the caller gives up while waiting
+    const queued = new AbortController();
+    const leaveQueue = () => queued.abort();
+    res.on('close', leaveQueue);
+    let lease;
     try {
-      await proxyRequest(port, '/v1/chat/completions', 'POST', req.headers, body, res, true);
+      lease = await admission.acquire(req.headers['x-priority'] === 'interactive' ? 'interactive' : 'batch',
+        { signal: queued.signal, hint: hint && { hint, model: typeof parsed?.model === 'string' ? parsed.model : null } });
+    } catch (err) {
+      if (err.statusCode === 429) {
+        res.setHeader('Retry-After', Math.ceil(err.retryAfterMs / 1000));
+        sendJSON(res, 429, { error: err.message });
+      }
+      return;
+    } finally {
+      res.off('close', leaveQueue);
+    }
+    if (res.destroyed) {
+      lease.release();
+      return;
+    }
+    // Release on downstream close too, so an abandoned stream can't pin the counter
+    res.on('close', lease.release);
+    try {
+      await proxyRequest(lease.httpPort, '/v1/chat/completions', 'POST', req.headers, upstreamBody, res, true, requestId, {
+        record,
+        onEnd: ({ outcome, ttftMs, tokensPerSec, model, status }) => {
+          // Client aborts say nothing about the instance; upstream 5xx / socket errors do
+          if (outcome === 'aborted') return;
+          const ok = outcome === 'completed' && status < 500;
+          routeStats.record(lease.instance, model ?? parsed?.model ?? null, { ttftMs, tokensPerSec, ok });
+        },
+      });
     } catch {
       // Error already sent in proxyRequest
+    } finally {
+      lease.release();
+    }
+  }, { body: 'raw', maxBodyBytes: maxRequestBodyBytes, log: 0.1, stream: true });
+
+  /**
+   * POST /api/v1/chat/cancel/:id
+   * Abort a streaming completion by request id (X-Request-Id).
+   */
+  router.post('/api/v1/chat/cancel/:id', async ({ res, params }) => {
+    if (!cancelStream(params.id)) {
+      sendJSON(res, 404, { error: 'No active completion with that id' });
+      return;
     }
+    proxyLogger.info({ requestId: params.id }, 'Completion cancelled');
+    sendJSON(res, 200, { status: 'cancelled', id: params.id });
   });
 }
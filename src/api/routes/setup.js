@@ -1,6 +1,6 @@
 import { readWalletJson, writeWalletJson, readClientConf, writeClientConf, getHttpPort, DEFAULT_ROOT_CONTRACT } from '../../lib/config.js';
 import { generateWallet } from '../../lib/wallet.js';
-import { getBalance } from '../../lib/ton.js';
+import { getBalance, clearTonClientCache } from '../../lib/ton.js';
 import { transferFunds } from '../../services/wallet.js';
 import { sendJSON } from '../server.js';
 
@@ -92,6 +92,7 @@ export function register(router) {
       }
 
       writeClientConf(config);
+      clearTonClientCache();
 
       const httpPort = getHttpPort();
       sendJSON(res, 200, { ok: true, httpPort });
@@ -1,11 +1,13 @@
 import { sendJSON } from '../server.js';
 import { readWalletJson } from '../../lib/config.js';
-import { getTransactionHistory, getEarnings, checkRecentAction } from '../../services/toncenter.js';
+import { getTransactionHistory, getEarnings, checkRecentAction, indexedAccount } from '../../services/toncenter.js';
 
 export function register(router) {
   /**
-   * GET /api/toncenter/history
-   * Returns recent cocoon on-chain actions for the node.
+   * GET /api/toncenter/history?limit=20&before=<lt>&beforeId=<id>[&account=<owner>]
+   * Returns cocoon on-chain actions for the node (or owner) wallet, newest
+   * first, from the local action index. Pass `nextBeforeLt` / `nextBeforeId`
+   * back as `before` / `beforeId` for the next page.
    */
   router.get('/api/toncenter/history', async ({ res, query }) => {
     try {
@@ -19,17 +21,27 @@ export function register(router) {
         sendJSON(res, 400, { error: 'No account address available' });
         return;
       }
-      const limit = parseInt(query?.limit || '20', 10);
-      const history = await getTransactionHistory(account, limit);
-      sendJSON(res, 200, { actions: history });
+      if (!indexedAccount(account)) {
+        sendJSON(res, 400, { error: 'Only the node and owner wallets are indexed' });
+        return;
+      }
+      if (query?.before && !/^\d+$/.test(query.before)) {
+        sendJSON(res, 400, { error: 'before must be a logical time' });
+        return;
+      }
+      const limit = Math.min(100, Math.max(1, parseInt(query?.limit || '20', 10) || 20));
+      const before = query?.before ? { lt: query.before, id: query.beforeId || undefined } : undefined;
+      const history = await getTransactionHistory(account, limit, before);
+      sendJSON(res, 200, history);
     } catch (err) {
-      sendJSON(res, 500, { error: `Failed to fetch history: ${err.message}` });
+      sendJSON(res, err.statusCode || 500, { error: `Failed to fetch history: ${err.message}` });
     }
   });
 
   /**
    * GET /api/toncenter/earnings
-   * Returns payout history and total earnings for the node.
+   * Returns recent payouts and the total earned over the indexed period
+   * (`complete: false` while older actions are still being backfilled).
    */
   router.get('/api/toncenter/earnings', async ({ res }) => {
     try {
@@ -51,8 +63,10 @@ export function register(router) {
   });
 
   /**
-   * GET /api/toncenter/confirm?type=cocoon_client_top_up&after=1234567890
+   * GET /api/toncenter/confirm?type=cocoon_client_top_up&after=1234567890[&wait=30]
    * Check if a specific action was confirmed on-chain after a timestamp.
+   * With `wait` (seconds, max 60) the request is held until the action
+   * lands or the wait runs out, instead of the caller polling.
    */
   router.get('/api/toncenter/confirm', async ({ res, query }) => {
     try {
@@ -64,13 +78,14 @@ export function register(router) {
       const account = wallet.node_wallet?.address;
       const actionType = query?.type;
       const after = parseInt(query?.after || '0', 10);
+      const waitMs = Math.min(60, Math.max(0, parseInt(query?.wait || '0', 10) || 0)) * 1000;
 
       if (!account || !actionType) {
         sendJSON(res, 400, { error: 'Missing account or action type' });
         return;
       }
 
-      const action = await checkRecentAction(account, actionType, after);
+      const action = await checkRecentAction(account, actionType, after, waitMs);
       sendJSON(res, 200, { confirmed: !!action, action });
     } catch (err) {
       sendJSON(res, 500, { error: `Failed to check confirmation: ${err.message}` });
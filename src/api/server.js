@@ -1,44 +1,40 @@
 import { createServer as httpCreateServer } from 'http';
-import { readFileSync, statSync } from 'fs';
-import { resolve, extname, join } from 'path';
+import { resolve } from 'path';
 import { fileURLToPath } from 'url';
 import { dirname } from 'path';
 import { randomUUID } from 'crypto';
 import { apiLogger } from '../lib/logger.js';
+import { metrics } from '../lib/metrics.js';
+import { createStaticAssets, isNotModified, negotiateEncoding } from '../lib/static-assets.js';
 
 const __dirname = dirname(fileURLToPath(import.meta.url));
 const WEBUI_DIST = resolve(__dirname, '../../webui/dist');
 
-const MIME_TYPES = {
-  '.html': 'text/html',
-  '.js': 'application/javascript',
-  '.css': 'text/css',
-  '.json': 'application/json',
-  '.png': 'image/png',
-  '.jpg': 'image/jpeg',
-  '.svg': 'image/svg+xml',
-  '.ico': 'image/x-icon',
-  '.woff': 'font/woff',
-  '.woff2': 'font/woff2',
-  '.ttf': 'font/ttf',
-};
-
-const MAX_BODY_SIZE = 1048576; // 1 MB
+const MAX_BODY_SIZE = 1048576; // 1 MB, JSON routes (raw routes set their own)
+
+const httpRequests = metrics.counter('cocoon_http_requests_total', 'Management API requests by route and status code');
+const httpDuration = metrics.histogram('cocoon_http_request_duration_seconds', 'Management API response time by route (until the response ends)');
+const streamDuration = metrics.histogram('cocoon_http_stream_duration_seconds',
+  'Lifetime of long-lived API streams (SSE) by route', [1, 10, 60, 300, 900, 3600, 4 * 3600, 24 * 3600]);
+
+function bodyTooLarge() {
+  const err = new Error('Request body too large');
+  err.statusCode = 413;
+  return err;
+}
 
 /**
  * Parse JSON body from request.
  */
-function parseJsonBody(req) {
+function parseJsonBody(req, maxBytes = MAX_BODY_SIZE) {
   return new Promise((resolve, reject) => {
     const chunks = [];
     let size = 0;
     req.on('data', (chunk) => {
       size += chunk.length;
-      if (size > MAX_BODY_SIZE) {
+      if (size > maxBytes) {
         req.destroy();
-        const err = new Error('Request body too large');
-        err.statusCode = 413;
-        return reject(err);
+        return reject(bodyTooLarge());
       }
       chunks.push(chunk);
     });
@@ -75,89 +71,136 @@ export function sendSSE(res, data) {
   res.write(`data: ${JSON.stringify(data)}\n\n`);
 }
 
+// Methods whose routes default to a JSON body, Bearer auth and request logging
+const STATE_CHANGING = new Set(['POST', 'PUT', 'DELETE']);
+const BODY_MODES = new Set(['json', 'raw', 'none']);
+
 /**
- * Create a simple router with method+path matching supporting :params.
+ * Create a router with method+path matching supporting :params.
+ *
+ * Routes are compiled into one segment tree per method when added, so a
+ * lookup walks the path's segments instead of trying every pattern;
+ * static segments win over `:params` at the same position.
+ *
+ * Route options (defaults depend on the method):
+ * - `body` — 'json' (default for POST/PUT): parsed into `body`;
+ *   'raw': not read, the handler gets `body: null` and reads (or pipes)
+ *   `req` itself; 'none' (default for GET/DELETE): `body` is `{}`.
+ * - `maxBodyBytes` — body size limit (default 1 MB). Checked against
+ *   Content-Length up front; raw handlers enforce it on chunked bodies.
+ * - `auth` — require the Bearer token (default: POST/PUT/DELETE).
+ * - `log` — fraction of requests logged, 0..1 (default: 1 for
+ *   POST/PUT/DELETE, 0 for GET, which is mostly polling). Below 1, error
+ *   responses are still all logged.
+ * - `stream` — a long-lived response (SSE): its lifetime goes to
+ *   cocoon_http_stream_duration_seconds instead of the request duration
+ *   histogram (default false).
  */
 export function createRouter() {
-  const routes = [];
-
-  function addRoute(method, path, handler) {
-    // Convert path pattern to regex
-    const paramNames = [];
-    const pattern = path.replace(/:([^/]+)/g, (_, name) => {
-      paramNames.push(name);
-      return '([^/]+)';
-    });
-    const regex = new RegExp(`^${pattern}$`);
-    routes.push({ method, regex, paramNames, handler });
-  }
+  const trees = new Map();   // method → root node
+  const newNode = () => ({ children: new Map(), param: null, route: null });
 
-  function match(method, pathname) {
-    for (const route of routes) {
-      if (route.method !== method) continue;
-      const m = pathname.match(route.regex);
-      if (m) {
-        const params = {};
-        route.paramNames.forEach((name, i) => {
-          params[name] = decodeURIComponent(m[i + 1]);
-        });
-        return { handler: route.handler, params };
+  function addRoute(method, path, handler, opts = {}) {
+    const changing = STATE_CHANGING.has(method);
+    const body = opts.body ?? (method === 'POST' || method === 'PUT' ? 'json' : 'none');
+    if (!BODY_MODES.has(body)) throw new Error(`${method} ${path}: unknown body mode '${body}'`);
+    const route = {
+      method,
+      path,
+      handler,
+      body,
+      maxBodyBytes: opts.maxBodyBytes ?? MAX_BODY_SIZE,
+      auth: opts.auth ?? changing,
+      log: opts.log ?? (changing ? 1 : 0),
+      stream: opts.stream ?? false,
+      // Shared metric labels, built once
+      labels: { method, route: path },
+      paramNames: [],
+    };
+
+    if (!trees.has(method)) trees.set(method, newNode());
+    let node = trees.get(method);
+    for (const segment of path.split('/').slice(1)) {
+      if (segment.startsWith(':')) {
+        node.param ??= newNode();
+        node = node.param;
+        route.paramNames.push(segment.slice(1));
+      } else {
+        if (!node.children.has(segment)) node.children.set(segment, newNode());
+        node = node.children.get(segment);
       }
     }
-    return null;
+    if (node.route) throw new Error(`Duplicate route ${method} ${path}`);
+    node.route = route;
+  }
+
+  function find(node, segments, i, values) {
+    if (i === segments.length) return node.route;
+    const child = node.children.get(segments[i]);
+    const found = child && find(child, segments, i + 1, values);
+    if (found) return found;
+    if (!node.param || segments[i] === '') return null;
+    values.push(segments[i]);
+    const viaParam = find(node.param, segments, i + 1, values);
+    if (!viaParam) values.pop();
+    return viaParam;
+  }
+
+  /** @returns {{ route: object, handler: Function, params: object, path: string } | null} */
+  function match(method, pathname) {
+    const root = trees.get(method);
+    if (!root) return null;
+    const values = [];
+    const route = find(root, pathname.split('/').slice(1), 0, values);
+    if (!route) return null;
+    const params = {};
+    route.paramNames.forEach((name, i) => {
+      params[name] = decodeURIComponent(values[i]);
+    });
+    return { route, handler: route.handler, params, path: route.path };
   }
 
   return {
-    get(path, handler) { addRoute('GET', path, handler); },
-    post(path, handler) { addRoute('POST', path, handler); },
-    put(path, handler) { addRoute('PUT', path, handler); },
-    delete(path, handler) { addRoute('DELETE', path, handler); },
+    get(path, handler, opts) { addRoute('GET', path, handler, opts); },
+    post(path, handler, opts) { addRoute('POST', path, handler, opts); },
+    put(path, handler, opts) { addRoute('PUT', path, handler, opts); },
+    delete(path, handler, opts) { addRoute('DELETE', path, handler, opts); },
     match,
   };
 }
 
+const VARIANT_SUFFIX = { br: '-br', gzip: '-gz', identity: '' };
+
 /**
- * Serve static files from webui/dist with SPA fallback.
+ * Serve the WebUI from the in-memory asset cache, with SPA fallback,
+ * Accept-Encoding negotiation and conditional requests.
  */
-function serveStatic(req, res) {
-  let filePath = join(WEBUI_DIST, req.url === '/' ? '/index.html' : req.url);
-
-  // Remove query string
-  filePath = filePath.split('?')[0];
-
-  // Resolve to absolute and check for path traversal
-  filePath = resolve(filePath);
-  if (!filePath.startsWith(WEBUI_DIST)) {
-    sendJSON(res, 403, { error: 'Forbidden' });
+function serveStatic(req, res, pathname, assets) {
+  const asset = assets.lookup(pathname);
+  if (!asset) {
+    sendJSON(res, 404, { error: 'WebUI not built. Run: cd webui && npm run build' });
     return;
   }
 
-  try {
-    const stat = statSync(filePath);
-    if (!stat.isFile()) throw new Error('not a file');
-  } catch {
-    // SPA fallback: serve index.html for unknown paths
-    filePath = resolve(join(WEBUI_DIST, 'index.html'));
-    if (!filePath.startsWith(WEBUI_DIST)) {
-      sendJSON(res, 403, { error: 'Forbidden' });
-      return;
-    }
-  }
-
-  const ext = extname(filePath);
-  const contentType = MIME_TYPES[ext] || 'application/octet-stream';
-
-  try {
-    const content = readFileSync(filePath);
-    // Hashed filenames (assets/) get long cache, HTML gets no-cache
-    const cacheHeader = filePath.includes('/assets/')
-      ? 'public, max-age=31536000, immutable'
-      : 'no-cache';
-    res.writeHead(200, { 'Content-Type': contentType, 'Cache-Control': cacheHeader });
-    res.end(content);
-  } catch {
-    sendJSON(res, 404, { error: 'WebUI not built. Run: cd webui && npm run build' });
+  const encoding = negotiateEncoding(req.headers['accept-encoding'], Object.keys(asset.variants).filter(e => e !== 'identity'));
+  const vary = res.getHeader('Vary');
+  const headers = {
+    'Content-Type': asset.contentType,
+    'Cache-Control': asset.cacheControl,
+    ETag: asset.etag.replace(/"$/, `${VARIANT_SUFFIX[encoding]}"`),
+    'Last-Modified': asset.lastModified,
+    Vary: vary ? `${vary}, Accept-Encoding` : 'Accept-Encoding',
+  };
+  if (isNotModified(req.headers, asset)) {
+    res.writeHead(304, headers);
+    res.end();
+    return;
   }
+  const body = asset.variants[encoding];
+  if (encoding !== 'identity') headers['Content-Encoding'] = encoding;
+  headers['Content-Length'] = body.length;
+  res.writeHead(200, headers);
+  res.end(req.method === 'HEAD' ? undefined : body);
 }
 
 /**
@@ -170,7 +213,8 @@ function setCorsHeaders(req, res) {
     res.setHeader('Vary', 'Origin');
   }
   res.setHeader('Access-Control-Allow-Methods', 'GET, POST, PUT, DELETE, OPTIONS');
-  res.setHeader('Access-Control-Allow-Headers', 'Content-Type, Authorization');
+  res.setHeader('Access-Control-Allow-Headers', 'Content-Type, Authorization, X-Request-Id, X-Priority, X-Route-Hint');
+  res.setHeader('Access-Control-Expose-Headers', 'X-Request-Id, X-Cache');
 }
 
 /**
@@ -181,6 +225,22 @@ function setCorsHeaders(req, res) {
 export function createServer(port) {
   const router = createRouter();
   const token = randomUUID();
+  // Loaded once; reloaded when webui/dist is rebuilt
+  const assets = createStaticAssets({ root: WEBUI_DIST, watch: true, logger: apiLogger });
+
+  /**
+   * GET /api/metrics
+   * Prometheus text exposition of the process-wide registry.
+   */
+  router.get('/api/metrics', async ({ res }) => {
+    const body = metrics.render();
+    res.writeHead(200, {
+      'Content-Type': 'text/plain; version=0.0.4; charset=utf-8',
+      'Content-Length': Buffer.byteLength(body),
+      'Cache-Control': 'no-store',
+    });
+    res.end(body);
+  });
 
   const server = httpCreateServer(async (req, res) => {
     setCorsHeaders(req, res);
@@ -197,43 +257,48 @@ export function createServer(port) {
 
     // API routes
     if (pathname.startsWith('/api/')) {
-      // Require auth token for state-changing methods
-      if (req.method === 'POST' || req.method === 'PUT' || req.method === 'DELETE') {
-        const auth = req.headers.authorization;
-        if (!auth || auth !== `Bearer ${token}`) {
-          sendJSON(res, 401, { error: 'Unauthorized' });
-          return;
-        }
-      }
-
       const matched = router.match(req.method, pathname);
-      if (matched) {
-        try {
-          const body = req.method === 'POST' || req.method === 'PUT'
-            ? await parseJsonBody(req)
-            : {};
-          await matched.handler({ req, res, params: matched.params, body, query: Object.fromEntries(url.searchParams) });
-        } catch (err) {
-          if (!res.headersSent) {
-            const status = err.statusCode || 500;
-            sendJSON(res, status, { error: err.message || 'Internal server error' });
-          }
-        }
-        // Log POST/PUT/DELETE requests (not GETs to avoid noise from polling)
-        if (req.method !== 'GET') {
-          apiLogger.info({ method: req.method, path: pathname, status: res.statusCode }, 'API request');
-        }
+      const route = matched?.route;
+      const authorized = req.headers.authorization === `Bearer ${token}`;
+      // Unknown state-changing paths answer 401 rather than revealing which exist
+      if (route ? route.auth && !authorized : STATE_CHANGING.has(req.method) && !authorized) {
+        sendJSON(res, 401, { error: 'Unauthorized' });
+        return;
+      }
+      if (!route) {
+        sendJSON(res, 404, { error: 'Not found' });
         return;
       }
 
-      // No matching API route
-      sendJSON(res, 404, { error: 'Not found' });
+      // Labelled by route pattern (not the raw path) to keep cardinality bounded
+      const startedAt = process.hrtime.bigint();
+      res.on('close', () => {
+        httpRequests.inc({ ...route.labels, status: res.statusCode });
+        (route.stream ? streamDuration : httpDuration).observe(route.labels, Number(process.hrtime.bigint() - startedAt) / 1e9);
+      });
+      try {
+        if (route.body !== 'none' && parseInt(req.headers['content-length'] || '0', 10) > route.maxBodyBytes) throw bodyTooLarge();
+        const body = route.body === 'json' ? await parseJsonBody(req, route.maxBodyBytes)
+          : route.body === 'raw' ? null
+          : {};
+        await matched.handler({ req, res, params: matched.params, body, query: Object.fromEntries(url.searchParams) });
+      } catch (err) {
+        if (!res.headersSent) {
+          const status = err.statusCode || 500;
+          sendJSON(res, status, { error: err.message || 'Internal server error' });
+        }
+      }
+      // Sampled routes still log every error response
+      if (route.log > 0 && (route.log >= 1 || res.statusCode >= 400 || Math.random() < route.log)) {
+        apiLogger.info({ method: req.method, path: pathname, status: res.statusCode }, 'API request');
+      }
       return;
     }
 
     // Static files
-    serveStatic(req, res);
+    serveStatic(req, res, pathname, assets);
   });
+  server.on('close', () => assets.close());
 
   server.listen(port, '127.0.0.1', () => {
     apiLogger.info(`COCOON WebUI running at http://127.0.0.1:${port}`);
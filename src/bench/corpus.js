@@ -0,0 +1,40 @@
+/**
+ * Synthetic -v4 style client-runner stdout for the benchmarks: mostly
+ * noise (including the lines the event classifier collapses), a lifecycle
+ * line every 500, some ANSI-colored lines.
+ */
+
+const NOISE = [
+  '[ 4][t 1][2025-11-02 10:12:44.%][AdnlPeer.cpp:412][!adnl] received packet size=%',
+  '[ 4][t 3][2025-11-02 10:12:44.%][TonlibClient.cpp:2201][!tonlib] query %: got block',
+  '[ 3][t 2][2025-11-02 10:12:44.%][ProxyConnection.cpp:188][!proxy] sent %B to upstream',
+  '\x1b[1;33m[ 2][t 0][2025-11-02 10:12:44.%][Client.cpp:77] slow query %ms\x1b[0m',
+  '[ 4][t 1][2025-11-02 10:12:44.%][Rldp.cpp:90][!rldp] transfer % progress',
+  '[ 3][t 2][2025-11-02 10:12:44.%][FwdProxy.cpp:51] set policy name any',
+  '[ 4][t 1][2025-11-02 10:12:44.%][router.cpp:230] dropping received message %',
+  '[ 2][t 2][2025-11-02 10:12:44.%][Client.cpp:301] query failed: Error : 653 : cancelled',
+];
+
+const LIFECYCLE = [
+  '[ 3][t 0][2025-11-02 10:12:44.%][TonlibClient.cpp:42] TonLib is synced',
+  '[ 3][t 2][2025-11-02 10:12:44.%][Proxy.cpp:88] OK, connecting to [10.0.0.%:8888]',
+  '[ 3][t 2][2025-11-02 10:12:44.%][Proxy.cpp:99] handshake completed successfully',
+];
+
+const ERROR = '[ 0][t 4][2025-11-02 10:12:44.%][Rpc.cpp:5] Error: timeout %';
+
+/**
+ * @param {number} [lines=200000]
+ * @param {object} [opts]
+ * @param {boolean} [opts.errors=true] - include error lifecycle lines (spawnWithPrefix prints those to stderr)
+ * @returns {string}
+ */
+export function syntheticLog(lines = 200_000, { errors = true } = {}) {
+  const lifecycle = errors ? [...LIFECYCLE, ERROR] : LIFECYCLE;
+  const out = [];
+  for (let i = 0; i < lines; i++) {
+    const tpl = i % 500 === 0 ? lifecycle[(i / 500) % lifecycle.length] : NOISE[i % NOISE.length];
+    out.push(tpl.replaceAll('%', String(i % 1000)));
+  }
+  return out.join('\n') + '\n';
+}
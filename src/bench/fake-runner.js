@@ -0,0 +1,108 @@
+#!/usr/bin/env node
+/**
+ * Stand-in for the client-runner / router pair in benchmarks.
+ *
+ * As a script it replays recorded stdout, so spawnWithPrefix() can spawn
+ * it like the real binary:
+ *
+ *   node src/bench/fake-runner.js replay <recorded.log> [--rate <lines/sec>]
+ *
+ * `--rate 0` (default) writes as fast as the pipe takes it. In-process,
+ * createFakeRunner() serves /jsonstats (and /v1/models) with configurable
+ * latency, and can crash and come back to exercise the proxy cache.
+ */
+
+import { createServer } from 'http';
+import { readFileSync } from 'fs';
+import { fileURLToPath } from 'url';
+
+export const FAKE_RUNNER_PATH = fileURLToPath(import.meta.url);
+
+const DEFAULT_STATS = {
+  status: { enabled: true, ton_last_synced_at: 1 },
+  wallet: { address: '0:' + '0'.repeat(64), balance: 20_000_000_000 },
+  proxies: [],
+  connections: [],
+};
+
+/**
+ * @param {object} [opts]
+ * @param {number} [opts.latencyMs=0] - delay before each response
+ * @param {object} [opts.stats] - /jsonstats body
+ */
+export function createFakeRunner({ latencyMs = 0, stats = DEFAULT_STATS } = {}) {
+  let server = null;
+  let port = 0;
+  const sockets = new Set();
+  const counts = { requests: 0 };
+
+  function handle(req, res) {
+    counts.requests++;
+    const body = req.url === '/v1/models'
+      ? JSON.stringify({ object: 'list', data: [{ id: 'fake-model' }] })
+      : JSON.stringify(stats);
+    setTimeout(() => {
+      if (res.destroyed) return;
+      res.writeHead(200, { 'Content-Type': 'application/json', 'Content-Length': Buffer.byteLength(body) });
+      res.end(body);
+    }, latencyMs);
+  }
+
+  /** Start (or restart, on the same port) listening; resolves with the port. */
+  function listen(onPort = port) {
+    return new Promise((resolve, reject) => {
+      server = createServer(handle);
+      server.on('connection', (socket) => {
+        sockets.add(socket);
+        socket.on('close', () => sockets.delete(socket));
+      });
+      server.once('error', reject);
+      server.listen(onPort, '127.0.0.1', () => {
+        port = server.address().port;
+        resolve(port);
+      });
+    });
+  }
+
+  /** Drop every connection and stop listening, like a crashed binary. */
+  function crash() {
+    for (const socket of sockets) socket.destroy();
+    return new Promise(resolve => (server ? server.close(() => resolve()) : resolve()));
+  }
+
+  return {
+    listen,
+    crash,
+    close: crash,
+    setLatency(ms) { latencyMs = ms; },
+    get port() { return port; },
+    get requests() { return counts.requests; },
+  };
+}
+
+/** Write `lines` to stdout at `ratePerSec` (0: unpaced), honouring backpressure. */
+async function replay(lines, ratePerSec) {
+  const startedAt = Date.now();
+  const BATCH = 256;
+  for (let i = 0; i < lines.length; i += BATCH) {
+    if (ratePerSec > 0) {
+      const due = startedAt + (i / ratePerSec) * 1000;
+      const wait = due - Date.now();
+      if (wait > 0) await new Promise(r => setTimeout(r, wait));
+    }
+    const chunk = lines.slice(i, i + BATCH).join('\n') + '\n';
+    if (!process.stdout.write(chunk)) await new Promise(r => process.stdout.once('drain', r));
+  }
+}
+
+if (process.argv[1] === FAKE_RUNNER_PATH) {
+  const [mode, file, ...rest] = process.argv.slice(2);
+  if (mode !== 'replay' || !file) {
+    console.error('usage: fake-runner.js replay <recorded.log> [--rate <lines/sec>]');
+    process.exit(2);
+  }
+  const rateIdx = rest.indexOf('--rate');
+  const rate = rateIdx !== -1 ? parseFloat(rest[rateIdx + 1]) || 0 : 0;
+  const lines = readFileSync(file, 'utf-8').split('\n').filter(Boolean);
+  await replay(lines, rate);
+}
@@ -0,0 +1,88 @@
+#!/usr/bin/env node
+/**
+ * Lines/sec of the spawnWithPrefix line pipeline: legacy (string re-split +
+ * sequential patterns) vs src/lib/line-parser.js.
+ *
+ * Usage: node src/bench/line-parser.bench.js [recorded.log] [--runs N]
+ *
+ * Without a file, a synthetic -v4 style client-runner log is generated
+ * (see corpus.js).
+ */
+
+import { readFileSync } from 'fs';
+import { performance } from 'perf_hooks';
+import { createLineSplitter, matchLifecycle, stripAnsi, LIFECYCLE_PATTERNS } from '../lib/line-parser.js';
+import { syntheticLog } from './corpus.js';
+
+const CHUNK_BYTES = 64 * 1024;  // pipe read size
+
+function chunk(buf) {
+  const chunks = [];
+  for (let i = 0; i < buf.length; i += CHUNK_BYTES) chunks.push(buf.subarray(i, i + CHUNK_BYTES));
+  return chunks;
+}
+
+/** The pipeline as it was before line-parser.js. */
+function legacy(chunks) {
+  let events = 0;
+  const processLine = (line) => {
+    if (!line.trim()) return;
+    const clean = line.replace(/\x1b\[[0-9;]*m/g, '');
+    for (const lp of LIFECYCLE_PATTERNS) {
+      if (clean.match(lp.pattern)) { events++; return; }
+    }
+  };
+  let buffer = '';
+  for (const data of chunks) {
+    buffer += data.toString();
+    const lines = buffer.split('\n');
+    buffer = lines.pop();
+    for (const line of lines) processLine(line);
+  }
+  if (buffer.trim()) processLine(buffer);
+  return events;
+}
+
+function current(chunks) {
+  let events = 0;
+  const splitter = createLineSplitter((line) => {
+    const clean = stripAnsi(line).trim();
+    if (clean && matchLifecycle(clean)) events++;
+  });
+  for (const data of chunks) splitter.push(data);
+  splitter.end();
+  return events;
+}
+
+function measure(fn, chunks, runs) {
+  fn(chunks);  // warm-up
+  const times = [];
+  let events = 0;
+  for (let i = 0; i < runs; i++) {
+    const t0 = performance.now();
+    events = fn(chunks);
+    times.push(performance.now() - t0);
+  }
+  times.sort((a, b) => a - b);
+  return { ms: times[Math.floor(times.length / 2)], events };
+}
+
+const args = process.argv.slice(2);
+const runsIdx = args.indexOf('--runs');
+const runs = runsIdx !== -1 ? parseInt(args.splice(runsIdx, 2)[1], 10) : 5;
+const input = args[0] ? readFileSync(args[0]) : Buffer.from(syntheticLog());
+const lineCount = input.toString().split('\n').filter(l => l.trim()).length;
+const chunks = chunk(input);
+
+const results = { legacy: measure(legacy, chunks, runs), current: measure(current, chunks, runs) };
+if (results.legacy.events !== results.current.events) {
+  console.error(`event count mismatch: legacy=${results.legacy.events} current=${results.current.events}`);
+  process.exit(1);
+}
+
+console.log(`${lineCount} lines, ${(input.length / 1024 / 1024).toFixed(1)} MiB, median of ${runs} runs`);
+for (const [name, { ms }] of Object.entries(results)) {
+  const perSec = Math.round(lineCount / (ms / 1000));
+  console.log(`  ${name.padEnd(8)} ${ms.toFixed(1).padStart(8)} ms  ${perSec.toLocaleString('en-US').padStart(12)} lines/sec`);
+}
+console.log(`  speedup  ${(results.legacy.ms / results.current.ms).toFixed(2)}x`);
@@ -0,0 +1,302 @@
+#!/usr/bin/env node
+/**
+ * Regression benchmarks for the client-runner event pipeline and the
+ * /jsonstats proxy cache, against the fake runner (fake-runner.js):
+ *
+ * - spawn:    lines/sec through spawnWithPrefix() + classifyEvent(), the
+ *             fake runner replaying the log as a child process
+ * - classify: classifyEvent() alone (dedup and noise matching)
+ * - fanout:   event-to-SSE latency and memory with N real SSE subscribers
+ *             (sse-subscribers.js, in a child process), published like
+ *             pushEvent() (broadcaster + log aggregator)
+ * - proxy:    /api/jsonstats latency, errors and upstream load with a slow
+ *             runner that crashes and comes back mid-run
+ *
+ * Usage: node src/bench/pipeline.bench.js [recorded.log] [--runs N]
+ *          [--subscribers 1,10,100] [--only spawn,classify,fanout,proxy]
+ *          [--output results.json] [--compare baseline.json] [--tolerance 0.15]
+ *
+ * Results are one JSON document ({ metrics: { name: { value, unit,
+ * better } } }); with --compare the run exits 1 when a metric regressed
+ * beyond tolerance against the baseline file. Noisy metrics (tail
+ * latency, memory) carry their own tolerance and minimum absolute change;
+ * --tolerance applies to the rest.
+ */
+
+import { mkdtempSync, readFileSync, rmSync, writeFileSync } from 'fs';
+import { fork } from 'child_process';
+import { createServer as createHttpServer } from 'http';
+import { tmpdir } from 'os';
+import { join } from 'path';
+import { performance } from 'perf_hooks';
+import { spawnWithPrefix } from '../lib/process.js';
+import { classifyEvent, resetClassifier } from '../lib/event-classifier.js';
+import { createBroadcaster } from '../lib/sse-broadcaster.js';
+import { createLogAggregator } from '../lib/log-aggregator.js';
+import { matchLifecycle, stripAnsi } from '../lib/line-parser.js';
+import { distribution, compareResults } from '../lib/bench.js';
+import { syntheticLog } from './corpus.js';
+import { createFakeRunner, FAKE_RUNNER_PATH } from './fake-runner.js';
+import { SSE_SUBSCRIBERS_PATH, wallNow } from './sse-subscribers.js';
+
+// The management server logs at info; keep stdout for results
+process.env.LOG_LEVEL ??= 'warn';
+
+const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+const mb = (bytes) => Math.round((bytes / 1024 / 1024) * 10) / 10;
+
+const FANOUT_EVENTS = 1000;
+const FANOUT_RATE = 200;           // info events per second
+const FANOUT_DEBUG_PER_EVENT = 10; // log lines between events, batched by the aggregator
+const PROXY = { pollers: 20, intervalMs: 100, durationMs: 6000, crashAtMs: 2000, downMs: 2000, latencyMs: 150 };
+
+function parseArgs(argv) {
+  const args = [...argv];
+  const take = (flag, fallback) => {
+    const i = args.indexOf(flag);
+    return i === -1 ? fallback : args.splice(i, 2)[1];
+  };
+  const opts = {
+    runs: parseInt(take('--runs', '5'), 10),
+    subscribers: take('--subscribers', '1,10,100').split(',').map(Number).filter(n => n > 0),
+    only: take('--only', 'spawn,classify,fanout,proxy').split(','),
+    output: take('--output', null),
+    compare: take('--compare', null),
+    tolerance: parseFloat(take('--tolerance', '0.15')),
+  };
+  opts.log = args[0] ?? null;
+  return opts;
+}
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+// ── spawn ───────────────────────────────────────────────────
+
+/** One replay through a child process; ms from the first to the last line. */
+function replayOnce(logPath, lineCount) {
+  return new Promise((resolve, reject) => {
+    let seen = 0;
+    let first = null;
+    spawnWithPrefix(process.execPath, [FAKE_RUNNER_PATH, 'replay', logPath], {
+      prefix: 'bench', color: 'gray', quiet: true,
+      onEvent: (event, data) => {
+        if (event === 'exit') {
+          if (data.code !== 0) reject(new Error(`fake runner exited with ${data.code}`));
+          // Lines still in the pipe may arrive after the exit event
+          else setTimeout(() => reject(new Error(`saw ${seen}/${lineCount} lines`)), 2000).unref();
+          return;
+        }
+        first ??= performance.now();
+        classifyEvent(event, data);
+        if (++seen === lineCount) resolve(performance.now() - first);
+      },
+    });
+  });
+}
+
+async function benchSpawn(logPath, lineCount, runs) {
+  const times = [];
+  for (let i = 0; i < runs; i++) {
+    resetClassifier();
+    times.push(await replayOnce(logPath, lineCount));
+  }
+  return { 'spawn.linesPerSec': { value: Math.round(lineCount / (median(times) / 1000)), unit: 'lines/s', better: 'higher', tolerance: 0.3 } };
+}
+
+// ── classify ────────────────────────────────────────────────
+
+function benchClassify(lines, runs) {
+  const cleaned = lines.map(l => stripAnsi(l).trim()).filter(l => l && !matchLifecycle(l));
+  const times = [];
+  for (let i = 0; i < runs + 1; i++) {
+    resetClassifier();
+    const t0 = performance.now();
+    for (const line of cleaned) classifyEvent('log', [line]);
+    if (i > 0) times.push(performance.now() - t0);  // first pass is warm-up
+  }
+  return { 'classify.eventsPerSec': { value: Math.round(cleaned.length / (median(times) / 1000)), unit: 'events/s', better: 'higher', tolerance: 0.3 } };
+}
+
+// ── fanout ──────────────────────────────────────────────────
+
+/** Fork `n` SSE subscribers; resolves once all are connected. */
+function forkSubscribers(port, n) {
+  return new Promise((resolve, reject) => {
+    const child = fork(SSE_SUBSCRIBERS_PATH, [String(port), String(n)]);
+    child.once('error', reject);
+    child.once('message', () => resolve(child));
+  });
+}
+
+async function benchFanout(subscribers, lines) {
+  const events = createBroadcaster({ capacity: 200 });
+  const logs = createLogAggregator({ onFrame: (frame) => events.send(frame) });
+  // Same routing as pushEvent() in api/routes/client.js
+  const push = (event) => {
+    if (event.level === 'debug') {
+      logs.add(event);
+      return;
+    }
+    logs.flush();
+    events.publish(event);
+  };
+
+  const server = createHttpServer((req, res) => {
+    res.writeHead(200, { 'Content-Type': 'text/event-stream', 'Cache-Control': 'no-cache' });
+    res.flushHeaders();
+    const remove = events.add(res, null);
+    req.on('close', remove);
+  });
+  await new Promise(r => server.listen(0, '127.0.0.1', r));
+  const { port } = server.address();
+
+  const metrics = {};
+  const debugLines = lines.filter(l => !matchLifecycle(stripAnsi(l)));
+  for (const n of subscribers) {
+    const before = process.memoryUsage();
+    const expected = n * FANOUT_EVENTS;
+    const child = await forkSubscribers(port, n);
+    while (events.size < n) await sleep(5);
+
+    let peakHeap = 0;
+    let peakRss = 0;
+    const sample = setInterval(() => {
+      const m = process.memoryUsage();
+      peakHeap = Math.max(peakHeap, m.heapUsed);
+      peakRss = Math.max(peakRss, m.rss);
+    }, 50);
+
+    const startedAt = performance.now();
+    resetClassifier();
+    for (let i = 0; i < FANOUT_EVENTS; i++) {
+      const due = startedAt + (i / FANOUT_RATE) * 1000;
+      const wait = due - performance.now();
+      if (wait > 1) await sleep(wait);
+      for (let j = 0; j < FANOUT_DEBUG_PER_EVENT; j++) {
+        push(classifyEvent('log', [debugLines[(i * FANOUT_DEBUG_PER_EVENT + j) % debugLines.length]]));
+      }
+      push({ type: 'milestone', level: 'info', message: `event ${i}`, category: 'milestone', timestamp: Date.now(), sentAt: wallNow() });
+    }
+    child.send({ done: true, expected });
+    const { received, latencies } = await new Promise(r => child.once('message', r));
+    clearInterval(sample);
+    logs.flush();
+
+    const lat = distribution(latencies);
+    metrics[`fanout.${n}.p50Ms`] = { value: lat?.p50 ?? null, unit: 'ms', better: 'lower', tolerance: 1, minDelta: 2 };
+    metrics[`fanout.${n}.p95Ms`] = { value: lat?.p95 ?? null, unit: 'ms', better: 'lower', tolerance: 1, minDelta: 10 };
+    metrics[`fanout.${n}.delivered`] = { value: Math.round((received / expected) * 1000) / 1000, unit: 'ratio', better: 'higher', tolerance: 0 };
+    metrics[`fanout.${n}.heapDeltaMb`] = { value: mb(Math.max(0, peakHeap - before.heapUsed)), unit: 'MiB', better: 'lower', tolerance: 0.5, minDelta: 16 };
+    metrics[`fanout.${n}.rssDeltaMb`] = { value: mb(Math.max(0, peakRss - before.rss)), unit: 'MiB', better: 'lower', tolerance: 0.5, minDelta: 32 };
+
+    while (events.size > 0) await sleep(10);
+    // Next round starts without this round's replay backlog
+    events.clear();
+  }
+  server.close();
+  return metrics;
+}
+
+// ── proxy ───────────────────────────────────────────────────
+
+async function benchProxy() {
+  const { createServer } = await import('../api/server.js');
+  const { register } = await import('../api/routes/proxy.js');
+  const { setClientState, setProxyReady, clearClientState } = await import('../services/client-state.js');
+
+  const runner = createFakeRunner({ latencyMs: PROXY.latencyMs });
+  const runnerPort = await runner.listen(0);
+  const { server, router } = createServer(0);
+  register(router);
+  await new Promise(r => (server.listening ? r() : server.once('listening', r)));
+  const base = `http://127.0.0.1:${server.address().port}`;
+  setClientState(runnerPort, 0);
+  setProxyReady(0);
+
+  const latencies = [];
+  let errors = 0;
+  let requests = 0;
+  const startedAt = performance.now();
+  const poller = async () => {
+    while (performance.now() - startedAt < PROXY.durationMs) {
+      const t0 = performance.now();
+      try {
+        const res = await fetch(`${base}/api/jsonstats`);
+        await res.arrayBuffer();
+        if (!res.ok) errors++;
+      } catch {
+        errors++;
+      }
+      requests++;
+      latencies.push(performance.now() - t0);
+      await sleep(PROXY.intervalMs);
+    }
+  };
+  const outage = (async () => {
+    await sleep(PROXY.crashAtMs);
+    await runner.crash();
+    await sleep(PROXY.downMs);
+    await runner.listen(runnerPort);
+  })();
+  await Promise.all([...Array.from({ length: PROXY.pollers }, poller), outage]);
+
+  const wallSec = (performance.now() - startedAt) / 1000;
+  const lat = distribution(latencies);
+  clearClientState();
+  await runner.close();
+  server.close();
+  return {
+    'proxy.p50Ms': { value: lat.p50, unit: 'ms', better: 'lower', tolerance: 1, minDelta: 5 },
+    'proxy.p95Ms': { value: lat.p95, unit: 'ms', better: 'lower', tolerance: 1, minDelta: 20 },
+    'proxy.errorRate': { value: Math.round((errors / requests) * 1000) / 1000, unit: 'ratio', better: 'lower', minDelta: 0.01 },
+    'proxy.upstreamPerSec': { value: Math.round((runner.requests / wallSec) * 100) / 100, unit: 'req/s', better: 'lower', tolerance: 0.5 },
+  };
+}
+
+// ── main ────────────────────────────────────────────────────
+
+const opts = parseArgs(process.argv.slice(2));
+const tmp = mkdtempSync(join(tmpdir(), 'cocoon-bench-'));
+const logPath = opts.log ?? join(tmp, 'synthetic.log');
+// spawnWithPrefix prints error lines to stderr; keep them out of the synthetic corpus
+if (!opts.log) writeFileSync(logPath, syntheticLog(200_000, { errors: false }));
+const lines = readFileSync(logPath, 'utf-8').split('\n').filter(l => stripAnsi(l).trim());
+
+const results = {
+  version: 1,
+  createdAt: new Date().toISOString(),
+  node: process.version,
+  corpus: { file: opts.log, lines: lines.length },
+  metrics: {},
+};
+
+try {
+  if (opts.only.includes('spawn')) Object.assign(results.metrics, await benchSpawn(logPath, lines.length, opts.runs));
+  if (opts.only.includes('classify')) Object.assign(results.metrics, benchClassify(lines, opts.runs));
+  if (opts.only.includes('fanout')) Object.assign(results.metrics, await benchFanout(opts.subscribers, lines));
+  if (opts.only.includes('proxy')) Object.assign(results.metrics, await benchProxy());
+} finally {
+  rmSync(tmp, { recursive: true, force: true });
+}
+
+const json = JSON.stringify(results, null, 2) + '\n';
+if (opts.output) writeFileSync(opts.output, json);
+
+let regressions = [];
+if (opts.compare) {
+  const baseline = JSON.parse(readFileSync(opts.compare, 'utf-8'));
+  const compared = compareResults(baseline, results, { tolerance: opts.tolerance });
+  regressions = compared.regressions;
+  // Human-readable comparison on stderr; stdout stays the JSON document
+  for (const r of compared.rows) {
+    const change = r.change == null ? 'new' : `${r.change >= 0 ? '+' : ''}${(r.change * 100).toFixed(1)}%`;
+    console.error(`${r.regressed ? 'REGRESSED' : '         '} ${r.name.padEnd(28)} ${String(r.baseline ?? '—').padStart(12)} → ${String(r.current ?? '—').padStart(12)}  ${change}`);
+  }
+  console.error(regressions.length ? `${regressions.length} regression(s) against ${opts.compare}` : `no regressions against ${opts.compare}`);
+}
+process.stdout.write(json);
+// Proxy route module timers and keep-alive sockets would hold the process open
+process.exit(regressions.length ? 1 : 0);
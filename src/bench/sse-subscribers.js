@@ -0,0 +1,67 @@
+/**
+ * SSE subscribers for the fanout benchmark, forked so that parsing on the
+ * client side doesn't compete with the publisher's event loop.
+ *
+ *   fork(SSE_SUBSCRIBERS_PATH, [port, count])
+ *
+ * Sends { ready } once every connection is open; on { done } it waits for
+ * `expected` events per client (or a short grace period) and replies with
+ * { received, latencies }. Latency is received minus the event's `sentAt`,
+ * both as performance.timeOrigin + performance.now() (comparable across
+ * processes on one host).
+ */
+
+import { get as httpGet } from 'http';
+import { performance } from 'perf_hooks';
+import { fileURLToPath } from 'url';
+
+export const SSE_SUBSCRIBERS_PATH = fileURLToPath(import.meta.url);
+
+/** Epoch ms with sub-millisecond resolution. */
+export const wallNow = () => performance.timeOrigin + performance.now();
+
+function connect(port, onSentAt) {
+  return new Promise((resolve, reject) => {
+    httpGet({ host: '127.0.0.1', port, path: '/events' }, (res) => {
+      let buffered = '';
+      res.setEncoding('utf-8');
+      res.on('data', (text) => {
+        const now = wallNow();
+        const frames = (buffered + text).split('\n\n');
+        buffered = frames.pop();
+        for (const frame of frames) {
+          // Cheaper than JSON.parse on every frame
+          const m = frame.match(/"sentAt":([\d.]+)/);
+          if (m) onSentAt(now - parseFloat(m[1]));
+        }
+      });
+      resolve(res);
+    }).on('error', reject);
+  });
+}
+
+if (process.argv[1] === SSE_SUBSCRIBERS_PATH) {
+  const port = parseInt(process.argv[2], 10);
+  const count = parseInt(process.argv[3], 10);
+  const latencies = [];
+  let finish = null;
+  let expected = Infinity;
+  const onSentAt = (ms) => {
+    latencies.push(ms);
+    if (latencies.length >= expected) finish?.();
+  };
+
+  const clients = await Promise.all(Array.from({ length: count }, () => connect(port, onSentAt)));
+  process.send({ ready: true });
+  process.on('message', async (msg) => {
+    if (!msg.done) return;
+    expected = msg.expected;
+    await new Promise((resolve) => {
+      finish = resolve;
+      if (latencies.length >= expected) resolve();
+      setTimeout(resolve, 10_000).unref();
+    });
+    for (const res of clients) res.destroy();
+    process.send({ received: latencies.length, latencies }, () => process.exit(0));
+  });
+}
@@ -8,6 +8,7 @@ import { withdrawCommand } from './commands/withdraw.js';
 import { unstakeCommand } from './commands/unstake.js';
 import { cashoutCommand } from './commands/cashout.js';
 import { uiCommand } from './commands/ui.js';
+import { benchCommand } from './commands/bench.js';
 
 const program = new Command();
 
@@ -26,6 +27,8 @@ program
   .description('Start the COCOON client (router + client-runner)')
   .option('--verbosity <level>', 'Client verbosity level (0-5)', '1')
   .option('--router-policy <policy>', 'Router TEE policy (tdx, any)', 'any')
+  .option('--persist-state', 'Keep TonLib state in .cocoon-state/ across restarts')
+  .option('--cold-start', 'Discard persisted state before starting')
   .action(startCommand);
 
 program
@@ -40,6 +43,22 @@ program
   .option('-p, --port <port>', 'Client HTTP port (auto-detected from client.conf)')
   .action(modelsCommand);
 
+program
+  .command('bench')
+  .description('Load-test /v1/chat/completions and report latency percentiles')
+  .option('-p, --port <port>', 'Client HTTP port (auto-detected from client.conf)')
+  .option('-c, --concurrency <n>', 'Requests in flight; a comma list sweeps (e.g. 1,4,16)', '4')
+  .option('-r, --rate <rps>', 'Cap request starts per second (default: closed loop)')
+  .option('-n, --requests <n>', 'Requests per run (default: 50, unbounded with --duration)')
+  .option('-d, --duration <seconds>', 'Stop starting requests after this long')
+  .option('-m, --models <list>', 'Comma-separated models (default: all from /v1/models)')
+  .option('--prompts <file>', 'Prompt corpus: .jsonl of {messages} / {prompt}, or one prompt per line')
+  .option('--max-tokens <n>', 'max_tokens per request', '128')
+  .option('--router-policy <list>', 'Launch the client per router policy and sweep (e.g. any,tdx)')
+  .option('--instances <list>', 'Launch a pool per size and sweep (e.g. 1,2,4)')
+  .option('-o, --output <file>', 'Results JSON (default: .cocoon-state/bench/bench-<time>.json)')
+  .action(benchCommand);
+
 program
   .command('withdraw')
   .description('Withdraw TON from cocoon wallet to owner wallet')
@@ -64,6 +83,9 @@ program
   .description('Launch web management UI')
   .option('-p, --port <number>', 'Port for web UI', '3000')
   .option('--verbosity <level>', 'Client verbosity level (0-5)', '1')
+  .option('--instances <n>', 'Client-runner instances to supervise (pool mode when > 1)', '1')
+  .option('--supervise', 'Restart crashed client-runner instances with backoff')
+  .option('--standby', 'Keep a warm standby instance for failover (implies --supervise)')
   .action((opts) => uiCommand(opts));
 
 program.parse();
@@ -0,0 +1,229 @@
+import { existsSync, mkdirSync, readFileSync, writeFileSync } from 'fs';
+import { resolve, extname } from 'path';
+import { performance } from 'perf_hooks';
+import { readClientConf, getHttpPort } from '../lib/config.js';
+import { launchClient, isFullyReady } from '../lib/client.js';
+import { STATE_ROOT } from '../lib/state-dir.js';
+import { runLoad, readCompletion, summarize, rotate } from '../lib/bench.js';
+import {
+  printBanner, row, section, success, error, separator, updateLine, finishLine,
+  CYAN, DIM, GREEN, RED, YELLOW,
+} from '../lib/ui.js';
+
+const BENCH_DIR = resolve(STATE_ROOT, 'bench');
+const REQUEST_TIMEOUT_MS = 300_000;
+
+// Short / medium / long prompts, used without --prompts
+const DEFAULT_PROMPTS = [
+  'Say hello in five words.',
+  'Explain in three sentences how a blockchain reaches consensus.',
+  'Write a short poem about the ocean at night.',
+  'List ten practical tips for writing maintainable code, one line each.',
+  'Summarise the plot of a detective story of your choice in one paragraph, then list its three main characters.',
+];
+
+/** "1,4,16" → [1, 4, 16] */
+function numberList(value, fallback) {
+  const list = String(value ?? '').split(',').map(v => parseInt(v.trim(), 10)).filter(n => n > 0);
+  return list.length ? list : fallback;
+}
+
+function stringList(value) {
+  return String(value ?? '').split(',').map(v => v.trim()).filter(Boolean);
+}
+
+/**
+ * Prompt corpus: a .jsonl of { messages } or { prompt } objects, or a text
+ * file with one prompt per line.
+ */
+function loadPrompts(path) {
+  if (!path) return DEFAULT_PROMPTS.map(p => [{ role: 'user', content: p }]);
+  const lines = readFileSync(path, 'utf-8').split('\n').map(l => l.trim()).filter(Boolean);
+  if (extname(path) !== '.jsonl') return lines.map(p => [{ role: 'user', content: p }]);
+  return lines.map((line) => {
+    const item = JSON.parse(line);
+    return item.messages ?? [{ role: 'user', content: item.prompt ?? String(item) }];
+  });
+}
+
+async function fetchModels(port) {
+  const res = await fetch(`http://127.0.0.1:${port}/v1/models`);
+  if (!res.ok) throw new Error(`/v1/models: HTTP ${res.status}`);
+  const body = await res.json();
+  return (body.data || body.models || []).map(m => m.id || m.name || m).filter(Boolean);
+}
+
+/** One completion against `port`; never throws (failures are samples too). */
+async function sendCompletion(port, model, messages, maxTokens) {
+  const startedAt = performance.now();
+  try {
+    const res = await fetch(`http://127.0.0.1:${port}/v1/chat/completions`, {
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' },
+      body: JSON.stringify({ model, messages, stream: true, max_tokens: maxTokens }),
+      signal: AbortSignal.timeout(REQUEST_TIMEOUT_MS),
+    });
+    if (!res.ok) {
+      await res.arrayBuffer().catch(() => {});
+      return { ok: false, status: res.status, model, e2eMs: performance.now() - startedAt };
+    }
+    return { ok: true, status: res.status, model, ...(await readCompletion(res, startedAt)) };
+  } catch (err) {
+    return { ok: false, status: null, model, error: err.message, e2eMs: performance.now() - startedAt };
+  }
+}
+
+/** Launch `instances` router + client-runner pairs and wait until all are ready. */
+async function launchPool(config, instances, routerPolicy) {
+  const base = parseInt(config.instance || '0', 10);
+  const launched = [];
+  try {
+    for (let i = 0; i < instances; i++) {
+      launched.push(launchClient({ ...config, instance: String(base + i), pool_index: String(i) }, {
+        routerPolicy,
+        isReady: isFullyReady,
+      }));
+    }
+  } catch (err) {
+    await stopPool(launched);
+    throw err;
+  }
+  updateLine(`${YELLOW('⟳')} waiting for ${instances} instance(s) (${routerPolicy})...`);
+  const ready = await Promise.all(launched.map(l => l.ready));
+  finishLine();
+  if (ready.some(r => !r)) {
+    await stopPool(launched);
+    throw new Error('client not ready (see npx cocoon start for details)');
+  }
+  return launched;
+}
+
+/**
+ * Stop a pool and wait until its processes are gone, so the next sweep
+ * combination can bind the same HTTP and router ports.
+ */
+async function stopPool(launched) {
+  await Promise.all(launched.map(l => l.kill()));
+  for (const l of launched) l.cleanup();
+}
+
+const ms = (d, key = 'p50') => (d ? `${d[key]}ms` : '—');
+
+function printSummary(s) {
+  row('Requests', `${s.ok}/${s.requests} ok ${DIM(`· ${s.requestsPerSec} req/s · ${s.wallSec}s`)}`);
+  row('Errors', s.errors
+    ? RED(`${(s.errorRate * 100).toFixed(1)}% ${DIM(`503 ${(s.rate503 * 100).toFixed(1)}% · 504 ${(s.rate504 * 100).toFixed(1)}%`)}`)
+    : GREEN('none'));
+  row('TTFT', `p50 ${ms(s.ttftMs)} ${DIM(`p95 ${ms(s.ttftMs, 'p95')} · p99 ${ms(s.ttftMs, 'p99')}`)}`);
+  row('Inter-token', `p50 ${ms(s.itlMs)} ${DIM(`p95 ${ms(s.itlMs, 'p95')} · p99 ${ms(s.itlMs, 'p99')}`)}`);
+  row('End-to-end', `p50 ${ms(s.e2eMs)} ${DIM(`p95 ${ms(s.e2eMs, 'p95')} · p99 ${ms(s.e2eMs, 'p99')}`)}`);
+  row('Tokens/sec', `${s.tokensPerSec} total ${DIM(`· ${s.decodeTokensPerSec?.p50 ?? '—'} per stream (p50)`)}`);
+}
+
+export async function benchCommand(opts) {
+  const config = readClientConf();
+  const concurrencies = numberList(opts.concurrency, [4]);
+  const rate = parseFloat(opts.rate) || 0;
+  const durationMs = opts.duration ? parseFloat(opts.duration) * 1000 : Infinity;
+  // A duration alone runs unbounded in count; otherwise 50 requests per run
+  const requests = parseInt(opts.requests, 10) || (Number.isFinite(durationMs) ? Infinity : 50);
+  const maxTokens = parseInt(opts.maxTokens, 10) || 128;
+  const prompts = loadPrompts(opts.prompts);
+
+  // Sweeping --router-policy / --instances launches the client per combination;
+  // otherwise the running client on --port is measured
+  const sweep = opts.routerPolicy != null || opts.instances != null;
+  if (sweep && !config) {
+    error('No client.conf found.');
+    process.exit(1);
+  }
+  const policies = sweep ? (stringList(opts.routerPolicy).length ? stringList(opts.routerPolicy) : ['any']) : [null];
+  const poolSizes = sweep ? numberList(opts.instances, [1]) : [null];
+
+  printBanner();
+  section('Bench');
+  row('Prompts', `${prompts.length} ${DIM(opts.prompts || '(built-in)')}`);
+  row('Concurrency', concurrencies.join(', '));
+  row('Rate', rate ? `${rate} req/s` : DIM('unbounded (closed loop)'));
+  row('Per run', [Number.isFinite(durationMs) && `${durationMs / 1000}s`, Number.isFinite(requests) && `${requests} requests`]
+    .filter(Boolean).join(', max '));
+  if (sweep) row('Sweep', `policy ${policies.join(', ')} × instances ${poolSizes.join(', ')}`);
+  console.log();
+
+  const results = {
+    version: 1,
+    startedAt: new Date().toISOString(),
+    options: { concurrency: concurrencies, rate, requests: Number.isFinite(requests) ? requests : null, durationSec: Number.isFinite(durationMs) ? durationMs / 1000 : null, maxTokens, prompts: opts.prompts || null },
+    runs: [],
+  };
+
+  for (const routerPolicy of policies) {
+    for (const instances of poolSizes) {
+      let pool = null;
+      let ports;
+      if (sweep) {
+        try {
+          pool = await launchPool(config, instances, routerPolicy);
+        } catch (err) {
+          error(`${routerPolicy} × ${instances}: ${err.message}`);
+          results.runs.push({ routerPolicy, instances, error: err.message });
+          continue;
+        }
+        ports = pool.map(l => l.httpPort);
+      } else {
+        ports = [parseInt(opts.port || getHttpPort(), 10)];
+      }
+
+      try {
+        const models = stringList(opts.models).length ? stringList(opts.models) : await fetchModels(ports[0]);
+        if (models.length === 0) throw new Error('no models available');
+
+        for (const concurrency of concurrencies) {
+          const label = [routerPolicy && `policy ${routerPolicy}`, instances && `${instances} instance(s)`, `concurrency ${concurrency}`]
+            .filter(Boolean).join(' · ');
+          section(label);
+          const planned = Number.isFinite(requests) ? requests : null;
+          const { samples, wallMs } = await runLoad({
+            concurrency,
+            ratePerSec: rate,
+            requests,
+            durationMs,
+            // Every model on every port, with every prompt
+            send: (i) => {
+              const [p, m, q] = rotate(i, [ports.length, models.length, prompts.length]);
+              return sendCompletion(ports[p], models[m], prompts[q], maxTokens);
+            },
+            onSample: (s, done) => updateLine(`${s.ok ? GREEN('●') : RED('●')} ${done}${planned ? `/${planned}` : ''} requests`),
+          });
+          finishLine();
+
+          const summary = summarize(samples, wallMs);
+          const perModel = Object.fromEntries(models.map(m => [m, summarize(samples.filter(s => s.model === m), wallMs)]));
+          printSummary(summary);
+          if (models.length > 1) {
+            for (const [m, s] of Object.entries(perModel)) {
+              row(`  ${m}`, DIM(`${s.ok}/${s.requests} ok · TTFT p50 ${ms(s.ttftMs)} · e2e p95 ${ms(s.e2eMs, 'p95')}`));
+            }
+          }
+          console.log();
+          results.runs.push({ routerPolicy, instances, ports, concurrency, rate, models, summary, perModel });
+        }
+      } catch (err) {
+        error(err.message);
+        results.runs.push({ routerPolicy, instances, error: err.message });
+      } finally {
+        if (pool) await stopPool(pool);
+      }
+    }
+  }
+
+  let out = opts.output;
+  if (!out) {
+    if (!existsSync(BENCH_DIR)) mkdirSync(BENCH_DIR, { recursive: true, mode: 0o700 });
+    out = resolve(BENCH_DIR, `bench-${results.startedAt.replace(/[:.]/g, '-')}.json`);
+  }
+  writeFileSync(out, JSON.stringify(results, null, 2) + '\n');
+  separator();
+  success(`Results written to ${CYAN(out)}`);
+  console.log(DIM(`  ${results.runs.length} run(s)\n`));
+}
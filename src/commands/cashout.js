@@ -1,12 +1,10 @@
 import chalk from 'chalk';
 import { confirm } from '@inquirer/prompts';
 import { Address, toNano, fromNano } from '@ton/core';
-import { WalletContractV4 } from '@ton/ton';
-import { mnemonicToPrivateKey } from '@ton/crypto';
 import { readWalletJson } from '../lib/config.js';
 import { getCachedTonClient, withRetry, waitForSeqnoChange } from '../lib/ton.js';
 import { SC_RESERVE } from '../lib/constants.js';
-import { sendFromOwnerWallet } from '../contracts/index.js';
+import { sendFromOwnerWallet, openOwnerWallet } from '../contracts/index.js';
 import {
   printBanner, row, success, error, separator,
   DIM, CYAN, GREEN, YELLOW,
@@ -47,9 +45,7 @@ export async function cashoutCommand(amountArg, destination) {
   // 3. Open owner wallet (for balance check)
   const client = getCachedTonClient();
   const mnemonic = seedPhrase.split(' ');
-  const keys = await mnemonicToPrivateKey(mnemonic);
-  const ownerWallet = WalletContractV4.create({ workchain: 0, publicKey: keys.publicKey });
-  const contract = client.open(ownerWallet);
+  const { ownerWallet, contract } = await openOwnerWallet(client, mnemonic);
 
   const ownerAddr = ownerWallet.address.toString({ bounceable: false });
   let balance;
@@ -105,6 +101,7 @@ export async function cashoutCommand(amountArg, destination) {
     const confirmed = await waitForSeqnoChange(
       () => withRetry(() => contract.getSeqno()),
       seqno,
+      { address: ownerWallet.address },
     );
     if (confirmed) {
       const newBal = await withRetry(() => client.getBalance(ownerWallet.address));
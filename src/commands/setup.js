@@ -8,9 +8,7 @@ import {
 import { generateWallet } from '../lib/wallet.js';
 import { getBalance, waitForBalance, createTonClient, withRetry, waitForSeqnoChange } from '../lib/ton.js';
 import { toNano, fromNano, Address } from '@ton/core';
-import { WalletContractV4 } from '@ton/ton';
-import { mnemonicToPrivateKey } from '@ton/crypto';
-import { sendFromOwnerWallet } from '../contracts/index.js';
+import { sendFromOwnerWallet, openOwnerWallet } from '../contracts/index.js';
 import chalk from 'chalk';
 import {
   wizardFrame, successBox, noteBox, success, error, updateLine, finishLine,
@@ -226,15 +224,14 @@ export async function setupCommand() {
     steps[4].value = `${currentBalance.ton} TON`;
     console.log();
   } else {
-    // Poll for balance
+    // Wait for an incoming transaction that brings the balance over the minimum
     console.log(DIM(`  Current: ${currentBalance.ton} TON / 17.00 TON minimum\n`));
-    console.log(DIM('  Waiting for funds (polling every 5s, timeout 10 min)...'));
+    console.log(DIM('  Waiting for funds (checked on every incoming transaction, timeout 10 min)...'));
     console.log(DIM('  Press Ctrl+C to cancel.\n'));
 
     let latestBalance = currentBalance;
     const result = await waitForBalance(ownerAddr, MIN_BALANCE, {
       timeoutMs: 600_000,
-      intervalMs: 5_000,
       onUpdate: (bal) => {
         latestBalance = bal;
         updateLine(`Checking balance... ${CYAN(bal.ton)} / 17.00 TON`);
@@ -279,9 +276,7 @@ export async function setupCommand() {
     try {
       const client = createTonClient();
       const mnemonic = walletData.owner_wallet.seed_phrase.split(' ');
-      const keys = await mnemonicToPrivateKey(mnemonic);
-      const ownerWalletContract = WalletContractV4.create({ workchain: 0, publicKey: keys.publicKey });
-      const contract = client.open(ownerWalletContract);
+      const { ownerWallet: ownerWalletContract, contract } = await openOwnerWallet(client, mnemonic);
 
       const ownerBal = await withRetry(() => client.getBalance(ownerWalletContract.address));
       const transferAmount = ownerBal - toNano('0.5'); // keep 0.5 TON on owner
@@ -295,7 +290,7 @@ export async function setupCommand() {
         await waitForSeqnoChange(
           () => withRetry(() => contract.getSeqno()),
           seqno,
-          { iterations: 15, intervalMs: 2000 },
+          { address: ownerWalletContract.address, timeoutMs: 30_000 },
         );
       } else {
         console.log(YELLOW('  Owner wallet balance too low to fund cocoon wallet.'));
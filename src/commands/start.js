@@ -1,11 +1,20 @@
 import { readClientConf, getHttpPort } from '../lib/config.js';
-import { launchClient, waitForReady, isFullyReady } from '../lib/client.js';
+import { launchClient, isFullyReady } from '../lib/client.js';
+import { countReadyConnections, totalTokensPayed } from '../lib/connections.js';
 import {
   printBanner, row, section, success, error,
   updateLine, finishLine,
   BRAND, CYAN, DIM, GREEN, YELLOW,
 } from '../lib/ui.js';
 
+/** "launching 1.2s · synced 0.4s · …" (the final ready phase is omitted). */
+function formatPhases(phases) {
+  return phases
+    .filter(p => p.phase !== 'ready')
+    .map(p => `${p.phase} ${(p.ms / 1000).toFixed(1)}s`)
+    .join(' · ');
+}
+
 export async function startCommand(opts) {
   const config = readClientConf();
   if (!config) {
@@ -24,42 +33,49 @@ export async function startCommand(opts) {
   row('Owner',     BRAND(config.owner_address));
   console.log();
 
-  launchClient(config, {
+  const { warmStart, ready: readyPromise, phases } = launchClient(config, {
     routerPolicy: opts.routerPolicy || 'any',
     verbosity: opts.verbosity || '1',
-  });
-
-  success(`Client running. API: ${BRAND.bold(`http://localhost:${httpPort}`)}`);
-  console.log(DIM('  Connecting to proxy...\n'));
-
-  // Background poll for proxy readiness
-  const ready = await waitForReady(httpPort, {
+    persistState: opts.persistState,
+    coldStart: opts.coldStart,
     isReady: isFullyReady,
-    timeoutMs: 300_000,
-    intervalMs: 3_000,
-    onUpdate: (data) => {
+    onProbe: (data) => {
       if (!data) {
         updateLine(`${YELLOW('⟳')} starting...`);
         return;
       }
       const synced = data.status?.ton_last_synced_at != null ? GREEN('✔') : YELLOW('⟳');
-      const staked = data.proxies?.[0]?.tokens_payed > 0;
+      const staked = totalTokensPayed(data) > 0;
       const stake = staked ? GREEN('✔') : YELLOW('⟳');
-      const pc = data.proxy_connections?.[0];
-      const proxy = pc?.is_ready ? GREEN('✔') : YELLOW('⟳');
+      const total = data.proxy_connections?.length || 0;
+      const ready = countReadyConnections(data);
+      const proxy = ready > 0 ? GREEN('✔') : YELLOW('⟳');
+      const conns = total > 1 ? ` ${DIM(`${ready}/${total}`)}` : '';
 
-      if (pc?.is_ready && staked) {
-        updateLine(`${GREEN('✔')} sync  ${GREEN('✔')} staked  ${GREEN('✔')} proxy — connected!`);
+      if (ready > 0 && staked) {
+        updateLine(`${GREEN('✔')} sync  ${GREEN('✔')} staked  ${GREEN('✔')} proxy${conns} — connected!`);
       } else {
-        updateLine(`${synced} sync  ${stake} staked  ${proxy} proxy`);
+        updateLine(`${synced} sync  ${stake} staked  ${proxy} proxy${conns}`);
       }
     },
   });
+  if (opts.persistState || config.persist_state === 'true') {
+    row('State', warmStart ? GREEN('warm (reusing .cocoon-state)') : YELLOW('cold'));
+    console.log();
+  }
+
+  success(`Client running. API: ${BRAND.bold(`http://localhost:${httpPort}`)}`);
+  console.log(DIM('  Connecting to proxy...\n'));
+  updateLine(`${YELLOW('⟳')} starting...`);
+
+  // Resolves from the binary's lifecycle lines plus short /jsonstats probes
+  const ready = await readyPromise;
   finishLine();
   console.log();
 
   if (ready) {
     success('Proxy connected and ready.');
+    console.log(DIM(`  ${formatPhases(phases())}`));
   } else {
     console.log(YELLOW('  Proxy not ready yet. Client is still running.'));
   }
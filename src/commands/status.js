@@ -1,6 +1,8 @@
 import chalk from 'chalk';
-import { getHttpPort } from '../lib/config.js';
+import { getHttpPort, readWalletJson } from '../lib/config.js';
+import { getAccountStates } from '../lib/ton.js';
 import { formatTon } from '../lib/constants.js';
+import { summarizeConnections, totalTokensPayed } from '../lib/connections.js';
 import {
   printBanner, row, separator, handleClientError,
   DIM, CYAN, GREEN, RED,
@@ -11,10 +13,18 @@ const badge = (ok, y = 'yes', n = 'no') => ok ? GREEN(y) : RED(n);
 export async function statusCommand(opts) {
   const port = opts.port || String(getHttpPort());
 
+  // Owner wallet from the chain, in parallel with the client's own stats (one batched request)
+  const ownerAddr = readWalletJson()?.owner_wallet?.address;
+  const ownerState = ownerAddr
+    ? getAccountStates([ownerAddr]).then(([s]) => s, () => null)
+    : Promise.resolve(null);
+
   try {
     const res = await fetch(`http://localhost:${port}/jsonstats`);
     if (!res.ok) throw new Error(`HTTP ${res.status}: ${res.statusText}`);
-    const { status, wallet, proxy_connections = [], proxies = [], root_contract_config: rc } = await res.json();
+    const stats = await res.json();
+    const { status, wallet, proxies = [], root_contract_config: rc } = stats;
+    const connections = summarizeConnections(stats);
 
     printBanner();
     console.log();
@@ -24,20 +34,22 @@ export async function statusCommand(opts) {
     row('Enabled',    badge(status?.enabled));
     row('Address',    CYAN(wallet?.address || '?'));
     row('Balance',    `${chalk.bold(formatTon(wallet?.balance || 0))} TON`);
+    const owner = await ownerState;
+    if (owner) row('Owner',   `${chalk.bold(formatTon(Number(owner.balance)))} TON ${DIM(`seqno ${owner.seqno ?? '—'} · ${owner.status}`)}`);
 
     // Proxy
-    if (proxy_connections.length > 0) {
-      const pc = proxy_connections[0];
-      const addr = pc.address?.replace(/[\[\]]/g, '') || '?';
-      row('Proxy',    `${badge(pc.is_ready, 'ready', 'not ready')} ${DIM(addr)}`);
+    if (connections.length > 0) {
+      for (const conn of connections) {
+        const label = connections.length > 1 ? `Proxy ${conn.index + 1}` : 'Proxy';
+        row(label,    `${badge(conn.ready, 'ready', 'not ready')} ${DIM(conn.address || '?')}`);
+      }
     } else {
       row('Proxy',    RED('disconnected'));
     }
 
     // Staking
     if (proxies.length > 0) {
-      const p = proxies[0];
-      row('Escrow',   `${chalk.bold(formatTon(p.tokens_payed || 0))} TON ${DIM('(active top-up)')}`);
+      row('Escrow',   `${chalk.bold(formatTon(totalTokensPayed(stats)))} TON ${DIM('(active top-up)')}`);
     }
 
     // Network (one-line pricing)
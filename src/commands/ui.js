@@ -7,11 +7,13 @@ import { register as registerClient } from '../api/routes/client.js';
 import { register as registerProxy } from '../api/routes/proxy.js';
 import { register as registerWallet } from '../api/routes/wallet.js';
 import { register as registerToncenter } from '../api/routes/toncenter.js';
-import { setDefaultVerbosity } from '../services/client-state.js';
+import { setDefaultVerbosity, setDefaultPoolSize, setDefaultSupervision } from '../services/client-state.js';
 
 export async function uiCommand(options) {
   const port = parseInt(options.port, 10) || 3000;
   if (options.verbosity) setDefaultVerbosity(options.verbosity);
+  if (options.instances) setDefaultPoolSize(Math.max(1, parseInt(options.instances, 10) || 1));
+  setDefaultSupervision({ supervise: options.supervise === true, standby: options.standby === true });
 
   const { server, router, token } = createServer(port);
 
@@ -31,6 +33,7 @@ export async function uiCommand(options) {
   // Graceful shutdown
   const shutdown = () => {
     server.close();
+    keyCache.clear();
     process.exit(0);
   };
   process.on('SIGINT', shutdown);
@@ -1,111 +1,38 @@
 import chalk from 'chalk';
 import { confirm } from '@inquirer/prompts';
-import { Address, fromNano } from '@ton/core';
-import { getHttpPort, readWalletJson } from '../lib/config.js';
-import { getCachedTonClient, withRetry, waitForSeqnoChange } from '../lib/ton.js';
-import { SC_RESERVE, formatTon } from '../lib/constants.js';
-import { sendFromCocoonWallet } from '../contracts/index.js';
+import { getHttpPort } from '../lib/config.js';
+import { formatTon } from '../lib/constants.js';
+import { SC_STATE, unstakeableProxies } from '../lib/unstake-machine.js';
+import { startUnstake, getResumableRun, getUnstakeOwner } from '../services/unstake.js';
 import {
   printBanner, row, success, error, separator, handleClientError,
   DIM, CYAN, GREEN, RED, YELLOW,
 } from '../lib/ui.js';
 
-// Smart contract states from ClientProxyInfo
-const SC_STATE = { ACTIVE: 0, CLOSING: 1, CLOSED: 2 };
+const STEP_LABELS = {
+  close_sent: 'refund (close) request sent',
+  closed: 'contract closed',
+  withdraw_sent: 'proxy withdraw sent',
+  settled: 'settled',
+  sent: 'cocoon → owner transfer sent',
+  skipped: 'nothing left to transfer',
+  confirmed: 'transfer confirmed',
+};
 
 async function fetchStats(base) {
-  const res = await fetch(`${base}/jsonstats`);
+  const res = await fetch(`${base}/jsonstats`, { signal: AbortSignal.timeout(10_000) });
   if (!res.ok) throw new Error(`HTTP ${res.status}: ${res.statusText}`);
   return res.json();
 }
 
-async function sendRequest(base, action, proxyScAddress) {
-  const res = await fetch(`${base}/request/${action}?proxy=${encodeURIComponent(proxyScAddress)}`);
-  const body = await res.text();
-  const clean = body.replace(/<[^>]*>/g, '').trim();
-  const ok = clean.toLowerCase().includes('request sent');
-  return { ok, message: clean };
+function stateLabel(state) {
+  return state === SC_STATE.ACTIVE ? GREEN('active')
+    : state === SC_STATE.CLOSING ? YELLOW('closing')
+    : RED('closed');
 }
 
-async function pollState(base, proxyScAddress, targetState, { timeoutMs = 120_000, intervalMs = 3_000 } = {}) {
-  const deadline = Date.now() + timeoutMs;
-  while (Date.now() < deadline) {
-    try {
-      const stats = await fetchStats(base);
-      const proxy = stats.proxies?.find(p => p.proxy_sc_address === proxyScAddress);
-      if (!proxy) return { proxy_sc_address: proxyScAddress, state: SC_STATE.CLOSED, removed: true };
-      if (proxy.state >= targetState) return proxy;
-    } catch {
-      // transient error
-    }
-    await new Promise(r => setTimeout(r, intervalMs));
-  }
-  return null;
-}
-
-/** Transfer cocoon wallet → owner wallet. Returns true on success. */
-async function transferCocoonToOwner() {
-  const wallet = readWalletJson();
-  if (!wallet) {
-    error('No .wallet.json found.');
-    return false;
-  }
-
-  const cocoonAddrStr = wallet.node_wallet?.address;
-  const ownerAddrStr = wallet.owner_wallet?.address;
-  const nodeKeyBase64 = wallet.node_wallet?.private_key_base64;
-
-  if (!cocoonAddrStr || !ownerAddrStr || !nodeKeyBase64) {
-    error('Incomplete wallet config.');
-    return false;
-  }
-
-  const nodeSecret = Buffer.from(nodeKeyBase64, 'base64');
-  if (nodeSecret.length !== 32) {
-    error(`Invalid node key: expected 32 bytes, got ${nodeSecret.length}`);
-    return false;
-  }
-
-  const client = getCachedTonClient();
-  const cocoonAddr = Address.parse(cocoonAddrStr);
-  const ownerAddr = Address.parse(ownerAddrStr);
-
-  let cocoonBalance;
-  try {
-    cocoonBalance = await withRetry(() => client.getBalance(cocoonAddr));
-  } catch (err) {
-    error(`Failed to fetch cocoon balance: ${err.message}`);
-    return false;
-  }
-
-  const sendAmount = cocoonBalance - SC_RESERVE;
-  if (sendAmount <= 0n) {
-    console.log(YELLOW('  Cocoon wallet balance too low to transfer.'));
-    return false;
-  }
-
-  console.log(DIM(`  Cocoon balance: ${fromNano(cocoonBalance)} TON`));
-  console.log(DIM(`  Sending ${fromNano(sendAmount)} TON → owner wallet\n`));
-
-  try {
-    const { seqno } = await sendFromCocoonWallet(client, cocoonAddr, nodeSecret, ownerAddr, sendAmount);
-    success(`Sent ${fromNano(sendAmount)} TON → owner wallet`);
-
-    const confirmed = await waitForSeqnoChange(
-      () => withRetry(() => client.runMethod(cocoonAddr, 'seqno')).then(r => r.stack.readNumber()),
-      seqno,
-    );
-    if (confirmed) {
-      const ownerBal = await withRetry(() => client.getBalance(ownerAddr));
-      success(`Confirmed! Owner wallet balance: ${fromNano(ownerBal)} TON`);
-      return true;
-    }
-    console.log(YELLOW('  Timeout waiting for confirmation. Check tonviewer.com'));
-    return true; // TX was sent, just unconfirmed
-  } catch (err) {
-    error(`Transfer failed: ${err.message}`);
-    return false;
-  }
+function formatMs(ms) {
+  return ms < 1000 ? `${ms}ms` : `${(ms / 1000).toFixed(1)}s`;
 }
 
 export async function unstakeCommand(opts) {
@@ -115,155 +42,93 @@ export async function unstakeCommand(opts) {
   printBanner();
   console.log();
 
-  // 1. Fetch current state
-  let stats;
-  try {
-    stats = await fetchStats(base);
-  } catch (err) {
-    handleClientError(err, port);
-  }
-
-  // 2. Find proxy
-  const proxy = stats.proxies?.[0];
-  const proxyScAddress = proxy?.proxy_sc_address;
-
-  if (!proxyScAddress) {
-    error('No proxy found. The client may not be staked yet.');
-    console.log(DIM('  Run npx cocoon status to check.\n'));
-    process.exit(1);
-  }
-
-  const state = proxy.state ?? 0;
-  const escrow = proxy.tokens_payed || 0;
-
-  const cocoonBal = stats.wallet?.balance || 0;
-  row('Proxy',          CYAN(proxyScAddress));
-  row('Escrow',         `${chalk.bold(formatTon(escrow))} TON ${DIM('(active top-up on proxy)')}`);
-  row('Cocoon wallet',  `${chalk.bold(formatTon(cocoonBal))} TON ${DIM('(reserve)')}`);
-  row('State',          state === SC_STATE.ACTIVE ? GREEN('active')
-                      : state === SC_STATE.CLOSING ? YELLOW('closing')
-                      : RED('closed'));
-  console.log();
-
-  if (escrow <= 0 && state === SC_STATE.ACTIVE) {
-    console.log(YELLOW('  No active deposit to unstake.\n'));
+  // The API server (or another CLI) may be driving the run right now
+  const owner = getUnstakeOwner();
+  if (owner) {
+    console.log(YELLOW(`  An unstake is already in progress (pid ${owner}).`));
+    console.log(DIM('  Follow it in the WebUI or wait for it to finish.\n'));
     return;
   }
 
-  // 3. Handle based on current state
-  if (state === SC_STATE.ACTIVE) {
-    const proceed = await confirm({
-      message: `Unstake from proxy ${proxyScAddress.slice(0, 8)}…? This will close, withdraw, and send to owner wallet.`,
-      default: false,
-    });
-    if (!proceed) {
-      console.log(DIM('\n  Unstake cancelled.\n'));
-      return;
-    }
-
-    // Step 1/3: Close
+  // 1. An earlier run that did not finish is picked up where it stopped
+  const pending = getResumableRun();
+  let resume = false;
+  if (pending) {
+    console.log(YELLOW(`  Unfinished unstake from ${new Date(pending.startedAt).toLocaleString()}:`));
+    for (const p of pending.proxies) row('Proxy', `${CYAN(p.address)} ${DIM(p.step)}`);
+    row('Transfer', DIM(pending.transfer.step));
+    if (pending.error) row('Stopped at', RED(pending.error));
     console.log();
-    console.log(DIM('  Step 1/3 — Requesting refund (close)...\n'));
-
-    const closeResult = await sendRequest(base, 'close', proxyScAddress);
-    if (!closeResult.ok) {
-      error(`Close failed: ${closeResult.message}`);
-      return;
-    }
-    success('Refund request sent.');
-
-    console.log(DIM('  Waiting for contract to close (up to 2 min)...\n'));
-    const closed = await pollState(base, proxyScAddress, SC_STATE.CLOSED, {
-      timeoutMs: 120_000,
-      intervalMs: 3_000,
-    });
+    resume = await confirm({ message: 'Resume it?', default: true });
+  }
 
-    if (!closed) {
-      console.log(YELLOW('  Contract not yet closed. Run npx cocoon unstake again later.\n'));
-      return;
+  if (!resume) {
+    // 2. Fetch current state
+    let stats;
+    try {
+      stats = await fetchStats(base);
+    } catch (err) {
+      handleClientError(err, port);
     }
-    success('Contract closed.');
-    console.log();
 
-    // Step 2/3: Withdraw proxy → cocoon (skip if proxy already removed — refund was automatic)
-    if (closed.removed) {
-      success('Refund settled automatically (proxy removed).');
-    } else {
-      console.log(DIM('  Step 2/3 — Withdrawing from proxy to cocoon wallet...\n'));
-      const withdrawResult = await sendRequest(base, 'withdraw', proxyScAddress);
-      if (!withdrawResult.ok) {
-        // If proxy not found, refund already happened
-        if (withdrawResult.message.includes('proxy not found')) {
-          success('Refund already settled.');
-        } else {
-          error(`Withdraw failed: ${withdrawResult.message}`);
-          return;
-        }
-      } else {
-        success('Proxy withdraw sent.');
-      }
+    const proxies = unstakeableProxies(stats);
+    if (!(stats.proxies || []).length) {
+      error('No proxy found. The client may not be staked yet.');
+      console.log(DIM('  Run npx cocoon status to check.\n'));
+      process.exit(1);
     }
 
-  } else if (state === SC_STATE.CLOSING) {
-    console.log(YELLOW('  Contract is already closing. Waiting for it to complete...\n'));
-
-    const closed = await pollState(base, proxyScAddress, SC_STATE.CLOSED, {
-      timeoutMs: 120_000,
-      intervalMs: 3_000,
-    });
-
-    if (!closed) {
-      console.log(YELLOW('  Still not closed. Try again later: npx cocoon unstake\n'));
-      return;
+    for (const proxy of stats.proxies) {
+      row('Proxy',  CYAN(proxy.proxy_sc_address));
+      row('Escrow', `${chalk.bold(formatTon(proxy.tokens_payed || 0))} TON ${DIM('(active top-up on proxy)')}`);
+      row('State',  stateLabel(proxy.state ?? SC_STATE.ACTIVE));
     }
-    success('Contract closed.');
+    row('Cocoon wallet', `${chalk.bold(formatTon(stats.wallet?.balance || 0))} TON ${DIM('(reserve)')}`);
     console.log();
 
-    if (closed.removed) {
-      success('Refund settled automatically.');
-    } else {
-      console.log(DIM('  Step 2/3 — Withdrawing from proxy to cocoon wallet...\n'));
-      const withdrawResult = await sendRequest(base, 'withdraw', proxyScAddress);
-      if (!withdrawResult.ok && !withdrawResult.message.includes('proxy not found')) {
-        error(`Withdraw failed: ${withdrawResult.message}`);
-        return;
-      }
-      success(withdrawResult.ok ? 'Proxy withdraw sent.' : 'Refund already settled.');
+    if (proxies.length === 0) {
+      console.log(YELLOW('  No active deposit to unstake.\n'));
+      return;
     }
 
-  } else if (state === SC_STATE.CLOSED) {
     const proceed = await confirm({
-      message: 'Contract already closed. Withdraw remaining funds?',
-      default: true,
+      message: proxies.length === 1
+        ? `Unstake from proxy ${proxies[0].proxy_sc_address.slice(0, 8)}…? This will close, withdraw, and send to owner wallet.`
+        : `Unstake from ${proxies.length} proxies in parallel? This will close, withdraw, and send to owner wallet.`,
+      default: false,
     });
     if (!proceed) {
-      console.log(DIM('\n  Cancelled.\n'));
-      return;
-    }
-
-    console.log(DIM('\n  Step 2/3 — Withdrawing from proxy to cocoon wallet...\n'));
-    const withdrawResult = await sendRequest(base, 'withdraw', proxyScAddress);
-    if (!withdrawResult.ok && !withdrawResult.message.includes('proxy not found')) {
-      error(`Withdraw failed: ${withdrawResult.message}`);
+      console.log(DIM('\n  Unstake cancelled.\n'));
       return;
     }
-    success(withdrawResult.ok ? 'Proxy withdraw sent.' : 'Refund already settled.');
   }
 
-  // Step 3/3: Transfer cocoon wallet → owner wallet
+  // 3. Run the state machine; every step is saved, so Ctrl+C / a crash can resume
   console.log();
-  console.log(DIM('  Step 3/3 — Transferring cocoon wallet → owner wallet...\n'));
-
-  await new Promise(r => setTimeout(r, 5000));
-
-  const transferred = await transferCocoonToOwner();
+  let started;
+  try {
+    started = await startUnstake({
+      port,
+      resume,
+      onStep: ({ target, step, ms }) => {
+        const who = target === 'transfer' ? 'Transfer' : `${target.slice(0, 8)}…`;
+        success(`${who} — ${STEP_LABELS[step] ?? step} ${DIM(`(${formatMs(ms)})`)}`);
+      },
+    });
+  } catch (err) {
+    error(`Unstake failed: ${err.message}`);
+    return;
+  }
+  console.log(DIM('  Waiting on-chain (close → withdraw → transfer)...\n'));
+  const run = await started.done;
 
   console.log();
   separator();
-  if (transferred) {
-    console.log(DIM('  Unstake complete. Run npx cocoon status to verify.\n'));
+  if (run.status === 'done') {
+    const total = (run.completedAt ?? Date.now()) - run.startedAt;
+    console.log(DIM(`  Unstake complete in ${formatMs(total)}. Run npx cocoon status to verify.\n`));
   } else {
-    console.log(YELLOW('  Proxy withdraw done but cocoon→owner transfer failed.'));
-    console.log(DIM('  Run: npx cocoon withdraw\n'));
+    console.log(YELLOW(`  Unstake stopped: ${run.error}`));
+    console.log(DIM('  Progress is saved. Run npx cocoon unstake again to resume.\n'));
   }
 }
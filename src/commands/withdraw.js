@@ -93,10 +93,11 @@ export async function withdrawCommand(amountArg) {
     success(`Transaction sent (seqno: ${seqno}).`);
     console.log(DIM('  Waiting for confirmation...\n'));
 
-    // Poll for seqno change
+    // Wait for the seqno change (re-checked on each new wallet transaction)
     const confirmed = await waitForSeqnoChange(
       () => withRetry(() => client.runMethod(cocoonAddr, 'seqno')).then(r => r.stack.readNumber()),
       seqno,
+      { address: cocoonAddr },
     );
     if (confirmed) {
       const newBal = await withRetry(() => client.getBalance(cocoonAddr));
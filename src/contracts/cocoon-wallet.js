@@ -17,7 +17,7 @@ import { withRetry } from '../lib/ton.js';
 export async function sendFromCocoonWallet(client, cocoonAddr, nodeSecretKey, destination, amount, body) {
   const keyPair = keyPairFromSeed(nodeSecretKey);
 
-  const seqnoRes = await withRetry(() => client.runMethod(cocoonAddr, 'seqno'));
+  const seqnoRes = await withRetry(() => client.runMethod(cocoonAddr, 'seqno'), 5, { priority: 'user' });
   const seqno = seqnoRes.stack.readNumber();
 
   const validUntil = Math.floor(Date.now() / 1000) + 3600;
@@ -52,7 +52,7 @@ export async function sendFromCocoonWallet(client, cocoonAddr, nodeSecretKey, de
   await withRetry(() => client.sendExternalMessage(
     { address: cocoonAddr },
     signedMsg,
-  ));
+  ), 5, { priority: 'user' });
 
   return { seqno };
 }
@@ -1,3 +1,3 @@
 export { sendFromCocoonWallet } from './cocoon-wallet.js';
-export { sendFromOwnerWallet } from './owner-wallet.js';
+export { sendFromOwnerWallet, openOwnerWallet } from './owner-wallet.js';
 export * from './opcodes.js';
@@ -1,7 +1,36 @@
 import { internal } from '@ton/core';
-import { mnemonicToPrivateKey } from '@ton/crypto';
 import { WalletContractV4 } from '@ton/ton';
 import { withRetry } from '../lib/ton.js';
+import { getMnemonicKeys } from '../lib/key-cache.js';
+
+// client → (publicKey hex → opened contract); contracts live as long as their client
+const openedContracts = new WeakMap();
+
+/**
+ * Owner wallet (WalletContractV4) for a mnemonic, opened on `client`.
+ * Keys come from the process key cache and the contract is reused, so
+ * repeated transactions skip both the KDF and the rebuild.
+ *
+ * @param {TonClient} client
+ * @param {string[]} mnemonic - 24-word array
+ * @returns {Promise<{ keys, ownerWallet, contract }>}
+ */
+export async function openOwnerWallet(client, mnemonic) {
+  const keys = await getMnemonicKeys(mnemonic);
+  let byKey = openedContracts.get(client);
+  if (!byKey) {
+    byKey = new Map();
+    openedContracts.set(client, byKey);
+  }
+  const id = keys.publicKey.toString('hex');
+  let opened = byKey.get(id);
+  if (!opened) {
+    const ownerWallet = WalletContractV4.create({ workchain: 0, publicKey: keys.publicKey });
+    opened = { ownerWallet, contract: client.open(ownerWallet) };
+    byKey.set(id, opened);
+  }
+  return { keys, ...opened };
+}
 
 /**
  * Open an owner wallet (WalletContractV4) from mnemonic, send a transfer.
@@ -14,11 +43,9 @@ import { withRetry } from '../lib/ton.js';
  * @returns {Promise<{ seqno: number, contract, ownerWallet }>}
  */
 export async function sendFromOwnerWallet(client, mnemonic, destination, amount, body) {
-  const keys = await mnemonicToPrivateKey(mnemonic);
-  const ownerWallet = WalletContractV4.create({ workchain: 0, publicKey: keys.publicKey });
-  const contract = client.open(ownerWallet);
+  const { keys, ownerWallet, contract } = await openOwnerWallet(client, mnemonic);
 
-  const seqno = await withRetry(() => contract.getSeqno());
+  const seqno = await withRetry(() => contract.getSeqno(), 5, { priority: 'user' });
   await withRetry(() => contract.sendTransfer({
     seqno,
     secretKey: keys.secretKey,
@@ -28,7 +55,7 @@ export async function sendFromOwnerWallet(client, mnemonic, destination, amount,
       bounce: !!body,
       ...(body ? { body } : {}),
     })],
-  }));
+  }), 5, { priority: 'user' });
 
   return { seqno, contract, ownerWallet };
 }
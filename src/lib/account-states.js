@@ -0,0 +1,128 @@
+/**
+ * Batched, briefly cached account-state lookups.
+ *
+ * Every address requested within one event-loop turn goes out in a
+ * single `fetchMany` call (Toncenter v3 walletStates: balance, seqno and
+ * status for many addresses per round trip). Results are cached for
+ * `ttlMs`; a caller that needs a fresh read passes `maxAgeMs: 0`.
+ * Addresses already in a batch in flight join it instead of being
+ * fetched again.
+ *
+ * The chain access is injected (see getAccountStates() in ton.js).
+ */
+
+/**
+ * @typedef {object} AccountState
+ * @property {string} address - as requested
+ * @property {bigint} balance - nanoTON
+ * @property {number | null} seqno - null for non-wallet contracts
+ * @property {string} status - 'active' | 'uninit' | 'frozen' | 'nonexist'
+ * @property {string | null} lastTransactionLt
+ */
+
+/**
+ * @param {object} opts
+ * @param {(addresses: string[]) => Promise<Map<string, AccountState>>} opts.fetchMany -
+ *   keyed by normalized address; addresses missing from the map do not exist yet
+ * @param {(address: string) => string} [opts.normalize] - canonical form of an address, used as the cache key
+ * @param {number} [opts.ttlMs=5000]
+ * @param {number} [opts.maxBatch=100] - addresses per fetchMany call
+ * @param {() => number} [opts.now=Date.now]
+ */
+export function createAccountStates(opts) {
+  const { fetchMany, normalize = (a) => a, ttlMs = 5000, maxBatch = 100, now = Date.now } = opts;
+  const cache = new Map();     // key → { state, ts }
+  const inflight = new Map();  // key → { promise, resolve, reject, started }
+  let queued = [];             // inflight entries waiting for the next batch
+  let scheduled = false;
+  // Bumped by invalidate(); a batch that started before must not cache its result
+  let epoch = 0;
+  const invalidatedAt = new Map();  // key → epoch
+  const counts = { batches: 0, addressesFetched: 0, hits: 0, joined: 0 };
+
+  function nonexistent(key) {
+    return { address: key, balance: 0n, seqno: null, status: 'nonexist', lastTransactionLt: null };
+  }
+
+  async function runBatch(entries) {
+    const startedAt = epoch;
+    for (const e of entries) e.started = true;
+    counts.batches++;
+    counts.addressesFetched += entries.length;
+    try {
+      const states = await fetchMany(entries.map(e => e.key));
+      const ts = now();
+      for (const e of entries) {
+        const state = states.get(e.key) ?? nonexistent(e.key);
+        if ((invalidatedAt.get(e.key) ?? -1) <= startedAt) cache.set(e.key, { state, ts });
+        e.resolve(state);
+      }
+    } catch (err) {
+      for (const e of entries) e.reject(err);
+    } finally {
+      for (const e of entries) {
+        if (inflight.get(e.key) === e) inflight.delete(e.key);
+      }
+    }
+  }
+
+  function flush() {
+    scheduled = false;
+    const all = queued;
+    queued = [];
+    for (let i = 0; i < all.length; i += maxBatch) runBatch(all.slice(i, i + maxBatch));
+  }
+
+  function one(key, maxAgeMs) {
+    const cached = cache.get(key);
+    if (cached && now() - cached.ts <= maxAgeMs) {
+      counts.hits++;
+      return Promise.resolve(cached.state);
+    }
+    const pending = inflight.get(key);
+    if (pending) {
+      counts.joined++;
+      return pending.promise;
+    }
+    const entry = { key, started: false };
+    entry.promise = new Promise((resolve, reject) => Object.assign(entry, { resolve, reject }));
+    inflight.set(key, entry);
+    queued.push(entry);
+    if (!scheduled) {
+      scheduled = true;
+      setImmediate(flush);
+    }
+    return entry.promise;
+  }
+
+  /**
+   * States of `addresses`, in order; each result's `address` is the one
+   * passed in.
+   * @param {string[]} addresses
+   * @param {object} [o]
+   * @param {number} [o.maxAgeMs=ttlMs] - oldest cached state acceptable
+   * @returns {Promise<AccountState[]>}
+   */
+  async function get(addresses, { maxAgeMs = ttlMs } = {}) {
+    const states = await Promise.all(addresses.map(a => one(normalize(a), maxAgeMs)));
+    return states.map((state, i) => ({ ...state, address: addresses[i] }));
+  }
+
+  /** Forget cached states (after sending from or to these addresses). */
+  function invalidate(addresses) {
+    epoch++;
+    for (const a of addresses) {
+      const key = normalize(a);
+      cache.delete(key);
+      invalidatedAt.set(key, epoch);
+      // A batch already on the wire may predate the change: later callers fetch again
+      if (inflight.get(key)?.started) inflight.delete(key);
+    }
+  }
+
+  function stats() {
+    return { ...counts, entries: cache.size, inflight: inflight.size };
+  }
+
+  return { get, invalidate, stats };
+}
@@ -0,0 +1,180 @@
+/**
+ * Admission control in front of the client-runner.
+ *
+ * - A request is admitted when `tryAcquire()` hands out a slot (an
+ *   instance lease below its in-flight limit); otherwise it waits.
+ * - Waiters are served by priority: 'interactive' (WebUI chat) before
+ *   'batch' (API callers), FIFO within each.
+ * - Nobody waits longer than `budgetMs`: a request whose estimated wait
+ *   (queue position × average slot hold time / capacity) is over budget
+ *   is rejected up front, and one still queued at the deadline is
+ *   rejected then. Rejections carry `statusCode` 429 and `retryAfterMs`.
+ */
+
+export const PRIORITIES = ['interactive', 'batch'];
+
+// Weight of the newest sample in the slot-hold average
+const HOLD_EWMA_ALPHA = 0.2;
+
+function rejection(message, retryAfterMs, reason) {
+  const err = new Error(message);
+  err.statusCode = 429;
+  err.retryAfterMs = Math.max(1000, Math.round(retryAfterMs));
+  err.reason = reason;
+  return err;
+}
+
+function aborted() {
+  const err = new Error('Request aborted while queued');
+  err.reason = 'aborted';
+  return err;
+}
+
+/**
+ * @param {object} opts
+ * @param {(hint?: any) => { release: () => void } | null} opts.tryAcquire - a slot, or null when all are busy;
+ *   gets the waiter's `hint` (routing preference)
+ * @param {() => number} [opts.capacity] - total slots, for wait estimates
+ * @param {number} [opts.budgetMs=30000] - longest time a request may queue
+ * @param {number} [opts.maxQueue=256] - waiters across all priorities
+ * @param {(priority: string, waitMs: number) => void} [opts.onAdmit]
+ * @param {(priority: string, reason: string) => void} [opts.onReject]
+ * @param {() => number} [opts.now=Date.now]
+ */
+export function createAdmission(opts) {
+  const { tryAcquire, capacity = () => 1, onAdmit, onReject, now = Date.now } = opts;
+  let budgetMs = opts.budgetMs ?? 30_000;
+  let maxQueue = opts.maxQueue ?? 256;
+  const queues = Object.fromEntries(PRIORITIES.map(p => [p, []]));
+  const counts = { admitted: 0, queued: 0, rejected: 0 };
+  let avgHoldMs = 0;
+
+  function depth(priority) {
+    if (priority) return queues[priority].length;
+    return PRIORITIES.reduce((n, p) => n + queues[p].length, 0);
+  }
+
+  /** Waiters that would be served before a new request of this priority. */
+  function ahead(priority) {
+    let n = 0;
+    for (const p of PRIORITIES) {
+      n += queues[p].length;
+      if (p === priority) break;
+    }
+    return n;
+  }
+
+  /** 0 until a slot has been held once (no basis for a guess yet). */
+  function estimateWaitMs(position) {
+    return ((position + 1) / Math.max(1, capacity())) * avgHoldMs;
+  }
+
+  function wrap(lease) {
+    const heldFrom = now();
+    let released = false;
+    return {
+      ...lease,
+      release: () => {
+        if (released) return;
+        released = true;
+        lease.release();
+        const held = now() - heldFrom;
+        avgHoldMs = avgHoldMs ? avgHoldMs + HOLD_EWMA_ALPHA * (held - avgHoldMs) : held;
+        pump();
+      },
+    };
+  }
+
+  function admit(priority, waitMs, lease) {
+    counts.admitted++;
+    onAdmit?.(priority, waitMs);
+    return wrap(lease);
+  }
+
+  function reject(priority, err) {
+    counts.rejected++;
+    onReject?.(priority, err.reason);
+    return err;
+  }
+
+  function remove(waiter) {
+    const q = queues[waiter.priority];
+    const i = q.indexOf(waiter);
+    if (i !== -1) q.splice(i, 1);
+    clearTimeout(waiter.timer);
+    waiter.signal?.removeEventListener('abort', waiter.onAbort);
+  }
+
+  /** Hand free slots to waiters; call when capacity may have grown. */
+  function pump() {
+    for (const p of PRIORITIES) {
+      const q = queues[p];
+      while (q.length) {
+        const waiter = q[0];
+        const lease = tryAcquire(waiter.hint);
+        if (!lease) return;
+        remove(waiter);
+        waiter.resolve(admit(p, now() - waiter.enqueuedAt, lease));
+      }
+    }
+  }
+
+  /**
+   * Wait for a slot.
+   * @param {string} [priority='batch']
+   * @param {{ signal?: AbortSignal, hint?: any }} [options] - abort `signal` to leave
+   *   the queue; `hint` is passed to tryAcquire
+   * @returns {Promise<{ release: () => void }>} the lease, with `release` also admitting the next waiter
+   */
+  function acquire(priority = 'batch', { signal, hint } = {}) {
+    if (!queues[priority]) priority = 'batch';
+    if (signal?.aborted) return Promise.reject(aborted());
+    const position = ahead(priority);
+    if (position === 0) {
+      const lease = tryAcquire(hint);
+      if (lease) return Promise.resolve(admit(priority, 0, lease));
+    }
+    if (depth() >= maxQueue) {
+      return Promise.reject(reject(priority, rejection('Too many queued requests', estimateWaitMs(position), 'queue_full')));
+    }
+    const estimate = estimateWaitMs(position);
+    if (estimate > budgetMs) {
+      return Promise.reject(reject(priority, rejection('Client busy, estimated wait exceeds queue budget', estimate, 'budget')));
+    }
+
+    return new Promise((resolve, rejectPromise) => {
+      const waiter = { priority, hint, enqueuedAt: now(), resolve, signal, timer: null, onAbort: null };
+      waiter.timer = setTimeout(() => {
+        remove(waiter);
+        rejectPromise(reject(priority, rejection('Client busy, queue budget exceeded', estimateWaitMs(ahead(priority)), 'timeout')));
+      }, budgetMs);
+      if (signal) {
+        waiter.onAbort = () => {
+          remove(waiter);
+          rejectPromise(aborted());
+        };
+        signal.addEventListener('abort', waiter.onAbort, { once: true });
+      }
+      queues[priority].push(waiter);
+      counts.queued++;
+    });
+  }
+
+  /** Change the limits in place (waiters keep their deadlines). */
+  function configure(next = {}) {
+    if (next.budgetMs > 0) budgetMs = next.budgetMs;
+    if (next.maxQueue > 0) maxQueue = next.maxQueue;
+  }
+
+  function stats() {
+    return {
+      ...counts,
+      depth: Object.fromEntries(PRIORITIES.map(p => [p, queues[p].length])),
+      avgHoldMs: Math.round(avgHoldMs),
+      budgetMs,
+      maxQueue,
+    };
+  }
+
+  return { acquire, pump, configure, depth, stats };
+}
@@ -0,0 +1,214 @@
+/**
+ * Load generation and latency statistics for `cocoon bench`.
+ *
+ * runLoad() keeps `concurrency` requests in flight (closed loop) and, with
+ * `ratePerSec`, also paces request starts to that rate (open loop, still
+ * capped by concurrency). Requests go through an injected `send`, so the
+ * driver runs the same against the client-runner or a fake server.
+ *
+ * Streamed events stand in for tokens, as in the proxy metrics: the
+ * runner sends one delta per event.
+ */
+
+import { performance } from 'perf_hooks';
+
+/** Nearest-rank percentile of an ascending array (null when empty). */
+export function percentile(sorted, p) {
+  if (sorted.length === 0) return null;
+  const i = Math.min(sorted.length - 1, Math.max(0, Math.ceil((p / 100) * sorted.length) - 1));
+  return sorted[i];
+}
+
+/** { mean, p50, p95, p99, max } of a list of numbers, rounded to 0.1. */
+export function distribution(values) {
+  const sorted = values.filter(v => v != null).sort((a, b) => a - b);
+  if (sorted.length === 0) return null;
+  const round = (v) => Math.round(v * 10) / 10;
+  return {
+    mean: round(sorted.reduce((s, v) => s + v, 0) / sorted.length),
+    p50: round(percentile(sorted, 50)),
+    p95: round(percentile(sorted, 95)),
+    p99: round(percentile(sorted, 99)),
+    max: round(sorted[sorted.length - 1]),
+  };
+}
+
+/**
+ * Indices into several lists for request `i`, rotated like nested loops
+ * (the first list fastest), so every combination comes up equally often:
+ * with 2 ports and 2 models, each model goes to both ports. Rotating all
+ * lists by `i` alone would pin model A to port 0 when the sizes match.
+ * @param {number} i
+ * @param {number[]} sizes
+ * @returns {number[]}
+ */
+export function rotate(i, sizes) {
+  let rest = i;
+  return sizes.map((n) => {
+    const index = rest % n;
+    rest = Math.floor(rest / n);
+    return index;
+  });
+}
+
+/**
+ * Read a streamed (or plain JSON) completion response to the end.
+ * @param {Response} res - fetch response
+ * @param {number} startedAt - performance.now() when the request was sent
+ * @returns {Promise<{ ttftMs: number | null, itlMs: number[], tokens: number, e2eMs: number }>}
+ *   itlMs holds one gap per streamed event after the first
+ */
+export async function readCompletion(res, startedAt, now = () => performance.now()) {
+  const decoder = new TextDecoder();
+  const itlMs = [];
+  let buffered = '';
+  let first = null;
+  let last = null;
+  let events = 0;
+  let usageTokens = null;
+  let plain = '';
+
+  for await (const chunk of res.body) {
+    const text = decoder.decode(chunk, { stream: true });
+    const lines = (buffered + text).split('\n');
+    buffered = lines.pop();
+    let n = 0;
+    for (const line of lines) {
+      if (!line.startsWith('data: ')) {
+        if (!events) plain += line;
+        continue;
+      }
+      if (line === 'data: [DONE]') continue;
+      n++;
+      if (line.includes('"usage"')) {
+        try { usageTokens = JSON.parse(line.slice(6)).usage?.completion_tokens ?? usageTokens; } catch {}
+      }
+    }
+    if (n === 0) continue;
+    // One gap per event: events that arrived in the same chunk are 0 ms apart
+    const t = now();
+    if (first === null) first = t;
+    else itlMs.push(t - last);
+    for (let k = 1; k < n; k++) itlMs.push(0);
+    last = t;
+    events += n;
+  }
+  const end = now();
+  if (events === 0) {
+    // Non-streamed response: one JSON body
+    try {
+      usageTokens = JSON.parse(plain + buffered).usage?.completion_tokens ?? null;
+    } catch {}
+    return { ttftMs: null, itlMs, tokens: usageTokens ?? 0, e2eMs: end - startedAt };
+  }
+  return { ttftMs: first - startedAt, itlMs, tokens: usageTokens ?? events, e2eMs: end - startedAt };
+}
+
+/**
+ * Drive requests.
+ *
+ * @param {object} opts
+ * @param {(i: number) => Promise<object>} opts.send - one request; resolves with a sample
+ *   ({ ok, status, ttftMs?, itlMs?, tokens?, e2eMs, model?, error? }), never rejects
+ * @param {number} [opts.concurrency=1]
+ * @param {number} [opts.ratePerSec=0] - 0: as fast as concurrency allows
+ * @param {number} [opts.requests] - stop after this many (default: unbounded, use durationMs)
+ * @param {number} [opts.durationMs] - stop starting requests after this long
+ * @param {(sample: object, done: number) => void} [opts.onSample]
+ * @returns {Promise<{ samples: object[], wallMs: number }>}
+ */
+export async function runLoad(opts) {
+  const { send, concurrency = 1, ratePerSec = 0, requests = Infinity, durationMs = Infinity, onSample } = opts;
+  if (!Number.isFinite(requests) && !Number.isFinite(durationMs)) throw new Error('runLoad needs requests or durationMs');
+  const samples = [];
+  const startedAt = performance.now();
+  let next = 0;
+
+  const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+
+  async function worker() {
+    while (true) {
+      const i = next++;
+      if (i >= requests) return;
+      if (ratePerSec > 0) {
+        const due = startedAt + (i / ratePerSec) * 1000;
+        const wait = due - performance.now();
+        if (wait > 0) await sleep(wait);
+      }
+      if (performance.now() - startedAt >= durationMs) return;
+      const sample = await send(i);
+      samples.push(sample);
+      onSample?.(sample, samples.length);
+    }
+  }
+
+  await Promise.all(Array.from({ length: Math.max(1, concurrency) }, worker));
+  return { samples, wallMs: performance.now() - startedAt };
+}
+
+/**
+ * Aggregate samples of one run.
+ * Latencies in ms; tokensPerSec is the per-request decode rate
+ * (events after the first / streaming time), throughput is over the run.
+ */
+export function summarize(samples, wallMs) {
+  const ok = samples.filter(s => s.ok);
+  const byStatus = {};
+  for (const s of samples) {
+    const key = String(s.status ?? 'error');
+    byStatus[key] = (byStatus[key] ?? 0) + 1;
+  }
+  const total = samples.length;
+  const rate = (n) => (total ? Math.round((n / total) * 1000) / 1000 : 0);
+  const tokens = ok.reduce((n, s) => n + (s.tokens ?? 0), 0);
+  const wallSec = wallMs / 1000;
+  // itlMs has one gap per event after the first, so its sum is the streaming time
+  const decodeRates = ok
+    .filter(s => s.itlMs?.length)
+    .map(s => s.itlMs.length / (s.itlMs.reduce((a, b) => a + b, 0) / 1000));
+  return {
+    requests: total,
+    ok: ok.length,
+    errors: total - ok.length,
+    errorRate: rate(total - ok.length),
+    rate503: rate(byStatus['503'] ?? 0),
+    rate504: rate(byStatus['504'] ?? 0),
+    byStatus,
+    wallSec: Math.round(wallSec * 100) / 100,
+    requestsPerSec: wallSec ? Math.round((ok.length / wallSec) * 100) / 100 : 0,
+    tokensPerSec: wallSec ? Math.round((tokens / wallSec) * 10) / 10 : 0,
+    ttftMs: distribution(ok.map(s => s.ttftMs)),
+    itlMs: distribution(ok.flatMap(s => s.itlMs ?? [])),
+    e2eMs: distribution(ok.map(s => s.e2eMs)),
+    decodeTokensPerSec: distribution(decodeRates.filter(Number.isFinite)),
+  };
+}
+
+/**
+ * Compare two machine-readable results ({ metrics: { [name]: { value,
+ * better: 'higher' | 'lower', tolerance?, minDelta? } } }).
+ *
+ * A metric regresses when it moved the wrong way by more than its
+ * relative `tolerance` (default `opts.tolerance`) and by more than its
+ * absolute `minDelta`. Metrics missing from the baseline are reported
+ * but never regress.
+ * @returns {{ rows: object[], regressions: object[] }}
+ */
+export function compareResults(baseline, current, { tolerance = 0.15 } = {}) {
+  const rows = [];
+  for (const [name, metric] of Object.entries(current.metrics ?? {})) {
+    const base = baseline.metrics?.[name];
+    if (base?.value == null || metric.value == null) {
+      rows.push({ name, baseline: base?.value ?? null, current: metric.value, change: null, regressed: false });
+      continue;
+    }
+    const delta = metric.value - base.value;
+    const change = base.value === 0 ? (delta === 0 ? 0 : Math.sign(delta) * Infinity) : delta / Math.abs(base.value);
+    const worse = metric.better === 'lower' ? delta : -delta;
+    const regressed = worse > 0
+      && Math.abs(change) > (metric.tolerance ?? tolerance)
+      && Math.abs(delta) > (metric.minDelta ?? 0);
+    rows.push({ name, baseline: base.value, current: metric.value, change, regressed });
+  }
+  return { rows, regressions: rows.filter(r => r.regressed) };
+}
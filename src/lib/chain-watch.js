@@ -0,0 +1,168 @@
+/**
+ * Shared on-chain change subscription.
+ *
+ * Waiters used to sleep-poll their own state every 3–5s. Instead, one loop
+ * follows the masterchain seqno and only when a new block appears reads
+ * the last transaction lt of each watched address; a changed lt wakes
+ * that address's waiters. The loop is block-aligned: the next masterchain
+ * poll is timed from the moving average of observed block intervals, and
+ * it stops entirely while nobody is watching.
+ *
+ * The chain access is injected (see getChainWatch() in ton.js).
+ */
+
+export const BLOCK_INTERVAL_MS = 5_000;
+const MIN_POLL_MS = 500;
+const MAX_POLL_MS = 15_000;
+const BLOCK_MARGIN_MS = 300;    // poll slightly after the expected block
+
+/**
+ * @param {object} opts
+ * @param {() => Promise<number>} opts.getMasterchainSeqno
+ * @param {(address: string) => Promise<{ lt: string | null, balance: bigint }>} opts.getAccountState
+ * @param {number} [opts.blockIntervalMs=BLOCK_INTERVAL_MS] - initial estimate
+ * @param {(err: Error) => void} [opts.onError]
+ */
+export function createChainWatch(opts) {
+  const { getMasterchainSeqno, getAccountState, onError } = opts;
+  let blockMs = opts.blockIntervalMs ?? BLOCK_INTERVAL_MS;
+  const watched = new Map();   // address → { state, listeners: Set }
+  let seqno = null;
+  let blockAt = 0;
+  let timer = null;
+  let polling = false;
+  const counts = { blocks: 0, masterchainPolls: 0, accountPolls: 0 };
+
+  function schedule(delayMs) {
+    clearTimeout(timer);
+    timer = watched.size ? setTimeout(tick, Math.min(MAX_POLL_MS, Math.max(MIN_POLL_MS, delayMs))) : null;
+  }
+
+  async function refresh(address, entry) {
+    counts.accountPolls++;
+    const state = await getAccountState(address);
+    const changed = entry.state !== null && state.lt !== entry.state.lt;
+    entry.state = state;
+    if (changed) {
+      for (const fn of [...entry.listeners]) {
+        try { fn(state); } catch {}
+      }
+    }
+  }
+
+  async function tick() {
+    if (polling) return;
+    polling = true;
+    try {
+      counts.masterchainPolls++;
+      const latest = await getMasterchainSeqno();
+      const now = Date.now();
+      if (seqno === null || latest > seqno) {
+        if (seqno !== null && blockAt) {
+          const observed = (now - blockAt) / (latest - seqno);
+          blockMs = Math.round(blockMs * 0.8 + observed * 0.2);
+          counts.blocks += latest - seqno;
+        }
+        seqno = latest;
+        blockAt = now;
+        await Promise.all([...watched].map(([address, entry]) => refresh(address, entry).catch(err => onError?.(err))));
+        schedule(blockMs + BLOCK_MARGIN_MS);
+      } else {
+        // Block is late: check again soon rather than a whole interval later
+        schedule(Math.max(MIN_POLL_MS, blockMs / 4));
+      }
+    } catch (err) {
+      onError?.(err);
+      schedule(blockMs);
+    } finally {
+      polling = false;
+    }
+  }
+
+  /**
+   * Call `fn(state)` whenever `address` gets a new transaction.
+   * @returns {() => void} unsubscribe
+   */
+  function subscribe(address, fn) {
+    let entry = watched.get(address);
+    if (!entry) {
+      entry = { state: null, listeners: new Set() };
+      watched.set(address, entry);
+      // Baseline lt, so the first change is detected against it
+      refresh(address, entry).catch(err => onError?.(err));
+    }
+    entry.listeners.add(fn);
+    if (!timer && !polling) schedule(0);
+    return () => {
+      entry.listeners.delete(fn);
+      if (entry.listeners.size === 0 && watched.get(address) === entry) watched.delete(address);
+      if (watched.size === 0) schedule(0);
+    };
+  }
+
+  return {
+    subscribe,
+
+    /**
+     * Resolve with the first truthy result of `check`. It runs once right
+     * away, then after every transaction on `address`, and every
+     * `fallbackMs` in case the state it reads lags the chain.
+     * @template T
+     * @param {string} address
+     * @param {(state: object | null) => Promise<T> | T} check
+     * @param {object} [opts]
+     * @param {number} [opts.timeoutMs=120000]
+     * @param {number} [opts.fallbackMs=30000]
+     * @param {AbortSignal} [opts.signal]
+     * @returns {Promise<T | null>} null on timeout / abort
+     */
+    waitFor(address, check, { timeoutMs = 120_000, fallbackMs = 30_000, signal } = {}) {
+      return new Promise((resolve) => {
+        let done = false;
+        let running = false;
+        let again = false;
+        let lastState = null;
+
+        const finish = (value) => {
+          if (done) return;
+          done = true;
+          unsubscribe();
+          clearTimeout(deadline);
+          clearInterval(fallback);
+          signal?.removeEventListener('abort', onAbort);
+          resolve(value);
+        };
+        const run = async () => {
+          if (done) return;
+          if (running) { again = true; return; }
+          running = true;
+          try {
+            const result = await check(lastState);
+            if (result) finish(result);
+          } catch {
+            // transient, the next change / fallback retries
+          }
+          running = false;
+          if (again) { again = false; run(); }
+        };
+        const onAbort = () => finish(null);
+
+        const unsubscribe = subscribe(address, (state) => { lastState = state; run(); });
+        const deadline = setTimeout(() => finish(null), timeoutMs);
+        const fallback = setInterval(run, fallbackMs);
+        signal?.addEventListener('abort', onAbort);
+        run();
+      });
+    },
+
+    /** Stop polling and drop every subscription. */
+    close() {
+      watched.clear();
+      schedule(0);
+    },
+
+    stats() {
+      return { ...counts, watched: watched.size, blockIntervalMs: blockMs, seqno };
+    },
+  };
+}
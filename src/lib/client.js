@@ -7,6 +7,11 @@ import {
 } from './config.js';
 import { spawnWithPrefix, setupSignalHandlers } from './process.js';
 import { RED } from './ui.js';
+import { isFullyReady } from './connections.js';
+import { openStateDir, stateFingerprint } from './state-dir.js';
+import { createReadiness, probeJsonStats } from './readiness.js';
+
+export { isFullyReady };
 
 /**
  * Render a JSON template by replacing $VAR placeholders with runtime vars
@@ -27,15 +32,28 @@ function renderTemplate(templatePath, vars) {
  * @param {string} [opts.routerPolicy='any']
  * @param {string} [opts.verbosity='1']
  * @param {boolean} [opts.quiet=true]
+ * @param {boolean} [opts.persistState] - reuse .cocoon-state/instance-N (default: client.conf persist_state)
+ * @param {boolean} [opts.coldStart=false] - wipe the persistent state first
  * @param {(event: string, data: any) => void} [opts.onEvent]
- * @returns {{ cleanup: () => void, runDir: string, httpPort: number }}
+ * @param {(stats: object) => boolean} [opts.isReady] - readiness criterion (default: isFullyReady)
+ * @param {(stats: object | null) => void} [opts.onProbe] - every readiness probe result
+ * @returns {{
+ *   cleanup: () => void, kill: () => Promise<void>, runDir: string, httpPort: number, warmStart: boolean,
+ *   ready: Promise<object | null>, phases: () => Array<{ phase: string, at: number, ms: number }>,
+ * }}
+ *   ready resolves with the first /jsonstats that passes isReady, or null
+ *   on exit / timeout / kill; phases is the startup timeline (see readiness.js)
  */
 export function launchClient(config, opts = {}) {
   const {
     routerPolicy = 'any',
     verbosity = '1',
     quiet = true,
+    persistState = config.persist_state === 'true',
+    coldStart = false,
     onEvent,
+    isReady = isFullyReady,
+    onProbe,
   } = opts;
 
   if (!existsSync(PATHS.clientRunner)) {
@@ -45,10 +63,29 @@ export function launchClient(config, opts = {}) {
     throw new Error(`router not found: ${PATHS.router}`);
   }
 
-  // Runtime directory (restricted permissions)
-  const oldUmask = process.umask(0o077);
-  const runDir = mkdtempSync(resolve(tmpdir(), 'cocoon-client-'));
-  process.umask(oldUmask);
+  // TON config
+  const tonConfigPath = resolve(PROJECT_ROOT, config.ton_config || 'spec/mainnet-full-ton-config.json');
+  if (!existsSync(tonConfigPath)) {
+    throw new Error(`TON config not found: ${tonConfigPath}`);
+  }
+
+  // Runtime directory (restricted permissions): throwaway, or persistent
+  // so TonLib state survives restarts (see state-dir.js)
+  let runDir;
+  let warmStart = false;
+  if (persistState) {
+    const fingerprint = stateFingerprint([
+      readFileSync(tonConfigPath, 'utf-8'),
+      config.node_wallet_key, config.owner_address, config.root_contract_address,
+    ]);
+    const stateDir = openStateDir(parseInt(config.instance || '0', 10), fingerprint, { coldStart });
+    runDir = stateDir.dir;
+    warmStart = stateDir.warm;
+  } else {
+    const oldUmask = process.umask(0o077);
+    runDir = mkdtempSync(resolve(tmpdir(), 'cocoon-client-'));
+    process.umask(oldUmask);
+  }
 
   // Compute config
   const vars = getRuntimeVars(config);
@@ -56,39 +93,39 @@ export function launchClient(config, opts = {}) {
 
   const renderedConfig = renderTemplate(PATHS.clientConfigTemplate, vars);
   const clientConfigPath = resolve(runDir, 'client-config.json');
-  writeFileSync(clientConfigPath, renderedConfig);
-
-  // TON config
-  const tonConfigPath = resolve(PROJECT_ROOT, config.ton_config || 'spec/mainnet-full-ton-config.json');
-  if (!existsSync(tonConfigPath)) {
-    rmSync(runDir, { recursive: true, force: true });
-    throw new Error(`TON config not found: ${tonConfigPath}`);
-  }
+  writeFileSync(clientConfigPath, renderedConfig, { mode: 0o600 });
 
   // Copy full TON config as-is (like the original start.sh).
   // Do NOT merge with base config — base has empty DHT nodes which causes SIGSEGV.
   copyFileSync(tonConfigPath, resolve(runDir, 'global.config.json'));
 
-  // Cleanup handler
+  // Cleanup handler (a persistent directory is kept)
+  let unregisterCleanup = null;
   const cleanup = () => {
-    try { rmSync(runDir, { recursive: true, force: true }); } catch {}
+    if (!persistState) {
+      try { rmSync(runDir, { recursive: true, force: true }); } catch {}
+    }
+    if (unregisterCleanup) unregisterCleanup();
   };
-  setupSignalHandlers(cleanup);
+  unregisterCleanup = setupSignalHandlers(cleanup);
 
-  // Ports
-  const instance = parseInt(config.instance || '0', 10);
-  const httpPort = 10000 + instance * 10;
+  // Ports (each instance owns a block of 10 — see getRuntimeVars)
+  const httpPort = parseInt(vars.CLIENT_HTTP_PORT, 10);
+
+  // Readiness follows the client-runner's lifecycle lines (router exits end it too)
+  const readiness = createReadiness({ probe: () => probeJsonStats(httpPort), isReady, onProbe });
 
   // Start router
   const routerProc = spawnWithPrefix(
     PATHS.router,
-    ['-S', `8116@${routerPolicy}`, '--serialize-info', `-v${verbosity}`],
+    ['-S', `${vars.ROUTER_PORT}@${routerPolicy}`, '--serialize-info', `-v${verbosity}`],
     {
       prefix: 'ROUTER', color: 'cyan', quiet,
       onEvent: (event, data) => {
         if (event === 'fatal') console.error(RED('  ✗ Router crashed.'));
         if (event === 'exit' && data?.code && data.code !== 0)
           console.error(RED(`  ✗ Router exited (code ${data.code}).`));
+        if (event === 'exit' || event === 'fatal') readiness.signal(event);
         if (onEvent) onEvent(event, data);
       },
     }
@@ -100,6 +137,7 @@ export function launchClient(config, opts = {}) {
     ['--config', clientConfigPath, `-v${verbosity}`],
     {
       prefix: 'CLIENT', color: 'yellow', quiet,
+      cwd: persistState ? runDir : undefined,
       env: {
         COCOON_ROUTER_POLICY: routerPolicy,
         COCOON_SKIP_TDX_USERCLAIMS: '1',
@@ -109,63 +147,33 @@ export function launchClient(config, opts = {}) {
         if (event === 'fatal') console.error(RED('  ✗ Client crashed.'));
         if (event === 'exit' && data?.code && data.code !== 0)
           console.error(RED(`  ✗ Client exited (code ${data.code}).`));
+        readiness.signal(event);
         if (onEvent) onEvent(event, data);
       },
     }
   );
 
-  // Kill both processes
+  // Kill both processes; resolves once both have exited (their ports are free)
   const kill = () => {
-    for (const proc of [routerProc, clientProc]) {
+    readiness.cancel();
+    const procs = [routerProc, clientProc];
+    const exited = Promise.all(procs.map(proc => (proc.exitCode !== null || proc.signalCode !== null || !proc.pid)
+      ? null
+      : new Promise(r => proc.once('exit', r).once('error', r))));
+    for (const proc of procs) {
       try { proc.kill('SIGTERM'); } catch {}
     }
     // Force kill after 3s
-    setTimeout(() => {
-      for (const proc of [routerProc, clientProc]) {
+    const force = setTimeout(() => {
+      for (const proc of procs) {
         try { proc.kill('SIGKILL'); } catch {}
       }
     }, 3000);
+    return exited.then(() => clearTimeout(force));
   };
 
-  return { cleanup, kill, runDir, httpPort, routerProc, clientProc };
-}
-
-/**
- * Check if jsonstats data indicates fully ready (proxy connected + staked).
- */
-export function isFullyReady(data) {
-  const pc = data?.proxy_connections?.[0];
-  const staked = data?.proxies?.[0]?.tokens_payed > 0;
-  return !!(pc?.is_ready && staked);
-}
-
-/**
- * Poll /jsonstats until a condition is met.
- * @param {number} port
- * @param {object} [opts]
- * @param {(status: object) => void} [opts.onUpdate]
- * @param {(data: object) => boolean} [opts.isReady] - custom readiness check (default: isFullyReady)
- * @param {number} [opts.timeoutMs=300000]
- * @param {number} [opts.intervalMs=3000]
- * @returns {Promise<object | null>}
- */
-export async function waitForReady(port, opts = {}) {
-  const { onUpdate, isReady = isFullyReady, timeoutMs = 300_000, intervalMs = 3_000 } = opts;
-  const deadline = Date.now() + timeoutMs;
-  const url = `http://localhost:${port}/jsonstats`;
-
-  while (Date.now() < deadline) {
-    try {
-      const res = await fetch(url);
-      if (res.ok) {
-        const data = await res.json();
-        if (onUpdate) onUpdate(data);
-        if (isReady(data)) return data;
-      }
-    } catch {
-      if (onUpdate) onUpdate(null);
-    }
-    await new Promise(r => setTimeout(r, intervalMs));
-  }
-  return null;
+  return {
+    cleanup, kill, runDir, httpPort, warmStart, routerProc, clientProc,
+    ready: readiness.promise, phases: readiness.phases,
+  };
 }
@@ -0,0 +1,250 @@
+/**
+ * Content-addressed cache for deterministic chat completions.
+ *
+ * - Keyed by a SHA-256 of the canonicalised request body (object keys
+ *   sorted, `user` dropped), so reordered JSON hits the same entry.
+ * - Only `temperature: 0`, single-choice requests are cacheable.
+ * - An entry is the upstream response exactly as it was chunked (SSE
+ *   or a plain JSON body), so a hit replays the original stream.
+ * - Two tiers: an LRU in memory bounded by `maxMemoryBytes`, and one
+ *   JSON file per entry under `dir` bounded by `maxDiskBytes` (oldest
+ *   evicted first). Entries older than `ttlMs` are dropped on read.
+ *   Disk reads and writes are async, so a multi-megabyte entry never
+ *   blocks the streams being proxied.
+ */
+
+import { createHash } from 'crypto';
+import { mkdir, readdir, readFile, writeFile, rename, stat, unlink } from 'fs/promises';
+import { join } from 'path';
+
+// Request fields that do not change the completion
+const IGNORED_FIELDS = new Set(['user']);
+
+/** JSON with object keys sorted at every level. */
+export function canonicalJson(value) {
+  if (Array.isArray(value)) return `[${value.map(canonicalJson).join(',')}]`;
+  if (value && typeof value === 'object') {
+    const keys = Object.keys(value).filter(k => value[k] !== undefined).sort();
+    return `{${keys.map(k => `${JSON.stringify(k)}:${canonicalJson(value[k])}`).join(',')}}`;
+  }
+  return JSON.stringify(value);
+}
+
+/** Whether a parsed request body always yields the same completion. */
+export function isCacheable(body) {
+  return !!body && typeof body === 'object' && !Array.isArray(body)
+    && body.temperature === 0 && (body.n ?? 1) === 1;
+}
+
+/** Cache key of a parsed request body. */
+export function completionKey(body) {
+  const kept = Object.fromEntries(Object.entries(body).filter(([k]) => !IGNORED_FIELDS.has(k)));
+  return createHash('sha256').update(canonicalJson(kept)).digest('hex');
+}
+
+/**
+ * Tokens a cached response stands for: `usage.total_tokens` when the
+ * runner reported it (JSON body, or the usage chunk of a stream),
+ * otherwise the number of streamed events.
+ */
+export function responseTokens({ chunks }) {
+  const text = Buffer.concat(chunks).toString();
+  let usage = null;
+  let events = 0;
+  if (text.trimStart().startsWith('{')) {
+    try { usage = JSON.parse(text).usage ?? null; } catch {}
+  } else {
+    for (const line of text.split('\n')) {
+      if (!line.startsWith('data: ') || line === 'data: [DONE]') continue;
+      events++;
+      if (!line.includes('"usage"')) continue;
+      try { usage = JSON.parse(line.slice(6)).usage ?? usage; } catch {}
+    }
+  }
+  return usage?.total_tokens ?? events;
+}
+
+function entryBytes(entry) {
+  return entry.chunks.reduce((n, c) => n + c.length, 0);
+}
+
+/**
+ * @param {object} opts
+ * @param {string} [opts.dir] - disk tier directory (no disk tier without it)
+ * @param {number} [opts.maxMemoryBytes=64 MB]
+ * @param {number} [opts.maxDiskBytes=512 MB]
+ * @param {number} [opts.ttlMs=24 h]
+ * @param {() => number} [opts.now=Date.now]
+ */
+export function createCompletionCache(opts = {}) {
+  const {
+    dir = null,
+    maxMemoryBytes = 64 * 1024 * 1024,
+    maxDiskBytes = 512 * 1024 * 1024,
+    ttlMs = 24 * 3600_000,
+    now = Date.now,
+  } = opts;
+  const memory = new Map();   // key → entry, least recently used first
+  let memoryBytes = 0;
+  const disk = new Map();     // key → { bytes, createdAt }, oldest first
+  let diskBytes = 0;
+  let writes = 0;             // unique temp file names for concurrent puts
+  const counts = { hits: 0, misses: 0, stores: 0, tokensSaved: 0 };
+
+  const fileOf = (key) => join(dir, `${key}.json`);
+
+  // Files left by earlier runs, oldest first
+  const indexed = dir ? (async () => {
+    try {
+      const files = await Promise.all((await readdir(dir))
+        .filter(f => /^[0-9a-f]{64}\.json$/.test(f))
+        .map(async f => ({ key: f.slice(0, -5), stat: await stat(join(dir, f)) })));
+      files.sort((a, b) => a.stat.mtimeMs - b.stat.mtimeMs);
+      for (const { key, stat: st } of files) {
+        if (disk.has(key)) continue;  // stored since startup
+        disk.set(key, { bytes: st.size, createdAt: st.mtimeMs });
+        diskBytes += st.size;
+      }
+    } catch {}
+  })() : null;
+
+  /** Forget a disk entry without touching its file. */
+  function unindex(key) {
+    const meta = disk.get(key);
+    if (!meta) return false;
+    disk.delete(key);
+    diskBytes -= meta.bytes;
+    return true;
+  }
+
+  async function dropDisk(key) {
+    if (unindex(key)) await unlink(fileOf(key)).catch(() => {});
+  }
+
+  function dropMemory(key) {
+    const entry = memory.get(key);
+    if (!entry) return;
+    memory.delete(key);
+    memoryBytes -= entryBytes(entry);
+  }
+
+  function remember(key, entry) {
+    dropMemory(key);
+    const bytes = entryBytes(entry);
+    if (bytes > maxMemoryBytes) return;
+    memory.set(key, entry);
+    memoryBytes += bytes;
+    for (const oldest of memory.keys()) {
+      if (memoryBytes <= maxMemoryBytes) break;
+      dropMemory(oldest);
+    }
+  }
+
+  async function persist(key, entry) {
+    if (!dir) return;
+    await indexed;
+    const data = JSON.stringify({ ...entry, chunks: entry.chunks.map(c => c.toString('base64')) });
+    const bytes = Buffer.byteLength(data);
+    if (bytes > maxDiskBytes) return;
+    // The file is replaced below: only its bytes leave the index, and
+    // eviction can't unlink it meanwhile
+    unindex(key);
+    try {
+      await mkdir(dir, { recursive: true, mode: 0o700 });
+      const tmp = `${fileOf(key)}.${++writes}.tmp`;
+      await writeFile(tmp, data, { mode: 0o600 });
+      await rename(tmp, fileOf(key));
+    } catch {
+      return;
+    }
+    unindex(key);  // a concurrent put of the same key may have landed first
+    disk.set(key, { bytes, createdAt: entry.createdAt });
+    diskBytes += bytes;
+    const evicted = [];
+    for (const oldest of disk.keys()) {
+      if (diskBytes <= maxDiskBytes) break;
+      evicted.push(dropDisk(oldest));
+    }
+    await Promise.all(evicted);
+  }
+
+  async function load(key) {
+    if (!dir) return null;
+    await indexed;
+    if (!disk.has(key)) return null;
+    try {
+      const raw = JSON.parse(await readFile(fileOf(key), 'utf-8'));
+      return { ...raw, chunks: raw.chunks.map(c => Buffer.from(c, 'base64')) };
+    } catch {
+      await dropDisk(key);
+      return null;
+    }
+  }
+
+  /**
+   * Look up a response; counts a hit (and its tokens as saved) or a miss.
+   * @returns {Promise<{ status: number, contentType: string, chunks: Buffer[], tokens: number, createdAt: number } | null>}
+   */
+  async function get(key) {
+    let entry = memory.get(key) ?? null;
+    if (entry) {
+      // Refresh LRU position
+      memory.delete(key);
+      memory.set(key, entry);
+    } else {
+      entry = await load(key);
+      if (entry && now() - entry.createdAt <= ttlMs) remember(key, entry);
+    }
+    if (entry && now() - entry.createdAt > ttlMs) {
+      dropMemory(key);
+      await dropDisk(key);
+      entry = null;
+    }
+    if (!entry) {
+      counts.misses++;
+      return null;
+    }
+    counts.hits++;
+    counts.tokensSaved += entry.tokens;
+    return entry;
+  }
+
+  /**
+   * Store a completed response ({ status, contentType, chunks }). It is
+   * served from memory at once; the returned promise settles once the
+   * disk write is done (it never rejects).
+   */
+  function put(key, response) {
+    const entry = {
+      status: response.status,
+      contentType: response.contentType,
+      chunks: response.chunks,
+      tokens: responseTokens(response),
+      createdAt: now(),
+    };
+    counts.stores++;
+    remember(key, entry);
+    return persist(key, entry);
+  }
+
+  async function clear() {
+    memory.clear();
+    memoryBytes = 0;
+    await indexed;
+    await Promise.all([...disk.keys()].map(dropDisk));
+  }
+
+  function stats() {
+    const lookups = counts.hits + counts.misses;
+    return {
+      ...counts,
+      hitRatio: lookups ? counts.hits / lookups : 0,
+      entries: memory.size,
+      memoryBytes,
+      diskEntries: disk.size,
+      diskBytes,
+    };
+  }
+
+  return { get, put, clear, stats };
+}
@@ -1,6 +1,7 @@
 import { readFileSync, writeFileSync, existsSync, mkdirSync, chmodSync } from 'fs';
 import { resolve, dirname } from 'path';
 import { fileURLToPath } from 'url';
+import { parseProxyConnections } from './connections.js';
 
 const __dirname = dirname(fileURLToPath(import.meta.url));
 export const PROJECT_ROOT = resolve(__dirname, '../..');
@@ -74,17 +75,34 @@ export function writeWalletJson(data, path = PATHS.walletJson) {
 export function getRuntimeVars(config) {
   const instance = parseInt(config.instance || '0', 10);
   const offset = instance * 10;
+  const poolIndex = parseInt(config.pool_index || '0', 10);
   return {
     CLIENT_HTTP_PORT: String(10000 + offset),
     CLIENT_RPC_PORT: String(10001 + offset),
+    ROUTER_PORT: String(8116 + offset),
+    PROXY_CONNECTIONS: parseProxyConnections(config.proxy_connections),
     OWNER_ADDRESS: config.owner_address || '',
     ROOT_CONTRACT_ADDRESS: config.root_contract_address || DEFAULT_ROOT_CONTRACT,
     NODE_WALLET_KEY: config.node_wallet_key || '',
     IS_DEBUG: '0',
     TON_CONFIG_FILE: '', // set at render time
+    // Numbers, so the rendered JSON keeps them unquoted
+    MAX_COEFFICIENT: perInstanceNumber(config.max_coefficient, poolIndex),
+    MAX_TOKENS: perInstanceNumber(config.max_tokens, poolIndex),
   };
 }
 
+/**
+ * Entry `index` of a comma-separated per-instance list (`"0, 1500"`); the
+ * last entry also covers the rest of the pool. 0 when unset or invalid.
+ */
+export function perInstanceNumber(list, index = 0) {
+  const values = String(list ?? '').split(',').map(v => v.trim()).filter(Boolean);
+  if (values.length === 0) return 0;
+  const value = Number(values[Math.min(index, values.length - 1)]);
+  return Number.isFinite(value) && value >= 0 ? value : 0;
+}
+
 /**
  * Get the HTTP port from client.conf (falls back to 10000).
  * Single source of truth for port computation — used by client.js and others.
@@ -0,0 +1,59 @@
+/**
+ * Proxy connection helpers — summarise the `proxy_connections` / `proxies`
+ * arrays from client-runner /jsonstats.
+ *
+ * The binary keeps `proxy_connections` (from client-config.json) sessions
+ * open at once and spreads requests over the ready ones itself. A node is
+ * usable as soon as ONE connection is ready, so nothing here looks at
+ * index 0 only.
+ */
+
+export const DEFAULT_PROXY_CONNECTIONS = 1;
+export const MAX_PROXY_CONNECTIONS = 8;
+
+/**
+ * Parse the `proxy_connections` value from client.conf, clamped to 1..8.
+ */
+export function parseProxyConnections(value) {
+  const n = parseInt(value ?? '', 10);
+  if (isNaN(n)) return DEFAULT_PROXY_CONNECTIONS;
+  return Math.min(MAX_PROXY_CONNECTIONS, Math.max(1, n));
+}
+
+/**
+ * Per-connection view of a /jsonstats payload.
+ * Stake (tokens_payed) is joined from `proxies` via proxy_sc_address.
+ * @returns {Array<{ index: number, address: string|null, proxyScAddress: string|null, ready: boolean, seqno: number, tokensPayed: number }>}
+ */
+export function summarizeConnections(stats) {
+  const proxies = stats?.proxies || [];
+  return (stats?.proxy_connections || []).map((pc, index) => {
+    const proxy = proxies.find(p => pc.proxy_sc_address && p.proxy_sc_address === pc.proxy_sc_address);
+    return {
+      index,
+      address: pc.address?.replace(/[[\]]/g, '') || null,
+      proxyScAddress: pc.proxy_sc_address || null,
+      ready: pc.is_ready === true,
+      seqno: pc.seqno ?? 0,
+      tokensPayed: parseFloat(proxy?.tokens_payed ?? pc.tokens_payed ?? 0) || 0,
+    };
+  });
+}
+
+/** Number of connections that finished their handshake. */
+export function countReadyConnections(stats) {
+  return (stats?.proxy_connections || []).filter(pc => pc.is_ready === true).length;
+}
+
+/** Total stake deposited across all proxies. */
+export function totalTokensPayed(stats) {
+  return (stats?.proxies || []).reduce((sum, p) => sum + (parseFloat(p.tokens_payed ?? 0) || 0), 0);
+}
+
+/**
+ * Check if jsonstats data indicates fully ready (at least one proxy
+ * connection ready + stake deposited).
+ */
+export function isFullyReady(stats) {
+  return countReadyConnections(stats) > 0 && totalTokensPayed(stats) > 0;
+}
@@ -14,13 +14,14 @@
  * - fatal: crash/abort
  */
 
-// Noise patterns — these binary lines are demoted to debug
+// Noise patterns — these binary lines are demoted to debug and tagged with
+// a `noise` label so the log aggregator can collapse them into counters
 const NOISE_PATTERNS = [
-  /FwdProxy\.cpp.*set policy name/,
-  /Using default Intel root key/,
-  /router\.cpp:\d+/,
-  /unknown magic 0x/,
-  /dropping received message/,
+  { pattern: /FwdProxy\.cpp.*set policy name/, label: 'FwdProxy set policy name' },
+  { pattern: /Using default Intel root key/, label: 'Using default Intel root key' },
+  { pattern: /router\.cpp:\d+/, label: 'router.cpp' },
+  { pattern: /unknown magic 0x/, label: 'unknown magic' },
+  { pattern: /dropping received message/, label: 'dropping received message' },
 ];
 
 // Warning patterns — these get special human-readable messages
@@ -89,7 +90,7 @@ export function classifyEvent(event, data) {
           const key = wp.message;
           if (seenWarnings.has(key)) {
             // Return as debug (suppressed repeat)
-            return { type: 'log', level: 'debug', message: raw, category: 'debug', timestamp };
+            return { type: 'log', level: 'debug', message: raw, category: 'debug', noise: wp.message, timestamp };
           }
           seenWarnings.add(key);
         }
@@ -99,8 +100,8 @@ export function classifyEvent(event, data) {
 
     // Check noise patterns
     for (const np of NOISE_PATTERNS) {
-      if (np.test(raw)) {
-        return { type: 'log', level: 'debug', message: raw, category: 'debug', timestamp };
+      if (np.pattern.test(raw)) {
+        return { type: 'log', level: 'debug', message: raw, category: 'debug', noise: np.label, timestamp };
       }
     }
 
@@ -120,6 +121,13 @@ export function createMilestone(message) {
   return { type: 'milestone', level: 'info', message, category: 'milestone', timestamp: Date.now() };
 }
 
+/**
+ * Create a warning event (for state tracker)
+ */
+export function createWarning(message) {
+  return { type: 'warning', level: 'warn', message, category: 'warning', timestamp: Date.now() };
+}
+
 /**
  * Reset dedup state (call on client stop/restart)
  */
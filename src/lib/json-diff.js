@@ -0,0 +1,87 @@
+/**
+ * Minimal JSON-patch style diff (RFC 6902 subset: add / remove / replace).
+ *
+ * Used by the stats publisher to push only the changed fields of
+ * /jsonstats over SSE. Objects are diffed key by key; arrays of equal
+ * length are diffed by index, arrays that changed length are replaced
+ * whole (stats arrays are short and positional).
+ */
+
+function isContainer(v) {
+  return v !== null && typeof v === 'object';
+}
+
+function escapeToken(key) {
+  return String(key).replaceAll('~', '~0').replaceAll('/', '~1');
+}
+
+function unescapeToken(token) {
+  return token.replaceAll('~1', '/').replaceAll('~0', '~');
+}
+
+function walk(prev, next, path, ops) {
+  if (prev === next) return;
+  if (!isContainer(prev) || !isContainer(next) || Array.isArray(prev) !== Array.isArray(next)) {
+    ops.push({ op: 'replace', path, value: next });
+    return;
+  }
+  if (Array.isArray(next)) {
+    if (prev.length !== next.length) {
+      ops.push({ op: 'replace', path, value: next });
+      return;
+    }
+    for (let i = 0; i < next.length; i++) walk(prev[i], next[i], `${path}/${i}`, ops);
+    return;
+  }
+  for (const key of Object.keys(prev)) {
+    if (!(key in next)) ops.push({ op: 'remove', path: `${path}/${escapeToken(key)}` });
+  }
+  for (const key of Object.keys(next)) {
+    const childPath = `${path}/${escapeToken(key)}`;
+    if (!(key in prev)) ops.push({ op: 'add', path: childPath, value: next[key] });
+    else walk(prev[key], next[key], childPath, ops);
+  }
+}
+
+/**
+ * Compute the operations that turn `prev` into `next`.
+ * @returns {Array<{ op: 'add'|'remove'|'replace', path: string, value?: any }>}
+ */
+export function diffJson(prev, next) {
+  const ops = [];
+  walk(prev, next, '', ops);
+  return ops;
+}
+
+/**
+ * Apply operations from diffJson without mutating `doc`.
+ * Unchanged subtrees are shared with the input (structural sharing).
+ */
+export function applyPatch(doc, ops) {
+  let root = doc;
+  for (const { op, path, value } of ops) {
+    if (path === '') {
+      root = op === 'remove' ? undefined : value;
+      continue;
+    }
+    const tokens = path.slice(1).split('/').map(unescapeToken);
+    root = setIn(root, tokens, op, value);
+  }
+  return root;
+}
+
+function setIn(node, tokens, op, value) {
+  const [head, ...rest] = tokens;
+  const copy = Array.isArray(node) ? [...node] : { ...node };
+  if (rest.length === 0) {
+    if (op === 'remove') {
+      if (Array.isArray(copy)) copy.splice(Number(head), 1);
+      else delete copy[head];
+    } else {
+      copy[head] = value;
+    }
+    return copy;
+  }
+  copy[head] = setIn(node?.[head] ?? {}, rest, op, value);
+  return copy;
+}
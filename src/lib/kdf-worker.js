@@ -0,0 +1,12 @@
+/**
+ * Worker thread for mnemonic → keypair derivation (PBKDF2, see key-cache.js).
+ * Receives the mnemonic words in workerData, posts back the keypair.
+ */
+
+import { parentPort, workerData } from 'worker_threads';
+import { mnemonicToPrivateKey } from '@ton/crypto';
+
+const keys = await mnemonicToPrivateKey(workerData.mnemonic);
+parentPort.postMessage({ publicKey: keys.publicKey, secretKey: keys.secretKey });
+// postMessage cloned the buffers: wipe this thread's copy
+keys.secretKey.fill(0);
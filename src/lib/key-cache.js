@@ -0,0 +1,75 @@
+/**
+ * In-memory cache of keypairs derived from mnemonics.
+ *
+ * mnemonicToPrivateKey() runs PBKDF2 and used to run on every stake,
+ * transfer and cashout, on the same event loop that streams inference.
+ * Now each mnemonic is derived once per process, in a worker thread, and
+ * the result is kept until exit, when the secret keys are zeroed.
+ */
+
+import { createHash } from 'crypto';
+import { Worker } from 'worker_threads';
+
+/** Derive in a worker thread so the main event loop keeps streaming. */
+export function deriveInWorker(mnemonic) {
+  return new Promise((resolve, reject) => {
+    const worker = new Worker(new URL('./kdf-worker.js', import.meta.url), { workerData: { mnemonic } });
+    worker.once('message', ({ publicKey, secretKey }) => {
+      resolve({ publicKey: Buffer.from(publicKey), secretKey: Buffer.from(secretKey) });
+    });
+    worker.once('error', reject);
+    worker.once('exit', (code) => {
+      if (code !== 0) reject(new Error(`Key derivation worker exited with code ${code}`));
+    });
+  });
+}
+
+/**
+ * @param {(mnemonic: string[]) => Promise<{ publicKey: Buffer, secretKey: Buffer }>} [derive=deriveInWorker]
+ */
+export function createKeyCache(derive = deriveInWorker) {
+  const entries = new Map();  // sha256(mnemonic) → Promise<keys>
+  const settled = new Set();  // derived keypairs, for zeroing
+
+  return {
+    /**
+     * Keypair for a mnemonic; concurrent callers share one derivation.
+     * @param {string[]} mnemonic
+     * @returns {Promise<{ publicKey: Buffer, secretKey: Buffer }>}
+     */
+    get(mnemonic) {
+      const id = createHash('sha256').update(mnemonic.join(' ')).digest('hex');
+      let entry = entries.get(id);
+      if (!entry) {
+        entry = derive(mnemonic).then((keys) => {
+          settled.add(keys);
+          return keys;
+        });
+        // A failed derivation is not cached
+        entry.catch(() => entries.delete(id));
+        entries.set(id, entry);
+      }
+      return entry;
+    },
+
+    /** Zero every cached secret key and forget them. */
+    clear() {
+      for (const keys of settled) keys.secretKey.fill(0);
+      settled.clear();
+      entries.clear();
+    },
+
+    get size() {
+      return entries.size;
+    },
+  };
+}
+
+/** Process-wide cache, zeroed on exit. */
+export const keyCache = createKeyCache();
+process.once('exit', () => keyCache.clear());
+
+/** Owner-wallet keypair for a mnemonic (derived once per process). */
+export function getMnemonicKeys(mnemonic) {
+  return keyCache.get(mnemonic);
+}
@@ -0,0 +1,98 @@
+/**
+ * Line parsing for router / client-runner output.
+ *
+ * At -v4/-v5 the binaries print tens of thousands of lines per second, so
+ * this stays cheap per line:
+ * - chunks stay Buffers until a complete line is known; only the trailing
+ *   partial line is carried over (no re-splitting of an accumulated string)
+ * - the ANSI strip is skipped for lines without an ESC byte
+ * - one combined alternation regex rejects non-lifecycle lines in a single
+ *   pass; the individual patterns only run on the rare lines that pass it
+ */
+
+// Patterns to detect lifecycle events from binary output (first match wins)
+export const LIFECYCLE_PATTERNS = [
+  { pattern: /TonLib is synced/, event: 'ton_synced', message: 'TON blockchain synced' },
+  { pattern: /initialization completed/, event: 'initialized', message: 'Client initialized' },
+  { pattern: /OK, connecting to \[(.+?)\]/, event: 'proxy_connecting', extract: 1, message: 'Connecting to proxy {0}' },
+  { pattern: /handshake completed successfully/, event: 'proxy_ready', message: 'Proxy connected' },
+  { pattern: /outbound connection ready/, event: 'connection_ready', message: 'Connection established' },
+  { pattern: /TcpListener\[port:(\d+)\]\]\s+[\d.]+ (\d+)/, event: 'listening', extract: [1, 2] },
+  { pattern: /FATAL|fatal|Aborted/, event: 'fatal', message: null },
+  { pattern: /\[ 0\].*[Ee]rror/, event: 'error', message: null },
+];
+
+// Union of the literal parts of every pattern above — keep in sync
+const PREFILTER = /TonLib is synced|initialization completed|OK, connecting to \[|handshake completed successfully|outbound connection ready|TcpListener\[port:|FATAL|fatal|Aborted|\[ 0\]/;
+
+const ANSI_RE = /\x1b\[[0-9;]*m/g;
+const NEWLINE = 0x0a;
+const CR = 0x0d;
+
+/** Longest partial line kept between chunks before it is flushed as-is. */
+export const MAX_LINE_BYTES = 64 * 1024;
+
+/**
+ * Strip ANSI color codes (no regex run when there is no ESC in the line).
+ */
+export function stripAnsi(line) {
+  return line.indexOf('\x1b') === -1 ? line : line.replace(ANSI_RE, '');
+}
+
+/**
+ * Match a (clean) line against LIFECYCLE_PATTERNS.
+ * @returns {{ event: string, match: RegExpMatchArray } | null}
+ */
+export function matchLifecycle(line) {
+  if (!PREFILTER.test(line)) return null;
+  for (const lp of LIFECYCLE_PATTERNS) {
+    const match = line.match(lp.pattern);
+    if (match) return { event: lp.event, match };
+  }
+  return null;
+}
+
+/**
+ * Streaming line splitter over Buffer chunks.
+ * Each chunk is decoded once, up to its last newline (a UTF-8 sequence never
+ * contains 0x0a, so that prefix is always complete); only the bytes after it
+ * are carried over. Empty lines are skipped and a trailing \r is dropped.
+ * @param {(line: string) => void} onLine
+ * @returns {{ push: (chunk: Buffer) => void, end: () => void }}
+ */
+export function createLineSplitter(onLine) {
+  let rest = null;
+
+  const emit = (line) => {
+    if (line.charCodeAt(line.length - 1) === CR) line = line.slice(0, -1);
+    if (line) onLine(line);
+  };
+
+  return {
+    push(chunk) {
+      const buf = rest ? Buffer.concat([rest, chunk]) : chunk;
+      const last = buf.lastIndexOf(NEWLINE);
+      if (last === -1) {
+        rest = buf;
+        if (rest.length > MAX_LINE_BYTES) {
+          emit(rest.toString('utf8'));
+          rest = null;
+        }
+        return;
+      }
+      const text = buf.toString('utf8', 0, last);
+      let start = 0;
+      let nl;
+      while ((nl = text.indexOf('\n', start)) !== -1) {
+        emit(text.slice(start, nl));
+        start = nl + 1;
+      }
+      emit(text.slice(start));
+      rest = last + 1 < buf.length ? buf.subarray(last + 1) : null;
+    },
+    end() {
+      if (rest) emit(rest.toString('utf8'));
+      rest = null;
+    },
+  };
+}
@@ -0,0 +1,87 @@
+/**
+ * Log aggregator — batches debug-level binary lines into time-windowed
+ * `log_batch` frames so a chatty client-runner produces at most one SSE
+ * message per window instead of one per line.
+ *
+ * Lines the classifier tagged as noise (`event.noise`) are not forwarded
+ * individually; they collapse into per-label repeat counters
+ * ("×312 dropping received message").
+ *
+ * Frame: { type: 'log_batch', level: 'debug', category: 'debug', message,
+ *          lines: [{ message, timestamp, instance? }],
+ *          repeats: [{ message, count }], dropped, timestamp }
+ */
+
+export const DEFAULT_WINDOW_MS = 1_000;
+export const DEFAULT_MAX_LINES = 50;
+
+/**
+ * @param {object} opts
+ * @param {(frame: object) => void} opts.onFrame
+ * @param {number} [opts.windowMs=1000]  frame interval
+ * @param {number} [opts.maxLines=50]    lines kept per frame (the rest only counted)
+ */
+export function createLogAggregator({ onFrame, windowMs = DEFAULT_WINDOW_MS, maxLines = DEFAULT_MAX_LINES }) {
+  let lines = [];
+  let repeats = new Map();  // noise label → count
+  let dropped = 0;
+  let timer = null;
+
+  function pending() {
+    return lines.length + repeats.size + dropped;
+  }
+
+  function flush() {
+    if (timer) {
+      clearTimeout(timer);
+      timer = null;
+    }
+    if (pending() === 0) return;
+    const total = lines.length + dropped;
+    const frame = {
+      type: 'log_batch',
+      level: 'debug',
+      category: 'debug',
+      message: `${total} log line${total === 1 ? '' : 's'}`,
+      lines,
+      repeats: [...repeats].map(([message, count]) => ({ message, count })),
+      dropped,
+      timestamp: Date.now(),
+    };
+    lines = [];
+    repeats = new Map();
+    dropped = 0;
+    onFrame(frame);
+  }
+
+  return {
+    /** Queue a classified debug event for the current window. */
+    add(event) {
+      if (event.noise) {
+        repeats.set(event.noise, (repeats.get(event.noise) ?? 0) + 1);
+      } else if (lines.length < maxLines) {
+        const line = { message: event.message, timestamp: event.timestamp };
+        if (event.instance !== undefined) line.instance = event.instance;
+        lines.push(line);
+      } else {
+        dropped++;
+      }
+      if (!timer) {
+        timer = setTimeout(flush, windowMs);
+        timer.unref?.();
+      }
+    },
+
+    /** Emit the pending frame now (e.g. before a lifecycle event, to keep order). */
+    flush,
+
+    /** Discard pending lines and stop the timer. */
+    reset() {
+      if (timer) clearTimeout(timer);
+      timer = null;
+      lines = [];
+      repeats = new Map();
+      dropped = 0;
+    },
+  };
+}
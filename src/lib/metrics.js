@@ -0,0 +1,134 @@
+/**
+ * Minimal Prometheus-style metrics registry (text exposition format 0.0.4).
+ *
+ * Counters, gauges and histograms with labels, plus collectors: callbacks
+ * run at scrape time to refresh gauges from state owned elsewhere (cache
+ * counters, SSE subscribers, jsonstats samples).
+ */
+
+export const DEFAULT_BUCKETS = [0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10];
+
+function escapeLabel(value) {
+  return String(value).replace(/\\/g, '\\\\').replace(/\n/g, '\\n').replace(/"/g, '\\"');
+}
+
+function labelKey(labels) {
+  const keys = Object.keys(labels).sort();
+  return keys.map(k => `${k}="${escapeLabel(labels[k])}"`).join(',');
+}
+
+function formatLabels(key, extra = '') {
+  const all = [key, extra].filter(Boolean).join(',');
+  return all ? `{${all}}` : '';
+}
+
+function formatValue(v) {
+  if (v === Infinity) return '+Inf';
+  if (v === -Infinity) return '-Inf';
+  return Number.isNaN(v) ? 'NaN' : String(v);
+}
+
+/**
+ * Create an isolated registry (tests use their own; the app uses `metrics`).
+ */
+export function createRegistry() {
+  const families = new Map();  // name → { name, help, type, buckets, series: Map(labelKey → value) }
+  const collectors = new Set();
+
+  function family(name, help, type, buckets) {
+    let fam = families.get(name);
+    if (!fam) {
+      fam = { name, help, type, buckets, series: new Map() };
+      families.set(name, fam);
+    } else if (fam.type !== type) {
+      throw new Error(`Metric ${name} already registered as ${fam.type}`);
+    }
+    return fam;
+  }
+
+  function counter(name, help) {
+    const fam = family(name, help, 'counter');
+    return {
+      inc(labels = {}, value = 1) {
+        const key = labelKey(labels);
+        fam.series.set(key, (fam.series.get(key) ?? 0) + value);
+      },
+      /** Mirror a cumulative count kept elsewhere (for collectors). */
+      set(labels, value) {
+        fam.series.set(labelKey(labels), value);
+      },
+    };
+  }
+
+  function gauge(name, help) {
+    const fam = family(name, help, 'gauge');
+    return {
+      set(labels, value) {
+        if (typeof labels === 'number') { value = labels; labels = {}; }
+        fam.series.set(labelKey(labels), value);
+      },
+      /** Drop every series (collectors call this before re-filling). */
+      reset() { fam.series.clear(); },
+    };
+  }
+
+  function histogram(name, help, buckets = DEFAULT_BUCKETS) {
+    const fam = family(name, help, 'histogram', [...buckets].sort((a, b) => a - b));
+    return {
+      observe(labels, value) {
+        if (typeof labels === 'number') { value = labels; labels = {}; }
+        const key = labelKey(labels);
+        let s = fam.series.get(key);
+        if (!s) {
+          s = { counts: new Array(fam.buckets.length).fill(0), sum: 0, count: 0 };
+          fam.series.set(key, s);
+        }
+        for (let i = 0; i < fam.buckets.length; i++) {
+          if (value <= fam.buckets[i]) s.counts[i]++;
+        }
+        s.sum += value;
+        s.count++;
+      },
+    };
+  }
+
+  /** Render every family in the text exposition format. */
+  function render() {
+    for (const collect of collectors) {
+      try { collect(); } catch {}
+    }
+    const lines = [];
+    for (const fam of families.values()) {
+      lines.push(`# HELP ${fam.name} ${fam.help}`);
+      lines.push(`# TYPE ${fam.name} ${fam.type}`);
+      for (const [key, value] of fam.series) {
+        if (fam.type !== 'histogram') {
+          lines.push(`${fam.name}${formatLabels(key)} ${formatValue(value)}`);
+          continue;
+        }
+        fam.buckets.forEach((le, i) => {
+          lines.push(`${fam.name}_bucket${formatLabels(key, `le="${formatValue(le)}"`)} ${value.counts[i]}`);
+        });
+        lines.push(`${fam.name}_bucket${formatLabels(key, 'le="+Inf"')} ${value.count}`);
+        lines.push(`${fam.name}_sum${formatLabels(key)} ${formatValue(value.sum)}`);
+        lines.push(`${fam.name}_count${formatLabels(key)} ${value.count}`);
+      }
+    }
+    return lines.join('\n') + '\n';
+  }
+
+  return {
+    counter,
+    gauge,
+    histogram,
+    render,
+    /** Register a callback run before every render. Returns an unregister function. */
+    addCollector(fn) {
+      collectors.add(fn);
+      return () => collectors.delete(fn);
+    },
+  };
+}
+
+/** Process-wide registry served at /api/metrics. */
+export const metrics = createRegistry();
@@ -1,28 +1,17 @@
 import { spawn } from 'child_process';
 import chalk from 'chalk';
+import { createLineSplitter, matchLifecycle, stripAnsi } from './line-parser.js';
 
 const processes = [];
 let shuttingDown = false;
 let signalHandlersRegistered = false;
-let currentCleanup = null;
-
-// Patterns to detect lifecycle events from binary output
-const LIFECYCLE_PATTERNS = [
-  { pattern: /TonLib is synced/, event: 'ton_synced', message: 'TON blockchain synced' },
-  { pattern: /initialization completed/, event: 'initialized', message: 'Client initialized' },
-  { pattern: /OK, connecting to \[(.+?)\]/, event: 'proxy_connecting', extract: 1, message: 'Connecting to proxy {0}' },
-  { pattern: /handshake completed successfully/, event: 'proxy_ready', message: 'Proxy connected' },
-  { pattern: /outbound connection ready/, event: 'connection_ready', message: 'Connection established' },
-  { pattern: /TcpListener\[port:(\d+)\]\]\s+[\d.]+ (\d+)/, event: 'listening', extract: [1, 2] },
-  { pattern: /FATAL|fatal|Aborted/, event: 'fatal', message: null },
-  { pattern: /\[ 0\].*[Ee]rror/, event: 'error', message: null },
-];
+const cleanups = new Set();
 
 /**
  * Spawn a process with colored, prefixed output.
  * In quiet mode, only lifecycle events and errors are shown.
  */
-export function spawnWithPrefix(cmd, args, { prefix, color, env = {}, quiet = false, onEvent }) {
+export function spawnWithPrefix(cmd, args, { prefix, color, env = {}, cwd, quiet = false, onEvent }) {
   const colorFn = chalk[color] || chalk.white;
   const tag = colorFn.bold(`[${prefix}]`);
 
@@ -32,40 +21,38 @@ export function spawnWithPrefix(cmd, args, { prefix, color, env = {}, quiet = fa
 
   const proc = spawn(cmd, args, {
     stdio: ['ignore', 'pipe', 'pipe'],
+    cwd,
     env: { ...process.env, ...env },
   });
 
   const processLine = (line, stream) => {
-    if (!line.trim()) return;
-
     // Strip ANSI codes for pattern matching
-    const clean = line.replace(/\x1b\[[0-9;]*m/g, '');
+    const clean = stripAnsi(line).trim();
+    if (!clean) return;
 
     // Always keep last lines for exit diagnostics
-    lastLines.push(clean.trim());
+    lastLines.push(clean);
     if (lastLines.length > MAX_LAST_LINES) lastLines.shift();
 
     // Check lifecycle patterns
-    for (const lp of LIFECYCLE_PATTERNS) {
-      const match = clean.match(lp.pattern);
-      if (match) {
-        if (onEvent) onEvent(lp.event, match);
-
-        if (lp.event === 'fatal' || lp.event === 'error') {
-          // Always show errors
-          process.stderr.write(`${tag} ${chalk.red(clean.trim())}\n`);
-          return;
-        }
-
-        // In quiet mode, lifecycle events are handled by onEvent callback
-        if (quiet) return;
+    const lifecycle = matchLifecycle(clean);
+    if (lifecycle) {
+      if (onEvent) onEvent(lifecycle.event, lifecycle.match);
+
+      if (lifecycle.event === 'fatal' || lifecycle.event === 'error') {
+        // Always show errors
+        process.stderr.write(`${tag} ${chalk.red(clean)}\n`);
+        return;
       }
+
+      // In quiet mode, lifecycle events are handled by onEvent callback
+      if (quiet) return;
     }
 
     // In quiet mode, forward non-lifecycle lines as 'log' events
     // so the WebUI Event Log can display them at higher verbosity.
     if (quiet) {
-      if (onEvent) onEvent('log', [clean.trim()]);
+      if (onEvent) onEvent('log', [clean]);
       return;
     }
 
@@ -75,18 +62,9 @@ export function spawnWithPrefix(cmd, args, { prefix, color, env = {}, quiet = fa
   };
 
   for (const stream of ['stdout', 'stderr']) {
-    let buffer = '';
-    proc[stream].on('data', (data) => {
-      buffer += data.toString();
-      const lines = buffer.split('\n');
-      buffer = lines.pop(); // keep incomplete line
-      for (const line of lines) {
-        processLine(line, stream);
-      }
-    });
-    proc[stream].on('end', () => {
-      if (buffer.trim()) processLine(buffer, stream);
-    });
+    const splitter = createLineSplitter(line => processLine(line, stream));
+    proc[stream].on('data', (data) => splitter.push(data));
+    proc[stream].on('end', () => splitter.end());
   }
 
   proc.on('exit', (code, signal) => {
@@ -105,15 +83,24 @@ export function spawnWithPrefix(cmd, args, { prefix, color, env = {}, quiet = fa
   return proc;
 }
 
+function runCleanups() {
+  for (const fn of [...cleanups]) {
+    try { fn(); } catch {}
+  }
+}
+
 /**
- * Register signal handlers for graceful shutdown
+ * Register signal handlers for graceful shutdown.
+ * Each launched client registers its own cleanup callback (pool mode runs
+ * several side by side); the returned function unregisters it again.
+ * @returns {() => void}
  */
 export function setupSignalHandlers(onCleanup) {
-  // Always update the cleanup callback so stop→start cycles clean the new temp dir
-  currentCleanup = onCleanup;
+  cleanups.add(onCleanup);
+  const unregister = () => { cleanups.delete(onCleanup); };
 
   // Signal handlers only need to be registered once
-  if (signalHandlersRegistered) return;
+  if (signalHandlersRegistered) return unregister;
   signalHandlersRegistered = true;
 
   const shutdown = () => {
@@ -129,7 +116,7 @@ export function setupSignalHandlers(onCleanup) {
       for (const proc of processes) {
         try { proc.kill('SIGKILL'); } catch {}
       }
-      if (currentCleanup) currentCleanup();
+      runCleanups();
       process.exit(1);
     }, 5000);
 
@@ -139,11 +126,12 @@ export function setupSignalHandlers(onCleanup) {
         .map(p => new Promise((resolve) => p.on('exit', resolve)))
     ).then(() => {
       clearTimeout(timeout);
-      if (currentCleanup) currentCleanup();
+      runCleanups();
       process.exit(0);
     });
   };
 
   process.on('SIGINT', shutdown);
   process.on('SIGTERM', shutdown);
+  return unregister;
 }
@@ -0,0 +1,170 @@
+/**
+ * Proxy readiness driven by the lifecycle lines spawnWithPrefix() parses.
+ *
+ * Instead of fixed sleeps and 3–5s polling, /jsonstats is probed with a
+ * short backoff that restarts whenever the binary reports progress
+ * (listening, handshake completed, outbound connection ready). Probes are
+ * held back while a proxy handshake is in flight — the binary is fragile
+ * when polled mid-handshake — for at most HANDSHAKE_GRACE_MS per handshake.
+ *
+ * The time spent in each phase (launching → synced → listening →
+ * handshaking → connected → ready) is recorded for the startup timeline.
+ */
+
+import { request as httpRequest, Agent } from 'http';
+import { isFullyReady } from './connections.js';
+
+export const PROBE_BACKOFF_MS = [250, 500, 1000, 2000];
+export const HANDSHAKE_GRACE_MS = 10_000;
+const PROBE_TIMEOUT_MS = 2_000;
+
+// One-shot sockets (binary is fragile on persistent connections during setup)
+const noKeepAliveAgent = new Agent({ keepAlive: false });
+
+// Lifecycle event → phase it starts (first occurrence only)
+const PHASE_OF_EVENT = {
+  ton_synced: 'synced',
+  listening: 'listening',
+  proxy_connecting: 'handshaking',
+  proxy_ready: 'connected',
+  connection_ready: 'connected',
+};
+
+/** Fetch /jsonstats once; resolves null on any failure. */
+export function probeJsonStats(httpPort, timeoutMs = PROBE_TIMEOUT_MS) {
+  return probeJson(httpPort, '/jsonstats', timeoutMs);
+}
+
+/** GET a JSON document from the client-runner once; resolves null on any failure. */
+export function probeJson(httpPort, path, timeoutMs = PROBE_TIMEOUT_MS) {
+  return new Promise((resolve) => {
+    const req = httpRequest(
+      {
+        hostname: '127.0.0.1', port: httpPort, path, method: 'GET',
+        headers: { Connection: 'close' }, timeout: timeoutMs, agent: noKeepAliveAgent,
+      },
+      (res) => {
+        const chunks = [];
+        res.on('data', c => chunks.push(c));
+        res.on('end', () => {
+          try { resolve(JSON.parse(Buffer.concat(chunks).toString())); } catch { resolve(null); }
+        });
+      },
+    );
+    req.on('timeout', () => req.destroy());
+    req.on('error', () => resolve(null));
+    req.end();
+  });
+}
+
+/**
+ * @param {object} opts
+ * @param {() => Promise<object | null>} opts.probe - e.g. () => probeJsonStats(port)
+ * @param {(stats: object) => boolean} [opts.isReady=isFullyReady]
+ * @param {(stats: object | null) => void} [opts.onProbe] - every probe result
+ * @param {number} [opts.timeoutMs=300000] - resolve null after this long
+ * @param {number[]} [opts.backoff=PROBE_BACKOFF_MS]
+ * @param {number} [opts.handshakeGraceMs=HANDSHAKE_GRACE_MS]
+ * @returns {{
+ *   promise: Promise<object | null>,
+ *   signal: (event: string) => void,
+ *   cancel: () => void,
+ *   phases: () => Array<{ phase: string, at: number, ms: number }>,
+ * }}
+ */
+export function createReadiness(opts) {
+  const {
+    probe, isReady = isFullyReady, onProbe, timeoutMs = 300_000,
+    backoff = PROBE_BACKOFF_MS, handshakeGraceMs = HANDSHAKE_GRACE_MS,
+  } = opts;
+
+  const timeline = [{ phase: 'launching', at: Date.now() }];
+  let settled = false;
+  let listening = false;
+  let probing = false;
+  let attempt = 0;
+  let handshakes = 0;          // proxy_connecting not yet followed by proxy_ready
+  let handshakeDeadline = 0;
+  let timer = null;
+  let resolvePromise;
+  const promise = new Promise((resolve) => { resolvePromise = resolve; });
+
+  const deadline = setTimeout(() => settle(null), timeoutMs);
+  deadline.unref?.();
+
+  function enter(phase) {
+    if (!timeline.some(t => t.phase === phase)) timeline.push({ phase, at: Date.now() });
+  }
+
+  function settle(stats) {
+    if (settled) return;
+    settled = true;
+    clearTimeout(timer);
+    clearTimeout(deadline);
+    if (stats) enter('ready');
+    resolvePromise(stats);
+  }
+
+  function schedule(delay = backoff[Math.min(attempt++, backoff.length - 1)]) {
+    if (settled || !listening) return;
+    clearTimeout(timer);
+    timer = setTimeout(run, delay);
+  }
+
+  async function run() {
+    if (settled || probing) return;
+    const now = Date.now();
+    if (handshakes > 0 && now < handshakeDeadline) {
+      schedule(handshakeDeadline - now);
+      return;
+    }
+    handshakes = 0;
+    probing = true;
+    const stats = await probe();
+    probing = false;
+    if (settled) return;
+    try { onProbe?.(stats); } catch {}
+    if (stats && isReady(stats)) settle(stats);
+    else schedule();
+  }
+
+  return {
+    promise,
+
+    /** Feed a lifecycle event (as emitted by spawnWithPrefix). */
+    signal(event) {
+      if (settled) return;
+      if (PHASE_OF_EVENT[event]) enter(PHASE_OF_EVENT[event]);
+      if (event === 'exit' || event === 'fatal') {
+        settle(null);
+        return;
+      }
+      if (event === 'proxy_connecting') {
+        handshakes++;
+        handshakeDeadline = Date.now() + handshakeGraceMs;
+        return;
+      }
+      if (event === 'proxy_ready') handshakes = Math.max(0, handshakes - 1);
+      if (event === 'listening') listening = true;
+      // Progress: restart the backoff from the shortest delay
+      if (event === 'listening' || event === 'proxy_ready' || event === 'connection_ready') {
+        attempt = 0;
+        schedule();
+      }
+    },
+
+    /** Stop probing and resolve null. */
+    cancel() {
+      settle(null);
+    },
+
+    /** Phases entered so far with the time spent in each (the current one: until now). */
+    phases() {
+      const now = Date.now();
+      return timeline.map((t, i) => ({
+        ...t,
+        ms: t.phase === 'ready' ? 0 : (timeline[i + 1]?.at ?? now) - t.at,
+      }));
+    },
+  };
+}
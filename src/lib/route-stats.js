@@ -0,0 +1,106 @@
+/**
+ * Measured routing statistics per client-runner instance and model.
+ *
+ * The streaming path records every completion (TTFT, streamed events per
+ * second, success) under (instance, model) and under (instance, '*').
+ * Averages are exponentially weighted, so a proxy that got slow shows
+ * up within a few requests.
+ *
+ * `rank(hint, model)` turns them into the ordering acquireInstance() uses
+ * for a caller's X-Route-Hint:
+ * - 'latency': lowest expected TTFT, scaled up by current load and error
+ *   rate. Instances without samples go first, so every instance gets
+ *   measured.
+ * - 'price': lowest `max_coefficient` cap (0 = uncapped ranks last);
+ *   ties go to the least loaded instance.
+ */
+
+export const ROUTE_HINTS = ['latency', 'price'];
+
+const ANY_MODEL = '*';
+// Error rate counted at most this high, so a failing instance is deprioritised, not unreachable
+const MAX_ERROR_RATE = 0.9;
+
+/** A valid X-Route-Hint value, else null. */
+export function parseRouteHint(value) {
+  const hint = String(value ?? '').trim().toLowerCase();
+  return ROUTE_HINTS.includes(hint) ? hint : null;
+}
+
+/**
+ * @param {object} [opts]
+ * @param {number} [opts.alpha=0.2] - weight of the newest sample
+ */
+export function createRouteStats({ alpha = 0.2 } = {}) {
+  const series = new Map();   // `${instance}|${model}` → series
+
+  const ewma = (prev, sample, first) => (first ? sample : prev + alpha * (sample - prev));
+
+  function update(instance, model, { ttftMs, tokensPerSec, ok }) {
+    const key = `${instance}|${model}`;
+    let s = series.get(key);
+    if (!s) {
+      s = { instance, model, requests: 0, errors: 0, errorRate: 0, ttftMs: null, tokensPerSec: null };
+      series.set(key, s);
+    }
+    s.errorRate = ewma(s.errorRate, ok ? 0 : 1, s.requests === 0);
+    s.requests++;
+    if (!ok) s.errors++;
+    if (ttftMs != null) s.ttftMs = ewma(s.ttftMs, ttftMs, s.ttftMs == null);
+    if (tokensPerSec != null) s.tokensPerSec = ewma(s.tokensPerSec, tokensPerSec, s.tokensPerSec == null);
+  }
+
+  /**
+   * Record one completion.
+   * @param {number} instance
+   * @param {string | null} model - from the request or the first streamed event
+   * @param {{ ttftMs?: number | null, tokensPerSec?: number | null, ok: boolean }} sample
+   */
+  function record(instance, model, sample) {
+    update(instance, ANY_MODEL, sample);
+    if (model) update(instance, model, sample);
+  }
+
+  /** The model's series on an instance, else the instance's overall one. */
+  function estimate(instance, model) {
+    return (model && series.get(`${instance}|${model}`)) || series.get(`${instance}|${ANY_MODEL}`) || null;
+  }
+
+  /**
+   * Ranking for acquireInstance({ rank }); lower is better.
+   * @param {string} hint - one of ROUTE_HINTS
+   * @param {string | null} model
+   * @returns {(inst: { instance: number, inFlight: number, maxCoefficient?: number }) => number}
+   */
+  function rank(hint, model) {
+    if (hint === 'price') {
+      return (inst) => (inst.maxCoefficient > 0 ? inst.maxCoefficient : Number.MAX_SAFE_INTEGER);
+    }
+    return (inst) => {
+      const est = estimate(inst.instance, model);
+      if (!est || est.ttftMs == null) return 0;
+      return (est.ttftMs * (1 + inst.inFlight)) / (1 - Math.min(est.errorRate, MAX_ERROR_RATE));
+    };
+  }
+
+  /** Drop an instance's samples (it restarted, possibly with other proxies). */
+  function forget(instance) {
+    for (const [key, s] of series) {
+      if (s.instance === instance) series.delete(key);
+    }
+  }
+
+  /** All series, by instance then model ('*' first). */
+  function snapshot() {
+    return [...series.values()]
+      .map(s => ({
+        ...s,
+        ttftMs: s.ttftMs == null ? null : Math.round(s.ttftMs),
+        tokensPerSec: s.tokensPerSec == null ? null : Math.round(s.tokensPerSec * 10) / 10,
+        errorRate: Math.round(s.errorRate * 1000) / 1000,
+      }))
+      .sort((a, b) => a.instance - b.instance || (a.model === ANY_MODEL ? -1 : b.model === ANY_MODEL ? 1 : a.model.localeCompare(b.model)));
+  }
+
+  return { record, estimate, rank, forget, snapshot };
+}
@@ -0,0 +1,150 @@
+/**
+ * Token-bucket request scheduler for a rate-limited upstream (Toncenter).
+ *
+ * - One bucket of `burst` tokens refilled at `ratePerSec`; every attempt
+ *   takes a token, so retries count against the limit too.
+ * - Waiters are served by priority: 'user' (transactions someone clicked)
+ *   before 'background' (dashboard / polling refreshes), FIFO within each.
+ * - Identical in-flight work (same key) runs once and is shared.
+ * - A 429 pauses the whole bucket, not just the caller that hit it.
+ */
+
+export const PRIORITIES = ['user', 'background'];
+
+/**
+ * @param {object} [opts]
+ * @param {number} [opts.ratePerSec=1]
+ * @param {number} [opts.burst=ratePerSec]
+ * @param {(priority: string, waitMs: number) => void} [opts.onWait] - after a token is granted
+ * @param {() => number} [opts.now=Date.now]
+ */
+export function createScheduler(opts = {}) {
+  const { onWait, now = Date.now } = opts;
+  let ratePerSec = opts.ratePerSec ?? 1;
+  let burst = opts.burst ?? Math.max(1, ratePerSec);
+  let tokens = burst;
+  let refilledAt = now();
+  let pausedUntil = 0;
+  let timer = null;
+  const queues = Object.fromEntries(PRIORITIES.map(p => [p, []]));
+  const inflight = new Map();   // key → promise
+  const counts = { granted: 0, deduped: 0, paused: 0 };
+
+  function refill() {
+    const t = now();
+    if (t <= refilledAt) return;  // still paused
+    tokens = Math.min(burst, tokens + ((t - refilledAt) / 1000) * ratePerSec);
+    refilledAt = t;
+  }
+
+  function next() {
+    for (const p of PRIORITIES) {
+      if (queues[p].length) return queues[p];
+    }
+    return null;
+  }
+
+  function drain() {
+    clearTimeout(timer);
+    timer = null;
+    refill();
+    let queue;
+    while ((queue = next())) {
+      const t = now();
+      if (t < pausedUntil) {
+        arm(pausedUntil - t);
+        return;
+      }
+      if (tokens < 1) {
+        arm(Math.ceil(((1 - tokens) / ratePerSec) * 1000));
+        return;
+      }
+      tokens -= 1;
+      counts.granted++;
+      const waiter = queue.shift();
+      onWait?.(waiter.priority, t - waiter.enqueuedAt);
+      waiter.resolve();
+    }
+  }
+
+  function arm(delayMs) {
+    clearTimeout(timer);
+    timer = setTimeout(drain, Math.max(1, delayMs));
+  }
+
+  /**
+   * Wait for a token.
+   * @param {'user' | 'background'} [priority='background']
+   */
+  function take(priority = 'background') {
+    const p = queues[priority] ? priority : 'background';
+    return new Promise((resolve) => {
+      queues[p].push({ priority: p, enqueuedAt: now(), resolve });
+      if (!timer) drain();
+    });
+  }
+
+  return {
+    take,
+
+    /**
+     * Run `fn` once per key while it is in flight; later callers with the
+     * same key share the result. Without a key every call runs.
+     * @template T
+     * @param {string | undefined} key
+     * @param {() => Promise<T>} fn
+     * @returns {Promise<T>}
+     */
+    dedupe(key, fn) {
+      if (!key) return fn();
+      const pending = inflight.get(key);
+      if (pending) {
+        counts.deduped++;
+        return pending;
+      }
+      const promise = Promise.resolve().then(fn).finally(() => inflight.delete(key));
+      inflight.set(key, promise);
+      return promise;
+    },
+
+    /** Take a token, then run `fn`. */
+    async schedule(fn, { priority, key } = {}) {
+      return this.dedupe(key, async () => {
+        await take(priority);
+        return fn();
+      });
+    },
+
+    /** Stop granting tokens for `ms` (upstream said 429) and empty the bucket. */
+    pause(ms) {
+      counts.paused++;
+      pausedUntil = Math.max(pausedUntil, now() + ms);
+      tokens = 0;
+      refilledAt = pausedUntil;
+      if (next()) arm(pausedUntil - now());
+    },
+
+    /** Resize the bucket (API key / tier changed). */
+    configure({ ratePerSec: rate, burst: b } = {}) {
+      refill();
+      if (rate > 0) ratePerSec = rate;
+      burst = b > 0 ? b : Math.max(1, ratePerSec);
+      tokens = Math.min(tokens, burst);
+      if (next()) drain();
+    },
+
+    /** Queue depth per priority. */
+    depth() {
+      return Object.fromEntries(PRIORITIES.map(p => [p, queues[p].length]));
+    },
+
+    stats() {
+      refill();
+      return {
+        ratePerSec, burst, tokens: Math.floor(tokens), ...counts,
+        inflight: inflight.size, queued: this.depth(),
+        pausedMs: Math.max(0, pausedUntil - now()),
+      };
+    },
+  };
+}
@@ -0,0 +1,167 @@
+/**
+ * SSE fan-out with a replay ring buffer.
+ *
+ * - Events are serialized once per broadcast, not once per subscriber.
+ * - Buffered events get monotonically increasing ids (`id:` field), kept in
+ *   a fixed-capacity ring; a reconnecting client passes its Last-Event-ID
+ *   and only gets what it missed.
+ * - Slow consumers are shed instead of letting Node buffer without limit:
+ *   when a client's pending output exceeds the high-water mark, unbuffered
+ *   messages are dropped for it and a buffered event disconnects it (the
+ *   browser reconnects and resumes from its Last-Event-ID).
+ * - An unbuffered stream whose messages build on each other (stats
+ *   patches) passes a `resync` callback to send(): a client that had one
+ *   of its messages dropped gets `resync()` (a snapshot) instead of the
+ *   next message, so it can keep applying patches.
+ */
+
+export const DEFAULT_CAPACITY = 200;
+export const DEFAULT_REPLAY = 50;
+export const DEFAULT_HIGH_WATER_MARK = 256 * 1024;
+
+/**
+ * Fixed-capacity ring buffer (oldest entries are overwritten).
+ * @param {number} capacity
+ */
+export function createRingBuffer(capacity) {
+  const items = new Array(capacity);
+  let start = 0;
+  let size = 0;
+
+  return {
+    push(item) {
+      items[(start + size) % capacity] = item;
+      if (size < capacity) size++;
+      else start = (start + 1) % capacity;
+    },
+    /** Entries oldest → newest, optionally only the newest `n`. */
+    toArray(n = size) {
+      const count = Math.min(n, size);
+      const out = new Array(count);
+      for (let i = 0; i < count; i++) out[i] = items[(start + size - count + i) % capacity];
+      return out;
+    },
+    clear() {
+      items.fill(undefined);
+      start = 0;
+      size = 0;
+    },
+    get size() { return size; },
+  };
+}
+
+function frame(data, id) {
+  const json = JSON.stringify(data);
+  return id === undefined ? `data: ${json}\n\n` : `id: ${id}\ndata: ${json}\n\n`;
+}
+
+/**
+ * @param {object} [opts]
+ * @param {number} [opts.capacity=200]        events kept for replay
+ * @param {number} [opts.replay=50]           events sent to a client without Last-Event-ID
+ * @param {number} [opts.highWaterMark=256K]  pending bytes before a client counts as slow
+ * @param {(reason: 'dropped' | 'disconnected') => void} [opts.onShed]
+ */
+export function createBroadcaster(opts = {}) {
+  const {
+    capacity = DEFAULT_CAPACITY, replay = DEFAULT_REPLAY,
+    highWaterMark = DEFAULT_HIGH_WATER_MARK, onShed,
+  } = opts;
+  const ring = createRingBuffer(capacity);  // { id, event, frame }
+  const clients = new Set();
+  // resync callback → clients that missed a message of that stream
+  const stale = new Map();
+  let lastId = 0;
+
+  function remove(res) {
+    clients.delete(res);
+    for (const missed of stale.values()) missed.delete(res);
+  }
+
+  function disconnect(res) {
+    remove(res);
+    onShed?.('disconnected');
+    try { res.destroy(); } catch {}
+  }
+
+  function write(res, chunk) {
+    try {
+      res.write(chunk);
+    } catch {
+      remove(res);
+    }
+  }
+
+  return {
+    /** Buffer an event, assign it the next id and send it to every client. */
+    publish(event) {
+      const entry = { id: ++lastId, event, frame: frame(event, lastId) };
+      ring.push(entry);
+      for (const res of clients) {
+        if (res.writableLength > highWaterMark) disconnect(res);
+        else write(res, entry.frame);
+      }
+      return entry.id;
+    },
+
+    /**
+     * Send a message that is not buffered or replayed; slow clients skip it.
+     * @param {object} message
+     * @param {object} [opts]
+     * @param {() => object} [opts.resync] - message for clients that skipped
+     *   an earlier one sent with the same callback (computed once per send)
+     */
+    send(message, { resync } = {}) {
+      const chunk = frame(message);
+      let missed = null;
+      if (resync) {
+        missed = stale.get(resync);
+        if (!missed) stale.set(resync, (missed = new Set()));
+      }
+      let resyncChunk = null;
+      for (const res of clients) {
+        if (res.writableLength > highWaterMark) {
+          onShed?.('dropped');
+          missed?.add(res);
+        } else if (missed?.has(res)) {
+          resyncChunk ??= frame(resync());
+          missed.delete(res);
+          write(res, resyncChunk);
+        } else {
+          write(res, chunk);
+        }
+      }
+    },
+
+    /**
+     * Replay missed events and start streaming to `res`.
+     * An unknown or absent Last-Event-ID (e.g. after a server restart)
+     * gets the latest `replay` events instead.
+     * @param {import('http').ServerResponse} res
+     * @param {string | number | null} [lastEventId]
+     * @returns {() => void} remove
+     */
+    add(res, lastEventId) {
+      const since = Number.parseInt(lastEventId, 10);
+      const entries = Number.isFinite(since) && since >= 0 && since <= lastId
+        ? ring.toArray().filter(e => e.id > since)
+        : ring.toArray(replay);
+      if (entries.length) write(res, entries.map(e => e.frame).join(''));
+      clients.add(res);
+      return () => remove(res);
+    },
+
+    /** Latest buffered events (oldest first). */
+    recent(n = replay) {
+      return ring.toArray(n).map(e => e.event);
+    },
+
+    /** Drop buffered events; ids keep increasing so resumes stay correct. */
+    clear() {
+      ring.clear();
+    },
+
+    get size() { return clients.size; },
+    get lastId() { return lastId; },
+  };
+}
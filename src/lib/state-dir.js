@@ -0,0 +1,95 @@
+/**
+ * Persistent per-instance runtime directory (opt-in: `persist_state = true`
+ * in client.conf, or --persist-state).
+ *
+ * By default every launch gets a fresh mkdtemp dir that is removed again on
+ * stop, so client-runner redoes TonLib initialisation and sync each time.
+ * With persistence the dir lives at .cocoon-state/instance-<n> and survives
+ * stop/start. client-runner runs with it as cwd, so TonLib state it writes
+ * there is reused on the next (warm) start.
+ *
+ * A directory is only reused if it passes the integrity checks:
+ * - a real directory (not a symlink) owned by us with mode 0700
+ * - its manifest matches the current schema version and input fingerprint
+ *   (TON config, wallet key, contracts) — otherwise the cached state
+ *   belongs to another network or wallet
+ * Anything else, or an explicit cold start, wipes it first.
+ */
+
+import { existsSync, lstatSync, mkdirSync, readFileSync, writeFileSync, rmSync, chmodSync } from 'fs';
+import { createHash } from 'crypto';
+import { resolve } from 'path';
+import { PROJECT_ROOT } from './config.js';
+
+export const STATE_ROOT = resolve(PROJECT_ROOT, '.cocoon-state');
+const MANIFEST = 'state.json';
+const SCHEMA_VERSION = 1;
+
+/**
+ * Fingerprint of everything the cached state depends on.
+ * Only the hash is stored, never the inputs (the wallet key is secret).
+ * @param {string[]} parts
+ */
+export function stateFingerprint(parts) {
+  const hash = createHash('sha256');
+  for (const part of parts) hash.update(String(part ?? '')).update('\0');
+  return hash.digest('hex');
+}
+
+/**
+ * Why an existing directory cannot be reused, or null if it can.
+ * @param {string} dir
+ * @param {string} fingerprint
+ */
+export function checkStateDir(dir, fingerprint) {
+  let st;
+  try { st = lstatSync(dir); } catch { return 'missing'; }
+  if (!st.isDirectory()) return 'not a directory';
+  if (typeof process.getuid === 'function' && st.uid !== process.getuid()) return 'wrong owner';
+  if ((st.mode & 0o077) !== 0) return 'permissions too open';
+
+  let manifest;
+  try { manifest = JSON.parse(readFileSync(resolve(dir, MANIFEST), 'utf-8')); } catch { return 'manifest unreadable'; }
+  if (manifest.version !== SCHEMA_VERSION) return 'schema changed';
+  if (manifest.fingerprint !== fingerprint) return 'inputs changed';
+  return null;
+}
+
+/**
+ * Open (or create) the persistent directory of an instance.
+ * @param {number} instance
+ * @param {string} fingerprint - see stateFingerprint()
+ * @param {object} [opts]
+ * @param {boolean} [opts.coldStart=false] - wipe cached state unconditionally
+ * @param {string} [opts.root=STATE_ROOT]
+ * @returns {{ dir: string, warm: boolean, reason: string | null }}
+ *   reason: why a cold start happened (null when warm)
+ */
+export function openStateDir(instance, fingerprint, opts = {}) {
+  const { coldStart = false, root = STATE_ROOT } = opts;
+  const dir = resolve(root, `instance-${instance}`);
+
+  const oldUmask = process.umask(0o077);
+  try {
+    mkdirSync(root, { recursive: true, mode: 0o700 });
+    let reason = coldStart ? 'cold start requested' : checkStateDir(dir, fingerprint);
+    if (reason && existsSync(dir)) rmSync(dir, { recursive: true, force: true });
+    if (reason) {
+      mkdirSync(dir, { mode: 0o700 });
+      chmodSync(dir, 0o700);
+    }
+
+    const manifestPath = resolve(dir, MANIFEST);
+    let createdAt = Date.now();
+    if (!reason) {
+      try { createdAt = JSON.parse(readFileSync(manifestPath, 'utf-8')).createdAt ?? createdAt; } catch {}
+    }
+    writeFileSync(manifestPath, JSON.stringify({
+      version: SCHEMA_VERSION, fingerprint, instance, createdAt, lastStartedAt: Date.now(),
+    }, null, 2) + '\n', { mode: 0o600 });
+
+    return { dir, warm: reason === null, reason };
+  } finally {
+    process.umask(oldUmask);
+  }
+}
@@ -0,0 +1,225 @@
+/**
+ * In-memory cache of the built WebUI, served with content negotiation.
+ *
+ * The whole directory is read once (and again when it changes, with
+ * `watch`) into a map of URL path → asset. Each asset keeps its identity
+ * bytes plus brotli and gzip variants: taken from `<file>.br`/`<file>.gz`
+ * next to it when the build produced them, otherwise compressed in the
+ * background after loading. Serving is then a map lookup — no fs calls
+ * on the request path.
+ */
+
+import { createHash } from 'crypto';
+import { existsSync, readdirSync, readFileSync, statSync, watch as fsWatch } from 'fs';
+import { dirname, extname, join, relative, sep } from 'path';
+import { promisify } from 'util';
+import { brotliCompress, gzip, constants as zlib } from 'zlib';
+
+const brotliAsync = promisify(brotliCompress);
+const gzipAsync = promisify(gzip);
+
+export const MIME_TYPES = {
+  '.html': 'text/html',
+  '.js': 'application/javascript',
+  '.css': 'text/css',
+  '.json': 'application/json',
+  '.png': 'image/png',
+  '.jpg': 'image/jpeg',
+  '.svg': 'image/svg+xml',
+  '.ico': 'image/x-icon',
+  '.woff': 'font/woff',
+  '.woff2': 'font/woff2',
+  '.ttf': 'font/ttf',
+};
+
+// Already compressed formats, and files too small to be worth it
+const INCOMPRESSIBLE = new Set(['.png', '.jpg', '.woff', '.woff2']);
+const MIN_COMPRESS_BYTES = 1024;
+const RELOAD_DEBOUNCE_MS = 100;
+
+const ENCODINGS = [['br', '.br'], ['gzip', '.gz']];
+const COMPRESSORS = {
+  br: (buf) => brotliAsync(buf, { params: { [zlib.BROTLI_PARAM_QUALITY]: 11 } }),
+  gzip: (buf) => gzipAsync(buf, { level: 9 }),
+};
+
+/**
+ * Pick a response encoding from an Accept-Encoding header.
+ * @param {string | undefined} header
+ * @param {string[]} available - encodings the asset has, besides identity
+ * @returns {string} 'br', 'gzip' or 'identity'
+ */
+export function negotiateEncoding(header, available) {
+  if (!header || available.length === 0) return 'identity';
+  const q = {};
+  for (const part of header.split(',')) {
+    const [name, ...params] = part.trim().toLowerCase().split(';');
+    const qParam = params.map(p => p.trim()).find(p => p.startsWith('q='));
+    q[name] = qParam ? parseFloat(qParam.slice(2)) || 0 : 1;
+  }
+  let best = 'identity';
+  let bestQ = 0;
+  // Server preference order breaks ties: br before gzip
+  for (const enc of available) {
+    const weight = q[enc] ?? q['*'] ?? 0;
+    if (weight > bestQ) {
+      best = enc;
+      bestQ = weight;
+    }
+  }
+  return best;
+}
+
+/** Whether a request's validators match the asset (→ 304). */
+export function isNotModified(headers, asset) {
+  const inm = headers['if-none-match'];
+  if (inm) {
+    // Variant suffixes are ignored: every encoding of a file shares its validator
+    const tags = inm.split(',').map(t => t.trim().replace(/^W\//, '').replace(/-(br|gz)"$/, '"'));
+    return tags.includes('*') || tags.includes(asset.etag);
+  }
+  const ims = headers['if-modified-since'];
+  if (ims) {
+    const since = Date.parse(ims);
+    return Number.isFinite(since) && Math.floor(asset.mtimeMs / 1000) * 1000 <= since;
+  }
+  return false;
+}
+
+function cacheControl(path) {
+  // Hashed filenames (assets/) get long cache, everything else revalidates
+  return path.startsWith('/assets/') ? 'public, max-age=31536000, immutable' : 'no-cache';
+}
+
+function listFiles(dir) {
+  const out = [];
+  for (const entry of readdirSync(dir, { withFileTypes: true })) {
+    const full = join(dir, entry.name);
+    if (entry.isDirectory()) out.push(...listFiles(full));
+    else if (entry.isFile()) out.push(full);
+  }
+  return out;
+}
+
+/**
+ * @param {object} opts
+ * @param {string} opts.root - directory to serve
+ * @param {boolean} [opts.watch=false] - reload when files under root change
+ * @param {{ debug?: Function, warn?: Function }} [opts.logger]
+ */
+export function createStaticAssets({ root, watch = false, logger = null }) {
+  let assets = new Map();
+  let generation = 0;
+  let watcher = null;
+  let reloadTimer = null;
+  let compressing = Promise.resolve();
+
+  async function compressAll(list, gen) {
+    for (const asset of list) {
+      for (const [enc, compress] of Object.entries(COMPRESSORS)) {
+        if (gen !== generation) return;
+        if (asset.variants[enc]) continue;
+        try {
+          const body = await compress(asset.variants.identity);
+          if (body.length < asset.variants.identity.length) asset.variants[enc] = body;
+        } catch (err) {
+          logger?.warn?.({ err: err.message, path: asset.path }, 'static asset compression failed');
+        }
+      }
+    }
+  }
+
+  /** (Re)read everything under root; returns the number of assets. */
+  function load() {
+    const next = new Map();
+    if (existsSync(root)) {
+      const files = listFiles(root);
+      const present = new Set(files);
+      for (const file of files) {
+        const ext = extname(file);
+        // Precompressed siblings are variants of their source file, not assets
+        if ((ext === '.br' || ext === '.gz') && present.has(file.slice(0, -ext.length))) continue;
+        const identity = readFileSync(file);
+        const { mtimeMs } = statSync(file);
+        const path = '/' + relative(root, file).split(sep).join('/');
+        const variants = { identity };
+        for (const [enc, suffix] of ENCODINGS) {
+          if (present.has(file + suffix)) variants[enc] = readFileSync(file + suffix);
+        }
+        next.set(path, {
+          path,
+          contentType: MIME_TYPES[ext] || 'application/octet-stream',
+          cacheControl: cacheControl(path),
+          etag: `"${createHash('sha1').update(identity).digest('base64url').slice(0, 22)}"`,
+          mtimeMs,
+          lastModified: new Date(mtimeMs).toUTCString(),
+          variants,
+          compressible: !INCOMPRESSIBLE.has(ext) && identity.length >= MIN_COMPRESS_BYTES,
+        });
+      }
+    }
+    assets = next;
+    const gen = ++generation;
+    compressing = compressAll([...next.values()].filter(a => a.compressible), gen);
+    logger?.debug?.({ assets: next.size }, 'static assets loaded');
+    return next.size;
+  }
+
+  function scheduleReload() {
+    clearTimeout(reloadTimer);
+    reloadTimer = setTimeout(() => {
+      try {
+        load();
+      } catch (err) {
+        // Mid-build: the next change event reloads again
+        logger?.warn?.({ err: err.message }, 'static asset reload failed');
+      }
+      startWatcher();
+    }, RELOAD_DEBOUNCE_MS);
+  }
+
+  /**
+   * Watch root recursively, or its parent until root exists. Re-created
+   * after every reload, since a build may delete and recreate root.
+   */
+  function startWatcher() {
+    watcher?.close();
+    watcher = null;
+    const target = existsSync(root) ? root : dirname(root);
+    try {
+      watcher = fsWatch(target, { recursive: target === root }, scheduleReload);
+      watcher.on('error', () => {});
+    } catch (err) {
+      logger?.warn?.({ err: err.message }, 'static asset watcher unavailable');
+    }
+  }
+
+  /**
+   * Asset for a URL path; unknown paths fall back to /index.html (SPA).
+   * Returns null when nothing is built.
+   */
+  function lookup(pathname) {
+    let path = pathname === '/' ? '/index.html' : pathname;
+    try { path = decodeURIComponent(path); } catch {}
+    return assets.get(path) ?? assets.get('/index.html') ?? null;
+  }
+
+  function close() {
+    clearTimeout(reloadTimer);
+    watcher?.close();
+    watcher = null;
+    generation++;
+  }
+
+  load();
+  if (watch) startWatcher();
+
+  return {
+    lookup,
+    load,
+    close,
+    /** Resolves once background compression of the current load is done. */
+    ready: () => compressing,
+    get size() { return assets.size; },
+  };
+}
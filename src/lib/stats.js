@@ -0,0 +1,32 @@
+/**
+ * Small descriptive statistics helpers (startup history, benchmarks).
+ */
+
+/**
+ * Percentile with linear interpolation between closest ranks.
+ * @param {number[]} values - unsorted
+ * @param {number} p - 0..100
+ * @returns {number | null} null for an empty input
+ */
+export function percentile(values, p) {
+  if (values.length === 0) return null;
+  const sorted = [...values].sort((a, b) => a - b);
+  const rank = (Math.min(100, Math.max(0, p)) / 100) * (sorted.length - 1);
+  const lo = Math.floor(rank);
+  const hi = Math.ceil(rank);
+  return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - lo);
+}
+
+/**
+ * @param {number[]} values
+ * @returns {{ count: number, min: number|null, max: number|null, p50: number|null, p95: number|null }}
+ */
+export function summarize(values) {
+  return {
+    count: values.length,
+    min: values.length ? Math.min(...values) : null,
+    max: values.length ? Math.max(...values) : null,
+    p50: percentile(values, 50),
+    p95: percentile(values, 95),
+  };
+}
@@ -0,0 +1,74 @@
+/**
+ * Restart policy for supervised client-runner instances.
+ *
+ * - Crashes are restarted with exponential backoff (1s, 2s, 4s … 60s).
+ * - Too many crashes inside a window is a crash loop: stop restarting.
+ * - Error 653 ("stake not confirmed on-chain yet") exits are not a broken
+ *   binary, the proxy just rejects us until the stake lands: retry on a
+ *   fixed longer delay, and give up after a bounded number of attempts.
+ * - Reaching proxy-ready (healthy) resets the backoff and the stake retries,
+ *   but not the crash window: an instance that gets ready and then keeps
+ *   crashing is still a crash loop.
+ *
+ * Pure: the caller owns processes and timers, this only decides.
+ */
+
+export const RESTART_DEFAULTS = {
+  baseDelayMs: 1_000,
+  maxDelayMs: 60_000,
+  crashLoopCount: 5,            // crashes …
+  crashLoopWindowMs: 10 * 60_000, // … within this window = crash loop
+  stakeRetryDelayMs: 60_000,
+  maxStakeRetries: 10,
+};
+
+/** Classify an instance exit from its last output lines. */
+export function exitReason(lastLines) {
+  const text = Array.isArray(lastLines) ? lastLines.join(' | ') : String(lastLines ?? '');
+  return text.includes('Error : 653') || text.includes('cancelled') ? 'stake_unconfirmed' : 'crash';
+}
+
+/**
+ * @param {Partial<typeof RESTART_DEFAULTS>} [opts]
+ * @param {() => number} [now=Date.now]
+ */
+export function createRestartPolicy(opts = {}, now = Date.now) {
+  const cfg = { ...RESTART_DEFAULTS, ...opts };
+  let crashes = [];     // timestamps within the window
+  let attempt = 0;      // consecutive crash restarts (backoff exponent)
+  let stakeRetries = 0;
+
+  return {
+    /**
+     * Decide what to do after an exit.
+     * @param {'crash' | 'stake_unconfirmed'} reason
+     * @returns {{ action: 'restart', delayMs: number } | { action: 'give_up', why: string }}
+     */
+    onExit(reason) {
+      if (reason === 'stake_unconfirmed') {
+        stakeRetries++;
+        if (stakeRetries > cfg.maxStakeRetries) {
+          return { action: 'give_up', why: `stake still unconfirmed after ${cfg.maxStakeRetries} retries` };
+        }
+        return { action: 'restart', delayMs: cfg.stakeRetryDelayMs };
+      }
+
+      const t = now();
+      crashes = crashes.filter(c => t - c < cfg.crashLoopWindowMs);
+      crashes.push(t);
+      if (crashes.length >= cfg.crashLoopCount) {
+        const minutes = Math.round(cfg.crashLoopWindowMs / 60_000);
+        return { action: 'give_up', why: `crash loop (${crashes.length} crashes in ${minutes} min)` };
+      }
+      const delayMs = Math.min(cfg.maxDelayMs, cfg.baseDelayMs * 2 ** attempt);
+      attempt++;
+      return { action: 'restart', delayMs };
+    },
+
+    /** The instance came up fine: restart quickly next time (crashes stay windowed). */
+    onHealthy() {
+      attempt = 0;
+      stakeRetries = 0;
+    },
+  };
+}
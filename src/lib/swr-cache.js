@@ -0,0 +1,88 @@
+/**
+ * Single-flight cache with a stale-while-revalidate window.
+ *
+ * - fresh (age < ttlMs):            served from cache
+ * - stale (age < ttlMs + staleMs):  served from cache, one background refresh
+ * - expired / missing:              one upstream load, concurrent callers
+ *                                   wait on the same promise
+ *
+ * Only values accepted by `shouldCache` are stored; failed or rejected
+ * loads are still shared with every caller waiting on them.
+ */
+
+/**
+ * @param {object} [opts]
+ * @param {number} [opts.ttlMs=2000]
+ * @param {number} [opts.staleMs=0]
+ * @param {(value: any) => boolean} [opts.shouldCache]
+ */
+export function createSwrCache(opts = {}) {
+  const { ttlMs = 2000, staleMs = 0, shouldCache = () => true } = opts;
+  const entries = new Map();   // key → { value, ts }
+  const inflight = new Map();  // key → Promise<value>
+  let generation = 0;          // bumped by clear() so late loads are dropped
+  const counters = { hits: 0, staleHits: 0, misses: 0, coalesced: 0, refreshes: 0, errors: 0 };
+
+  function load(key, loader) {
+    const existing = inflight.get(key);
+    if (existing) return { pending: existing, joined: true };
+
+    const gen = generation;
+    const pending = Promise.resolve()
+      .then(loader)
+      .then((value) => {
+        if (gen === generation && shouldCache(value)) entries.set(key, { value, ts: Date.now() });
+        return value;
+      })
+      .catch((err) => {
+        counters.errors++;
+        throw err;
+      })
+      .finally(() => {
+        if (inflight.get(key) === pending) inflight.delete(key);
+      });
+    inflight.set(key, pending);
+    return { pending, joined: false };
+  }
+
+  return {
+    /**
+     * Get a value, loading it through `loader` when needed.
+     * @returns {Promise<{ value: any, source: 'hit'|'stale'|'miss'|'coalesced' }>}
+     */
+    async get(key, loader) {
+      const entry = entries.get(key);
+      const age = entry ? Date.now() - entry.ts : Infinity;
+
+      if (age < ttlMs) {
+        counters.hits++;
+        return { value: entry.value, source: 'hit' };
+      }
+
+      if (age < ttlMs + staleMs) {
+        counters.staleHits++;
+        const { pending, joined } = load(key, loader);
+        if (!joined) counters.refreshes++;
+        pending.catch(() => {});
+        return { value: entry.value, source: 'stale' };
+      }
+
+      const { pending, joined } = load(key, loader);
+      if (joined) counters.coalesced++;
+      else counters.misses++;
+      return { value: await pending, source: joined ? 'coalesced' : 'miss' };
+    },
+
+    /** Drop all entries; in-flight loads still settle but are not stored. */
+    clear() {
+      entries.clear();
+      inflight.clear();
+      generation++;
+    },
+
+    /** Cumulative counters plus current sizes. */
+    stats() {
+      return { ...counters, entries: entries.size, inflight: inflight.size };
+    },
+  };
+}
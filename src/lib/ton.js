@@ -1,8 +1,14 @@
 import { TonClient } from '@ton/ton';
 import { Address, fromNano } from '@ton/core';
+import { AsyncLocalStorage } from 'async_hooks';
 import { readClientConf, getApiKey } from './config.js';
+import { createScheduler } from './scheduler.js';
+import { createChainWatch } from './chain-watch.js';
+import { createAccountStates } from './account-states.js';
+import { metrics } from './metrics.js';
 
 const DEFAULT_TONCENTER_ENDPOINT = 'https://toncenter.com/api/v2/jsonRPC';
+const ACCOUNT_STATE_TTL_MS = 5000;
 
 const sleep = (ms) => new Promise(r => setTimeout(r, ms));
 
@@ -36,26 +42,239 @@ export function getCachedTonClient() {
   return _cachedClient;
 }
 
+/** Drop the cached client and resize the scheduler (API key changed). */
 export function clearTonClientCache() {
   _cachedClient = null;
+  _scheduler?.configure({ ratePerSec: getToncenterRps() });
+}
+
+// ── Scheduler ───────────────────────────────────────────────
+
+// Toncenter limits per API key: 1 rps without a key, 10 rps on the free tier
+const DEFAULT_RPS_NO_KEY = 1;
+const DEFAULT_RPS_WITH_KEY = 10;
+
+const queueDepth = metrics.gauge('cocoon_toncenter_queue_depth', 'Toncenter calls waiting for a rate-limit token');
+const waitSeconds = metrics.histogram('cocoon_toncenter_wait_seconds',
+  'Time Toncenter calls waited for a rate-limit token', [0.01, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30]);
+const toncenterRequests = metrics.counter('cocoon_toncenter_requests_total', 'Toncenter calls by result');
+
+const priorityContext = new AsyncLocalStorage();
+let _scheduler = null;
+
+/**
+ * Requests per second for the configured key: `toncenter_rps` in
+ * client.conf, else the tier default for whether a key is set.
+ */
+export function getToncenterRps() {
+  try {
+    const rps = parseFloat(readClientConf()?.toncenter_rps);
+    if (rps > 0) return rps;
+  } catch {}
+  return getApiKey() ? DEFAULT_RPS_WITH_KEY : DEFAULT_RPS_NO_KEY;
+}
+
+/** The process-wide scheduler every Toncenter call (v2 and v3) goes through. */
+export function getToncenterScheduler() {
+  if (!_scheduler) {
+    _scheduler = createScheduler({
+      ratePerSec: getToncenterRps(),
+      onWait: (priority, ms) => waitSeconds.observe({ priority }, ms / 1000),
+    });
+    metrics.addCollector(() => {
+      for (const [priority, n] of Object.entries(_scheduler.depth())) queueDepth.set({ priority }, n);
+      toncenterRequests.set({ result: 'deduped' }, _scheduler.stats().deduped);
+    });
+  }
+  return _scheduler;
+}
+
+/**
+ * Run `fn` with every Toncenter call inside it scheduled as user-initiated
+ * (ahead of background refreshes).
+ */
+export function asUserRequest(fn) {
+  return priorityContext.run('user', fn);
 }
 
 // ── Retry ───────────────────────────────────────────────────
 
 /**
- * Retry a function with exponential backoff on 429 errors.
+ * Run a Toncenter call through the shared scheduler, retrying on 429.
+ * A 429 pauses the scheduler for everyone (2s, 4s, 6s, 8s, 10s).
+ *
+ * @param {() => Promise<T>} fn
+ * @param {number} [maxRetries=5]
+ * @param {object} [opts]
+ * @param {string} [opts.key] - identical in-flight calls share one request
+ * @param {'user' | 'background'} [opts.priority] - default: asUserRequest() context, else background
+ * @returns {Promise<T>}
+ * @template T
  */
-export async function withRetry(fn, maxRetries = 5) {
-  for (let i = 0; i < maxRetries; i++) {
-    try {
-      return await fn();
-    } catch (err) {
-      const is429 = err?.response?.status === 429 || err?.status === 429 || err?.message?.includes('429');
-      if (!is429 || i === maxRetries - 1) throw err;
-      const delay = (i + 1) * 2000; // 2s, 4s, 6s, 8s, 10s
-      await new Promise(r => setTimeout(r, delay));
+export async function withRetry(fn, maxRetries = 5, opts = {}) {
+  const scheduler = getToncenterScheduler();
+  const priority = opts.priority ?? priorityContext.getStore() ?? 'background';
+
+  return scheduler.dedupe(opts.key, async () => {
+    for (let i = 0; i < maxRetries; i++) {
+      await scheduler.take(priority);
+      try {
+        const result = await fn();
+        toncenterRequests.inc({ result: 'ok' });
+        return result;
+      } catch (err) {
+        const is429 = err?.response?.status === 429 || err?.status === 429 || err?.message?.includes('429');
+        toncenterRequests.inc({ result: is429 ? 'rate_limited' : 'error' });
+        if (!is429 || i === maxRetries - 1) throw err;
+        scheduler.pause((i + 1) * 2000);
+      }
     }
+  });
+}
+
+// ── Chain watch ─────────────────────────────────────────────
+
+let _chainWatch = null;
+
+/**
+ * The process-wide chain watcher (see chain-watch.js): one block-aligned
+ * loop shared by every confirmation waiter.
+ */
+export function getChainWatch() {
+  if (!_chainWatch) {
+    _chainWatch = createChainWatch({
+      getMasterchainSeqno: () => withRetry(
+        () => getCachedTonClient().getMasterchainInfo(), 5, { key: 'masterchain' },
+      ).then(info => info.latestSeqno),
+      // Watched addresses refreshed on the same block share one batched read
+      getAccountState: async (address) => {
+        const [state] = await getAccountStates([address], { maxAgeMs: 0 });
+        return { lt: state.lastTransactionLt, balance: state.balance };
+      },
+    });
+  }
+  return _chainWatch;
+}
+
+// ── Account states ──────────────────────────────────────────
+
+/** Toncenter v3 base matching the configured v2 endpoint (testnet stays testnet). */
+function getV3Base() {
+  const endpoint = getEndpoint() || DEFAULT_TONCENTER_ENDPOINT;
+  return endpoint.replace(/\/api\/v2(\/jsonRPC)?\/?$/, '/api/v3');
+}
+
+/** Raw (`0:<hex>`) form of a friendly or raw address; throws on a malformed one. */
+export const rawAddress = (address) => Address.parse(address).toRawString();
+
+/** One v3 walletStates round trip for every address. */
+async function fetchWalletStates(keys) {
+  const url = new URL(`${getV3Base()}/walletStates`);
+  for (const key of keys) url.searchParams.append('address', key);
+  const apiKey = getApiKey();
+  if (apiKey) url.searchParams.set('api_key', apiKey);
+  const body = await withRetry(async () => {
+    const res = await fetch(url.toString(), { signal: AbortSignal.timeout(15000) });
+    if (!res.ok) throw Object.assign(new Error(`Toncenter API error: ${res.status}`), { status: res.status });
+    return res.json();
+  }, 5, { key: `walletStates:${keys.join(',')}` });
+  const states = new Map();
+  for (const w of body.wallets ?? []) {
+    const key = rawAddress(w.address);
+    states.set(key, {
+      address: key,
+      balance: BigInt(w.balance ?? 0),
+      seqno: w.seqno ?? null,
+      status: w.status ?? 'active',
+      lastTransactionLt: w.last_transaction_lt ?? null,
+    });
+  }
+  return states;
+}
+
+/** Per-address v2 reads, for endpoints without v3. */
+async function fetchContractStates(keys) {
+  const client = getCachedTonClient();
+  const states = new Map();
+  await Promise.all(keys.map(async (key) => {
+    const state = await withRetry(() => client.getContractState(Address.parse(key)), 5, { key: `state:${key}` });
+    states.set(key, {
+      address: key,
+      balance: state.balance,
+      seqno: null,
+      status: state.state === 'uninitialized' ? 'uninit' : state.state,
+      lastTransactionLt: state.lastTransaction?.lt ?? null,
+    });
+  }));
+  return states;
+}
+
+let _accountStates = null;
+// Set once the endpoint answers walletStates with 404 / not implemented
+let v3Unsupported = false;
+
+/** Statuses meaning "this endpoint has no walletStates", not a Toncenter outage. */
+const isUnsupported = (err) => [404, 405, 501].includes(err?.status);
+
+function accountStates() {
+  if (!_accountStates) {
+    _accountStates = createAccountStates({
+      normalize: rawAddress,
+      ttlMs: ACCOUNT_STATE_TTL_MS,
+      fetchMany: async (keys) => {
+        if (v3Unsupported) return fetchContractStates(keys);
+        let states;
+        try {
+          states = await fetchWalletStates(keys);
+        } catch (err) {
+          // Other errors (outage, 429 after retries) fail the batch instead of doubling its retries on v2
+          if (!isUnsupported(err)) throw err;
+          v3Unsupported = true;
+          return fetchContractStates(keys);
+        }
+        // The indexer omits addresses it has not seen yet: ask v2 rather than assume they are empty
+        const missing = keys.filter(k => !states.has(k));
+        if (missing.length) {
+          for (const [key, state] of await fetchContractStates(missing)) states.set(key, state);
+        }
+        return states;
+      },
+    });
   }
+  return _accountStates;
+}
+
+/**
+ * Current state of one address straight from v2 (the liteserver), not the
+ * v3 indexer, which can lag a few blocks behind: amounts to send and
+ * settlement baselines are computed from this.
+ * @param {string} address - raw or friendly TON address
+ * @returns {Promise<import('./account-states.js').AccountState>}
+ */
+export async function readAccountState(address) {
+  const key = rawAddress(address);
+  const states = await fetchContractStates([key]);
+  return { ...states.get(key), address };
+}
+
+/**
+ * Balance, seqno and status of several addresses in one Toncenter round
+ * trip (v3 walletStates; per-address v2 reads for addresses the indexer
+ * does not know yet, or for endpoints without v3). Lookups made in the
+ * same tick are batched together; states are cached 5s. Amounts to send
+ * are computed from readAccountState() instead.
+ * @param {string[]} addresses - raw or friendly TON addresses
+ * @param {object} [opts]
+ * @param {number} [opts.maxAgeMs] - 0 to force a fresh read
+ * @returns {Promise<import('./account-states.js').AccountState[]>} in the order given
+ */
+export function getAccountStates(addresses, opts) {
+  return accountStates().get(addresses, opts);
+}
+
+/** Drop cached states of addresses a transaction was just sent from or to. */
+export function invalidateAccountStates(addresses) {
+  accountStates().invalidate(addresses.filter(Boolean).map(String));
 }
 
 // ── Balance ─────────────────────────────────────────────────
@@ -63,56 +282,66 @@ export async function withRetry(fn, maxRetries = 5) {
 /**
  * Get balance for a TON address.
  * @param {string} address - raw or friendly TON address
- * @param {TonClient} [client] - optional TonClient instance; uses cached singleton if omitted
+ * @param {TonClient} [client] - query this client directly; otherwise the batched, cached state lookup is used
  * @returns {Promise<{ nano: bigint, ton: string }>}
  */
 export async function getBalance(address, client) {
-  if (!client) client = getCachedTonClient();
+  if (!client) {
+    const [state] = await getAccountStates([address]);
+    return { nano: state.balance, ton: fromNano(state.balance) };
+  }
   const addr = Address.parse(address);
-  const nano = await withRetry(() => client.getBalance(addr));
+  const nano = await withRetry(() => client.getBalance(addr), 5, { key: `balance:${addr.toRawString()}` });
   return { nano, ton: fromNano(nano) };
 }
 
 /**
- * Poll until balance reaches a minimum threshold.
+ * Wait until balance reaches a minimum threshold. Re-checked on every
+ * transaction to the address (chain watch) rather than on a fixed poll.
  * @param {string} address
  * @param {bigint} minNano - minimum balance in nanoTON
  * @param {object} opts
  * @param {(bal: {nano: bigint, ton: string}) => void} [opts.onUpdate]
  * @param {number} [opts.timeoutMs=600000] - 10 min default
- * @param {number} [opts.intervalMs=5000]
+ * @param {number} [opts.intervalMs=30000] - fallback re-check interval
  * @returns {Promise<{ nano: bigint, ton: string } | null>} null on timeout
  */
 export async function waitForBalance(address, minNano, opts = {}) {
-  const { onUpdate, timeoutMs = 600_000, intervalMs = 5_000 } = opts;
-  const deadline = Date.now() + timeoutMs;
-
-  while (Date.now() < deadline) {
-    try {
-      const bal = await getBalance(address);
-      if (onUpdate) onUpdate(bal);
-      if (bal.nano >= minNano) return bal;
-    } catch {
-      // Network errors are transient — just retry
-    }
-    await new Promise(r => setTimeout(r, intervalMs));
-  }
-  return null;
+  const { onUpdate, timeoutMs = 600_000, intervalMs = 30_000 } = opts;
+  return getChainWatch().waitFor(address, async (state) => {
+    // The watcher already read the balance with the new lt; only fetch on the first / fallback check
+    const nano = state ? state.balance : (await readAccountState(address)).balance;
+    const bal = { nano, ton: fromNano(nano) };
+    if (onUpdate) onUpdate(bal);
+    return bal.nano >= minNano ? bal : null;
+  }, { timeoutMs, fallbackMs: intervalMs });
 }
 
 // ── Seqno ───────────────────────────────────────────────────
 
 /**
- * Poll for a seqno change on a contract. Works for both cocoon wallet
+ * Wait for a seqno change on a contract. Works for both cocoon wallet
  * (client.runMethod) and owner wallet (contract.getSeqno) via getSeqnoFn.
  *
+ * With `opts.address` the seqno is only re-read when that address gets a
+ * new transaction (chain watch); without it, it is polled.
+ *
  * @param {Function} getSeqnoFn - async function returning the current seqno number
  * @param {number} oldSeqno - the seqno before the transaction was sent
- * @param {object} [opts] - { iterations: 20, intervalMs: 3000 }
+ * @param {object} [opts] - { address, timeoutMs: 60000 } or, polling: { iterations: 20, intervalMs: 3000 }
  * @returns {Promise<boolean>} true if seqno changed, false on timeout
  */
 export async function waitForSeqnoChange(getSeqnoFn, oldSeqno, opts = {}) {
-  const { iterations = 20, intervalMs = 3000 } = opts;
+  const { address, iterations = 20, intervalMs = 3000 } = opts;
+  if (address) {
+    const { timeoutMs = iterations * intervalMs } = opts;
+    const changed = await getChainWatch().waitFor(
+      typeof address === 'string' ? address : address.toString(),
+      async () => (await getSeqnoFn()) > oldSeqno,
+      { timeoutMs, fallbackMs: 15_000 },
+    );
+    return !!changed;
+  }
   for (let i = 0; i < iterations; i++) {
     await sleep(intervalMs);
     try {
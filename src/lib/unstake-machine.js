@@ -0,0 +1,235 @@
+/**
+ * Unstake as a resumable state machine.
+ *
+ * Every proxy in `stats.proxies` moves through
+ *   active → close_sent → closed → withdraw_sent → settled
+ * independently and in parallel; once all are past withdraw, the node
+ * wallet is drained to the owner wallet (transfer: pending → sent →
+ * confirmed). The run object is saved after every step, so a new process
+ * picks up where the last one stopped instead of re-sending requests.
+ *
+ * Pure: chain / client-runner access comes in through `ops` and
+ * persistence through `save` (see services/unstake.js).
+ */
+
+// Smart contract states from ClientProxyInfo
+export const SC_STATE = { ACTIVE: 0, CLOSING: 1, CLOSED: 2 };
+
+export const PROXY_STEPS = ['active', 'close_sent', 'closed', 'withdraw_sent', 'settled'];
+
+// Withdrawn escrow is counted as landed once the node wallet holds the
+// baseline plus every withdrawal, less this much per proxy for the close
+// and withdraw message fees the node wallet paid meanwhile
+const WITHDRAW_FEE_MARGIN_NANO = 100_000_000n;
+
+/** Escrow a proxy should return on withdraw (nano, as a string). */
+function escrowOf(proxy) {
+  return String(BigInt(Math.trunc(proxy.tokens_payed || 0)));
+}
+
+/** Node wallet balance at which the withdrawals of `proxies` have landed. */
+export function fundsLandedNano(baselineNano, proxies) {
+  const expected = proxies.reduce((sum, p) => sum + BigInt(p.expectedNano ?? '0'), 0n);
+  const margin = WITHDRAW_FEE_MARGIN_NANO * BigInt(proxies.length);
+  // Escrow below the fees still has to lift the balance off the baseline
+  return BigInt(baselineNano) + (expected > margin ? expected - margin : 1n);
+}
+
+function stepOfState(proxy) {
+  if (proxy.state === SC_STATE.CLOSED) return 'closed';
+  if (proxy.state === SC_STATE.CLOSING) return 'close_sent';
+  return 'active';
+}
+
+/** Proxies worth unstaking: anything not active, or active with escrow. */
+export function unstakeableProxies(stats) {
+  return (stats?.proxies || []).filter(p =>
+    p.proxy_sc_address && ((p.state ?? SC_STATE.ACTIVE) !== SC_STATE.ACTIVE || (p.tokens_payed || 0) > 0));
+}
+
+/**
+ * A fresh run for the proxies currently reported by jsonstats.
+ * @param {object[]} proxies - from unstakeableProxies()
+ * @param {bigint} baselineNano - node wallet balance before any withdraw lands
+ */
+export function createRun(proxies, baselineNano) {
+  const now = Date.now();
+  return {
+    id: now.toString(36),
+    status: 'running',
+    startedAt: now,
+    updatedAt: now,
+    completedAt: null,
+    error: null,
+    baselineNano: String(baselineNano),
+    proxies: proxies.map(p => ({
+      address: p.proxy_sc_address,
+      step: stepOfState(p),
+      expectedNano: escrowOf(p),
+      enteredAt: now,
+      timings: {},
+      error: null,
+    })),
+    transfer: { step: 'pending', seqno: null, enteredAt: now, timings: {} },
+  };
+}
+
+/**
+ * Bring a saved run up to date with what jsonstats reports now, before
+ * resuming it: proxies staked since the run started are added, proxies no
+ * longer reported are settled (a removed contract refunded on its own),
+ * proxies further along on-chain than recorded skip ahead, and the escrow
+ * expected from proxies not yet withdrawn is refreshed. New
+ * proxies are left for the next run once the transfer was sent, since
+ * their funds would arrive after it.
+ * @param {object} run - a saved run (modified in place)
+ * @param {object} stats - current jsonstats
+ * @returns {{ added: string[], removed: string[], deferred: string[] }}
+ */
+export function reconcileRun(run, stats) {
+  const now = Date.now();
+  const current = new Map((stats?.proxies || []).filter(p => p.proxy_sc_address).map(p => [p.proxy_sc_address, p]));
+  const result = { added: [], removed: [], deferred: [] };
+
+  for (const p of run.proxies) {
+    if (p.step === 'settled' || p.step === 'withdraw_sent') continue;
+    const live = current.get(p.address);
+    const step = live ? stepOfState(live) : 'settled';
+    if (!live) result.removed.push(p.address);
+    else p.expectedNano = escrowOf(live);
+    if (PROXY_STEPS.indexOf(step) > PROXY_STEPS.indexOf(p.step)) {
+      p.step = step;
+      p.enteredAt = now;
+      p.error = null;
+    }
+  }
+
+  const known = new Set(run.proxies.map(p => p.address));
+  for (const p of unstakeableProxies(stats)) {
+    if (known.has(p.proxy_sc_address)) continue;
+    if (run.transfer.step !== 'pending') {
+      result.deferred.push(p.proxy_sc_address);
+      continue;
+    }
+    run.proxies.push({
+      address: p.proxy_sc_address, step: stepOfState(p), expectedNano: escrowOf(p), enteredAt: now, timings: {}, error: null,
+    });
+    result.added.push(p.proxy_sc_address);
+  }
+  run.updatedAt = now;
+  return result;
+}
+
+/** Coarse step for the WebUI: closing → withdrawing → transferring → done. */
+export function overallStep(run) {
+  if (!run) return null;
+  if (run.status === 'done') return 'done';
+  const before = (step) => run.proxies.some(p => PROXY_STEPS.indexOf(p.step) < PROXY_STEPS.indexOf(step));
+  if (before('closed')) return 'closing';
+  if (before('withdraw_sent')) return 'withdrawing';
+  return 'transferring';
+}
+
+/**
+ * Drive a run to completion (or to the first step that cannot finish yet).
+ *
+ * @param {object} run - from createRun() or a saved run
+ * @param {object} ops
+ * @param {(action: 'close' | 'withdraw', proxy: string) => Promise<{ ok: boolean, message: string }>} ops.request
+ * @param {(proxy: string) => Promise<{ removed?: boolean } | null>} ops.waitClosed
+ * @param {(minNano: bigint) => Promise<unknown>} ops.waitFunds
+ * @param {() => Promise<{ seqno: number } | null>} ops.transfer - null: nothing to transfer
+ * @param {(seqno: number) => Promise<boolean>} ops.waitTransfer
+ * @param {object} [hooks]
+ * @param {(run: object) => void} [hooks.save]
+ * @param {(event: { target: string, step: string, ms: number }) => void} [hooks.onStep]
+ * @returns {Promise<object>} the run, status 'done' or 'failed'
+ */
+export async function driveRun(run, ops, { save = () => {}, onStep } = {}) {
+  const mark = (item, target, step) => {
+    const now = Date.now();
+    const ms = now - item.enteredAt;
+    item.step = step;
+    item.timings[step] = ms;
+    item.enteredAt = now;
+    run.updatedAt = now;
+    save(run);
+    onStep?.({ target, step, ms });
+  };
+
+  async function driveProxy(p) {
+    if (p.step === 'active') {
+      const r = await ops.request('close', p.address);
+      if (!r.ok) throw new Error(`close: ${r.message}`);
+      mark(p, p.address, 'close_sent');
+    }
+    if (p.step === 'close_sent') {
+      const closed = await ops.waitClosed(p.address);
+      if (!closed) throw new Error('contract not closed yet, run unstake again to resume');
+      // A removed proxy refunded automatically: nothing to withdraw
+      mark(p, p.address, closed.removed ? 'settled' : 'closed');
+    }
+    if (p.step === 'closed') {
+      const r = await ops.request('withdraw', p.address);
+      if (!r.ok && !r.message.includes('proxy not found')) throw new Error(`withdraw: ${r.message}`);
+      mark(p, p.address, r.ok ? 'withdraw_sent' : 'settled');
+    }
+  }
+
+  run.status = 'running';
+  run.error = null;
+  save(run);
+  const results = await Promise.allSettled(run.proxies.map(async (p) => {
+    p.error = null;
+    try {
+      await driveProxy(p);
+    } catch (err) {
+      p.error = err.message;
+      throw err;
+    }
+  }));
+  const failed = results.filter(r => r.status === 'rejected');
+  if (failed.length) {
+    run.status = 'failed';
+    run.error = failed.map(r => r.reason.message).join('; ');
+    save(run);
+    return run;
+  }
+
+  try {
+    const t = run.transfer;
+    if (t.step === 'pending') {
+      const withdrawing = run.proxies.filter(p => p.step === 'withdraw_sent');
+      if (withdrawing.length) {
+        // Timing out here is not fatal: transfer whatever has arrived
+        await ops.waitFunds(fundsLandedNano(run.baselineNano, withdrawing));
+        for (const p of withdrawing) mark(p, p.address, 'settled');
+      }
+      const sent = await ops.transfer();
+      if (sent) {
+        t.seqno = sent.seqno;
+        mark(t, 'transfer', 'sent');
+      } else {
+        mark(t, 'transfer', 'skipped');
+      }
+    }
+    if (t.step === 'sent' && !(await ops.waitTransfer(t.seqno))) {
+      // Stays resumable: the next pass only re-checks the confirmation
+      run.status = 'failed';
+      run.error = 'transfer unconfirmed, run unstake again to re-check';
+      save(run);
+      return run;
+    }
+    if (t.step === 'sent') mark(t, 'transfer', 'confirmed');
+  } catch (err) {
+    run.status = 'failed';
+    run.error = `transfer: ${err.message}`;
+    save(run);
+    return run;
+  }
+
+  run.status = 'done';
+  run.completedAt = Date.now();
+  save(run);
+  return run;
+}
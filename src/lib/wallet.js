@@ -1,8 +1,9 @@
-import { mnemonicNew, mnemonicToPrivateKey, keyPairFromSeed } from '@ton/crypto';
+import { mnemonicNew, keyPairFromSeed } from '@ton/crypto';
 import { WalletContractV4 } from '@ton/ton';
 import { execFileSync } from 'child_process';
 import { existsSync } from 'fs';
 import { PATHS } from './config.js';
+import { getMnemonicKeys } from './key-cache.js';
 
 /**
  * Generate a full COCOON wallet:
@@ -16,7 +17,7 @@ import { PATHS } from './config.js';
 export async function generateWallet() {
   // 1. Owner wallet — mnemonic + WalletV4R2
   const mnemonic = await mnemonicNew(24);
-  const ownerKeys = await mnemonicToPrivateKey(mnemonic);
+  const ownerKeys = await getMnemonicKeys(mnemonic);
 
   const ownerWallet = WalletContractV4.create({
     workchain: 0,
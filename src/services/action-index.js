@@ -0,0 +1,235 @@
+/**
+ * Local, append-only index of an account's cocoon actions, keyed by
+ * logical time.
+ *
+ * Actions are appended to `.cocoon-state/actions/<account>.jsonl` and
+ * synced newest first: the first sync seeds the index with the latest
+ * page, and older pages are backfilled behind it on later syncs, so
+ * history always starts at the present. Ranges still to be fetched are
+ * kept in `<account>.meta.json`; until they are done, `complete()` is
+ * false and earnings cover only what is indexed.
+ *
+ * The Toncenter side is injected (`fetchPage`), which keeps this testable.
+ */
+
+import { existsSync, mkdirSync, readFileSync, appendFileSync, writeFileSync, renameSync } from 'fs';
+import { resolve } from 'path';
+import { STATE_ROOT } from '../lib/state-dir.js';
+
+export const PAGE_SIZE = 100;
+const MAX_PAGES_PER_SYNC = 20;     // backfill resumes on the next sync
+const MIN_SYNC_INTERVAL_MS = 30_000;
+
+/** Compact stored form of a Toncenter v3 action. */
+export function toEntry(action) {
+  return {
+    id: action.action_id,
+    lt: String(action.start_lt ?? action.end_lt ?? '0'),
+    type: action.type,
+    success: action.success,
+    timestamp: action.end_utime,
+    details: action.details || {},
+    traceId: action.trace_id,
+  };
+}
+
+/** Order by (lt, id): actions of one transaction share an lt. */
+function compare(a, b) {
+  const la = BigInt(a.lt);
+  const lb = BigInt(b.lt);
+  if (la !== lb) return la < lb ? -1 : 1;
+  return a.id < b.id ? -1 : a.id > b.id ? 1 : 0;
+}
+
+function fileFor(root, account, ext) {
+  return resolve(root, 'actions', `${account.replace(/[^A-Za-z0-9_-]/g, '_')}.${ext}`);
+}
+
+/**
+ * @param {object} opts
+ * @param {string} opts.account
+ * @param {(q: { beforeLt: string | null, limit: number }) => Promise<object[]>} opts.fetchPage
+ *   raw actions with lt <= beforeLt (any lt when null), newest first
+ * @param {(entry: object) => boolean} opts.isPayout
+ * @param {string} [opts.root=STATE_ROOT]
+ * @param {number} [opts.minSyncIntervalMs]
+ */
+export function createActionIndex(opts) {
+  const {
+    account, fetchPage, isPayout, root = STATE_ROOT, minSyncIntervalMs = MIN_SYNC_INTERVAL_MS,
+  } = opts;
+  const path = fileFor(root, account, 'jsonl');
+  const metaPath = fileFor(root, account, 'meta.json');
+  const entries = [];          // ascending (lt, id)
+  const ids = new Set();
+  let head = null;             // highest lt indexed (string)
+  // Ranges still to fetch, newest first: actions with lt <= fromLt down to
+  // (not including) downToLt; downToLt null = to the start of the account
+  let pending = [];
+  let seeded = false;          // the newest page has been fetched once
+  let payoutNano = 0n;
+  let payoutCount = 0;
+  let syncing = null;
+  let syncedAt = 0;
+
+  function add(entry) {
+    if (!entry.id || ids.has(entry.id)) return false;
+    ids.add(entry.id);
+    entries.push(entry);
+    if (head === null || BigInt(entry.lt) > BigInt(head)) head = entry.lt;
+    if (isPayout(entry) && entry.success !== false) {
+      payoutNano += BigInt(entry.details?.amount || '0');
+      payoutCount++;
+    }
+    return true;
+  }
+
+  // Load what earlier runs indexed (a torn last line is skipped)
+  if (existsSync(path)) {
+    for (const line of readFileSync(path, 'utf-8').split('\n')) {
+      if (!line) continue;
+      try { add(JSON.parse(line)); } catch {}
+    }
+    entries.sort(compare);
+  }
+  if (existsSync(metaPath)) {
+    try {
+      ({ pending, seeded } = JSON.parse(readFileSync(metaPath, 'utf-8')));
+    } catch {}
+  } else if (entries.length > 0) {
+    // Indexes without a meta file were synced oldest first from the start
+    seeded = true;
+  }
+
+  function persist(batch) {
+    const dir = resolve(path, '..');
+    if (!existsSync(dir)) mkdirSync(dir, { recursive: true, mode: 0o700 });
+    if (batch.length > 0) {
+      appendFileSync(path, batch.map(e => JSON.stringify(e)).join('\n') + '\n', { mode: 0o600 });
+    }
+    const tmp = `${metaPath}.tmp`;
+    writeFileSync(tmp, JSON.stringify({ seeded, pending }) + '\n', { mode: 0o600 });
+    renameSync(tmp, metaPath);
+  }
+
+  /**
+   * Fetch newest first from `fromLt` until an action at or below
+   * `downToLt` shows up, the account's first action is reached, or the
+   * page budget runs out.
+   * @returns {{ lowest: string | null, done: boolean }}
+   */
+  async function walk(fromLt, downToLt, budget) {
+    let beforeLt = fromLt;
+    let lowest = null;
+    while (budget.pages > 0) {
+      budget.pages--;
+      const raw = await fetchPage({ beforeLt, limit: PAGE_SIZE });
+      const page = raw.map(toEntry);
+      const fresh = page.filter(add);
+      budget.added.push(...fresh);
+      if (page.length === 0) return { lowest, done: true };
+      const last = page[page.length - 1].lt;
+      lowest = last;
+      if (raw.length < PAGE_SIZE) return { lowest, done: true };
+      if (downToLt !== null && BigInt(last) <= BigInt(downToLt)) return { lowest, done: true };
+      // The bound is inclusive so actions sharing the boundary lt are not
+      // skipped; a full page of one lt can't advance, so step past it
+      beforeLt = fresh.length === 0 && last === beforeLt ? String(BigInt(last) - 1n) : last;
+    }
+    return { lowest: beforeLt, done: false };
+  }
+
+  async function runSync() {
+    const budget = { pages: MAX_PAGES_PER_SYNC, added: [] };
+    try {
+      // New actions first, so the head of history is current
+      const previousHead = head;
+      const top = await walk(null, seeded ? previousHead : null, budget);
+      if (!seeded) {
+        seeded = true;
+        if (!top.done) pending.push({ fromLt: top.lowest, downToLt: null });
+      } else if (!top.done) {
+        // More new actions than one sync takes: fill the gap before backfilling
+        pending.unshift({ fromLt: top.lowest, downToLt: previousHead });
+      }
+      while (pending.length > 0 && budget.pages > 0) {
+        const range = pending[0];
+        const step = await walk(range.fromLt, range.downToLt, budget);
+        if (step.done) pending.shift();
+        else range.fromLt = step.lowest;
+      }
+    } finally {
+      if (budget.added.length > 0) entries.sort(compare);
+      persist(budget.added);
+    }
+    syncedAt = Date.now();
+  }
+
+  return {
+    /**
+     * Pull new actions, then continue any backfill. Concurrent calls share
+     * one sync; without `force` a sync younger than minSyncIntervalMs is
+     * reused.
+     */
+    sync({ force = false } = {}) {
+      if (syncing) return syncing;
+      if (!force && Date.now() - syncedAt < minSyncIntervalMs) return Promise.resolve();
+      syncing = runSync().finally(() => { syncing = null; });
+      return syncing;
+    },
+
+    /** True once the whole account history is indexed. */
+    complete() {
+      return seeded && pending.length === 0;
+    },
+
+    /**
+     * Newest first.
+     * @param {object} [q]
+     * @param {number} [q.limit=20]
+     * @param {string} [q.beforeLt] - page cursor: only actions ordered before (beforeLt, beforeId)
+     * @param {string} [q.beforeId] - without it, only actions with a lower lt
+     * @param {string[]} [q.types] - filter by action type
+     */
+    history({ limit = 20, beforeLt, beforeId, types } = {}) {
+      const page = [];
+      let i = entries.length - 1;
+      if (beforeLt != null) {
+        // Binary search: last entry ordered before the cursor
+        const cursor = { lt: beforeLt, id: beforeId ?? '' };
+        let lo = 0, hi = entries.length;
+        while (lo < hi) {
+          const mid = (lo + hi) >> 1;
+          if (compare(entries[mid], cursor) < 0) lo = mid + 1; else hi = mid;
+        }
+        i = lo - 1;
+      }
+      for (; i >= 0 && page.length < limit; i--) {
+        if (!types || types.includes(entries[i].type)) page.push(entries[i]);
+      }
+      return page;
+    },
+
+    /** Payout total over every indexed action, plus the newest `limit` payouts. */
+    earnings({ limit = 50 } = {}) {
+      const payouts = [];
+      for (let i = entries.length - 1; i >= 0 && payouts.length < limit; i--) {
+        const e = entries[i];
+        if (isPayout(e) && e.success !== false) payouts.push(e);
+      }
+      return { payouts, totalNano: payoutNano.toString(), count: payoutCount };
+    },
+
+    /** Newest action matching `pred`, or null. */
+    find(pred) {
+      for (let i = entries.length - 1; i >= 0; i--) {
+        if (pred(entries[i])) return entries[i];
+      }
+      return null;
+    },
+
+    stats() {
+      return { account, entries: entries.length, head, pending: pending.length, syncedAt };
+    },
+  };
+}
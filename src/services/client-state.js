@@ -1,64 +1,307 @@
 /**
  * Shared client state — exposes the running status and HTTP port
- * of the COCOON client process so that any module (routes, services)
+ * of the COCOON client process(es) so that any module (routes, services)
  * can query it without importing a route module.
  *
  * The route handler in api/routes/client.js owns the actual process
  * lifecycle and calls `setClientState` / `clearClientState` here.
+ *
+ * In pool mode several client-runner instances run side by side, each on
+ * its own port block (see getRuntimeVars). Every instance is tracked here
+ * with its in-flight request count and the state of each of its proxy
+ * connections, so the proxy layer can pick the least loaded one.
+ *
+ * Each instance also moves through a small phase machine:
+ *
+ *   starting → handshaking → ready ⇄ degraded
+ *
+ * - starting:    processes spawned, binary not listening yet
+ * - handshaking: proxy connection(s) being established — the binary is
+ *                fragile here (no /jsonstats, no persistent sockets)
+ * - ready:       every proxy connection finished its handshake
+ * - degraded:    usable (at least one connection up), but another one
+ *                dropped or is still handshaking
+ *
+ * "stopped" is the phase of an instance that is not tracked at all.
+ * Listeners registered with onPhaseChange are told about every transition.
  */
 
+export const PHASES = ['stopped', 'starting', 'handshaking', 'ready', 'degraded'];
+
+// Allowed transitions (anything can go to stopped via clearClientState)
+const TRANSITIONS = {
+  starting: ['handshaking', 'ready', 'degraded'],
+  handshaking: ['ready', 'degraded'],
+  ready: ['degraded'],
+  degraded: ['ready'],
+};
+
 const state = {
-  running: false,
-  httpPort: null,
-  startedAt: null,
   defaultVerbosity: '1',
-  proxyReady: false,
+  defaultPoolSize: 1,
+  defaultSupervision: { supervise: false, standby: false },
+  instances: new Map(),  // instance number → { instance, httpPort, startedAt, phase, proxyReady, inFlight, connections, standby, maxCoefficient }
+  phaseListeners: new Set(),
 };
 
-/** Get the HTTP port the client-runner is listening on. */
+/** Move an instance to a new phase if the transition is allowed, and notify listeners. */
+function setPhase(inst, phase) {
+  if (inst.phase === phase || !TRANSITIONS[inst.phase]?.includes(phase)) return false;
+  const prev = inst.phase;
+  inst.phase = phase;
+  inst.proxyReady = phase === 'ready' || phase === 'degraded';
+  notifyPhase(inst, prev);
+  return true;
+}
+
+function notifyPhase(inst, prev) {
+  for (const listener of state.phaseListeners) {
+    try { listener({ instance: inst.instance, httpPort: inst.httpPort, phase: inst.phase, prev }); } catch {}
+  }
+}
+
+/** Whether `a` ranks before `b` as primary: serving before standby, then lowest number. */
+function ranksBefore(a, b) {
+  if (a.standby !== b.standby) return !a.standby;
+  return a.instance < b.instance;
+}
+
+/** Lowest-numbered serving instance (the one single-instance callers see). */
+function primary() {
+  let first = null;
+  for (const inst of state.instances.values()) {
+    if (!first || ranksBefore(inst, first)) first = inst;
+  }
+  return first;
+}
+
+/** Get the HTTP port the (primary) client-runner is listening on. */
 export function getClientPort() {
-  return state.httpPort;
+  return primary()?.httpPort ?? null;
 }
 
-/** Whether the client process is currently running. */
+/** Whether at least one client process is currently running. */
 export function isClientRunning() {
-  return state.running;
+  return state.instances.size > 0;
 }
 
-/** Get the timestamp when the client was started. */
+/** Get the timestamp when the (primary) client was started. */
 export function getClientStartedAt() {
-  return state.startedAt;
+  return primary()?.startedAt ?? null;
 }
 
 /**
- * Mark the client as running.
+ * Mark a client instance as running.
  * Called by the client route handler after a successful launch.
+ * A standby instance is kept warm but only receives traffic when no
+ * serving instance is proxy-ready (see acquireInstance / setStandby).
+ * @param {number} httpPort
+ * @param {number} [instance=0]
+ * @param {{ standby?: boolean, maxCoefficient?: number }} [opts] - maxCoefficient: the
+ *   instance's `max_coefficient` cap (0 = uncapped), for price-hinted routing
  */
-export function setClientState(httpPort) {
-  state.running = true;
-  state.httpPort = httpPort;
-  state.startedAt = Date.now();
+export function setClientState(httpPort, instance = 0, { standby = false, maxCoefficient = 0 } = {}) {
+  const prev = state.instances.get(instance);
+  if (prev) notifyPhase({ ...prev, phase: 'stopped' }, prev.phase);
+  const inst = {
+    instance,
+    httpPort,
+    startedAt: Date.now(),
+    phase: 'starting',
+    proxyReady: false,
+    inFlight: 0,
+    connections: [],
+    standby,
+    maxCoefficient,
+  };
+  state.instances.set(instance, inst);
+  notifyPhase(inst, 'stopped');
 }
 
 /**
- * Mark the client as stopped.
+ * Mark a client instance as stopped (all instances when omitted).
  * Called by the client route handler on teardown.
  */
-export function clearClientState() {
-  state.running = false;
-  state.httpPort = null;
-  state.startedAt = null;
-  state.proxyReady = false;
+export function clearClientState(instance) {
+  const targets = instance === undefined
+    ? [...state.instances.values()]
+    : [state.instances.get(instance)].filter(Boolean);
+  for (const inst of targets) {
+    state.instances.delete(inst.instance);
+    notifyPhase({ ...inst, phase: 'stopped' }, inst.phase);
+  }
 }
 
-/** Mark the proxy handshake as completed — safe to query /jsonstats. */
-export function setProxyReady() {
-  state.proxyReady = true;
+/** Promote a standby instance to serving (failover), or demote one. */
+export function setStandby(instance, standby) {
+  const inst = state.instances.get(instance);
+  if (inst) inst.standby = standby;
 }
 
-/** Whether the proxy handshake has completed. */
-export function isProxyReady() {
-  return state.proxyReady;
+/** Mark an instance as establishing its proxy connection(s). */
+export function setHandshaking(instance) {
+  const inst = state.instances.get(instance);
+  if (inst) setPhase(inst, 'handshaking');
+}
+
+/**
+ * Mark the proxy handshake as completed — safe to query /jsonstats.
+ * Lands in degraded instead of ready while a known connection is still pending.
+ */
+export function setProxyReady(instance = primary()?.instance) {
+  const inst = state.instances.get(instance);
+  if (inst) setPhase(inst, inst.connections.every(c => c.ready) ? 'ready' : 'degraded');
+}
+
+/**
+ * Record the per-connection state of an instance (see lib/connections.js
+ * summarizeConnections). Called by the client route's /jsonstats poller.
+ * A ready instance with a connection that is not ready becomes degraded,
+ * and recovers once every connection is ready again.
+ */
+export function setInstanceConnections(instance, connections) {
+  const inst = state.instances.get(instance);
+  if (!inst) return;
+  inst.connections = connections;
+  if (connections.length === 0) return;
+  const allReady = connections.every(c => c.ready);
+  if (inst.phase === 'ready' && !allReady) setPhase(inst, 'degraded');
+  else if (inst.phase === 'degraded' && allReady) setPhase(inst, 'ready');
+}
+
+/** Phase of one instance ('stopped' when not running). */
+export function getInstancePhase(instance) {
+  return state.instances.get(instance)?.phase ?? 'stopped';
+}
+
+/** Phase of the instance listening on the given HTTP port ('stopped' when none). */
+export function getPhaseForPort(httpPort) {
+  for (const inst of state.instances.values()) {
+    if (inst.httpPort === httpPort) return inst.phase;
+  }
+  return 'stopped';
+}
+
+/** Overall phase: the most advanced phase across instances (ready > degraded > handshaking > starting). */
+export function getClientPhase() {
+  let best = 'stopped';
+  const rank = { stopped: 0, starting: 1, handshaking: 2, degraded: 3, ready: 4 };
+  for (const inst of state.instances.values()) {
+    if (rank[inst.phase] > rank[best]) best = inst.phase;
+  }
+  return best;
+}
+
+/**
+ * Subscribe to phase transitions.
+ * @param {(change: { instance: number, httpPort: number, phase: string, prev: string }) => void} listener
+ * @returns {() => void} unsubscribe
+ */
+export function onPhaseChange(listener) {
+  state.phaseListeners.add(listener);
+  return () => state.phaseListeners.delete(listener);
+}
+
+/** Whether the proxy handshake has completed (on the given instance, or on any). */
+export function isProxyReady(instance) {
+  if (instance !== undefined) return state.instances.get(instance)?.proxyReady === true;
+  for (const inst of state.instances.values()) {
+    if (inst.proxyReady) return true;
+  }
+  return false;
+}
+
+/** HTTP port of the lowest-numbered proxy-ready instance (serving before standby), or null. */
+export function getReadyPort() {
+  let best = null;
+  for (const inst of state.instances.values()) {
+    if (inst.proxyReady && (!best || ranksBefore(inst, best))) best = inst;
+  }
+  return best?.httpPort ?? null;
+}
+
+/** Snapshot of all running instances, ordered by instance number. */
+export function listInstances() {
+  return [...state.instances.values()]
+    .sort((a, b) => a.instance - b.instance)
+    .map(inst => ({
+      ...inst,
+      connections: inst.connections.map(c => ({ ...c })),
+      readyConnections: readyCount(inst),
+    }));
+}
+
+/** Ready proxy connections of an instance (1 assumed until the poller has reported). */
+function readyCount(inst) {
+  if (inst.connections.length === 0) return inst.proxyReady ? 1 : 0;
+  return inst.connections.filter(c => c.ready).length;
+}
+
+/** Load per ready connection — the binary spreads an instance's requests over its connections. */
+function load(inst) {
+  return inst.inFlight / Math.max(1, readyCount(inst));
+}
+
+/**
+ * Routing tier: ready serving (0) → ready standby (1) → serving not ready
+ * yet (2) → standby not ready (3). A standby only takes traffic while no
+ * serving instance is ready, e.g. right after the primary died.
+ */
+function tier(inst) {
+  return (inst.proxyReady ? 0 : 2) + (inst.standby ? 1 : 0);
+}
+
+/**
+ * Lease the instance with the fewest in-flight requests per ready proxy
+ * connection within the best routing tier (see tier()). If no instance is
+ * ready yet, a running one is still used (the binary answers with its own
+ * "not ready" error).
+ *
+ * With `maxInFlight`, instances at that many requests are skipped (null
+ * when all are full). A full serving instance does not spill onto a
+ * standby: standbys only count while no serving instance is ready.
+ * `rank(inst)` (lower first) orders instances of the same tier ahead of
+ * their load, e.g. by measured latency or price (see lib/route-stats.js).
+ *
+ * @param {{ maxInFlight?: number, rank?: (inst: object) => number }} [opts]
+ * @returns {{ instance: number, httpPort: number, release: () => void } | null}
+ */
+export function acquireInstance({ maxInFlight = Infinity, rank = null } = {}) {
+  const servingReady = servingCapacity() > 0;
+  let best = null;
+  let bestRank = 0;
+  for (const inst of state.instances.values()) {
+    if (inst.inFlight >= maxInFlight || (servingReady && inst.standby)) continue;
+    const r = rank ? rank(inst) : 0;
+    if (!best
+      || tier(inst) < tier(best)
+      || (tier(inst) === tier(best) && (r < bestRank || (r === bestRank && load(inst) < load(best))))) {
+      best = inst;
+      bestRank = r;
+    }
+  }
+  if (!best) return null;
+
+  best.inFlight++;
+  let released = false;
+  return {
+    instance: best.instance,
+    httpPort: best.httpPort,
+    release: () => {
+      if (released) return;
+      released = true;
+      best.inFlight = Math.max(0, best.inFlight - 1);
+    },
+  };
+}
+
+/** Number of ready serving (non-standby) instances. */
+export function servingCapacity() {
+  let n = 0;
+  for (const inst of state.instances.values()) {
+    if (inst.proxyReady && !inst.standby) n++;
+  }
+  return n;
 }
 
 /** Set the default verbosity used when starting the client via the API. */
@@ -70,3 +313,23 @@ export function setDefaultVerbosity(level) {
 export function getDefaultVerbosity() {
   return state.defaultVerbosity;
 }
+
+/** Set the default number of instances started via the API (pool mode when > 1). */
+export function setDefaultPoolSize(size) {
+  state.defaultPoolSize = size;
+}
+
+/** Get the default pool size. */
+export function getDefaultPoolSize() {
+  return state.defaultPoolSize;
+}
+
+/** Set whether API-started clients are supervised (auto-restart) and get a warm standby. */
+export function setDefaultSupervision({ supervise = false, standby = false } = {}) {
+  state.defaultSupervision = { supervise: supervise || standby, standby };
+}
+
+/** Get the default supervision settings. */
+export function getDefaultSupervision() {
+  return { ...state.defaultSupervision };
+}
@@ -0,0 +1,105 @@
+/**
+ * Startup history — every client launch is recorded as a trace of phase
+ * timestamps (ms after spawn), and the last MAX_RUNS traces are kept on
+ * disk so restart / failover tuning can use p50/p95 per phase instead of
+ * reading logs by hand.
+ *
+ * Phases (first occurrence only, any may be missing):
+ *   ton_synced, initialized, proxy_connecting, proxy_ready  ← lifecycle lines
+ *   first_seqno, stake_visible                              ← jsonstats tracker
+ *   ready                                                   ← instance usable
+ *
+ * A trace is finished once every phase is reached, or when the instance is
+ * torn down (outcome 'stopped' / 'crashed' with whatever phases it got to).
+ */
+
+import { existsSync, mkdirSync, readFileSync, writeFileSync, renameSync } from 'fs';
+import { resolve } from 'path';
+import { STATE_ROOT } from '../lib/state-dir.js';
+import { summarize } from '../lib/stats.js';
+
+export const STARTUP_PHASES = [
+  'ton_synced', 'initialized', 'proxy_connecting', 'proxy_ready', 'first_seqno', 'stake_visible', 'ready',
+];
+export const MAX_RUNS = 50;
+
+const state = {
+  path: resolve(STATE_ROOT, 'startup-history.json'),
+  runs: null,  // loaded lazily: [{ instance, startedAt, warm, outcome, phases: { [phase]: ms } }]
+};
+
+function load() {
+  if (state.runs) return state.runs;
+  state.runs = [];
+  try {
+    const data = JSON.parse(readFileSync(state.path, 'utf-8'));
+    if (Array.isArray(data.runs)) state.runs = data.runs.slice(-MAX_RUNS);
+  } catch {}
+  return state.runs;
+}
+
+function save() {
+  try {
+    const dir = resolve(state.path, '..');
+    if (!existsSync(dir)) mkdirSync(dir, { recursive: true, mode: 0o700 });
+    const tmp = `${state.path}.tmp`;
+    writeFileSync(tmp, JSON.stringify({ runs: state.runs }) + '\n', { mode: 0o600 });
+    renameSync(tmp, state.path);
+  } catch {}
+}
+
+/**
+ * Start tracing a launch.
+ * @param {number} instance
+ * @param {object} [opts]
+ * @param {boolean} [opts.warm=false] - persisted state reused (see state-dir.js)
+ * @returns {{ mark: (phase: string) => void, finish: (outcome: string) => void }}
+ */
+export function startTrace(instance, { warm = false } = {}) {
+  const run = { instance, startedAt: Date.now(), warm, outcome: null, phases: {} };
+  let done = false;
+
+  const finish = (outcome) => {
+    if (done) return;
+    done = true;
+    run.outcome = outcome;
+    const runs = load();
+    runs.push(run);
+    if (runs.length > MAX_RUNS) runs.splice(0, runs.length - MAX_RUNS);
+    save();
+  };
+
+  return {
+    mark(phase) {
+      if (done || run.phases[phase] !== undefined) return;
+      run.phases[phase] = Date.now() - run.startedAt;
+      if (STARTUP_PHASES.every(p => run.phases[p] !== undefined)) finish('ready');
+    },
+    finish,
+  };
+}
+
+/**
+ * Recorded runs (newest first) and per-phase percentiles, overall and
+ * split by warm / cold start.
+ */
+export function getStartupHistory() {
+  const runs = load();
+  const summary = (subset) => Object.fromEntries(STARTUP_PHASES.map(phase => [
+    phase,
+    summarize(subset.map(r => r.phases[phase]).filter(v => typeof v === 'number')),
+  ]));
+  return {
+    phases: STARTUP_PHASES,
+    summary: summary(runs),
+    warm: summary(runs.filter(r => r.warm)),
+    cold: summary(runs.filter(r => !r.warm)),
+    runs: [...runs].reverse(),
+  };
+}
+
+/** Point the history at another file (tests). */
+export function setStartupHistoryPath(path) {
+  state.path = path;
+  state.runs = null;
+}
@@ -0,0 +1,147 @@
+/**
+ * Stats publisher — one background sampler per running client-runner
+ * instance reads /jsonstats at a fixed cadence, so browser tabs no longer
+ * poll the binary themselves.
+ *
+ * Every sample is handed to the instance's `onSample` callback (milestone
+ * tracking, per-connection state). The stats of the instance that
+ * /api/jsonstats serves (lowest-numbered proxy-ready one) are published to
+ * subscribers as typed messages:
+ *
+ *   { type: 'stats_snapshot', seq, instance, stats, models }   full documents (or null)
+ *   { type: 'stats_patch',    seq, instance, ops, models? }   lib/json-diff.js ops
+ *
+ * `models` is the instance's /v1/models, sampled alongside and sent whole
+ * (patches carry it only when it changed), so tabs don't poll it either.
+ * `seq` increases by one per message, so a subscriber that sees a gap
+ * knows it missed a patch and must resync from a snapshot.
+ */
+
+import { diffJson } from '../lib/json-diff.js';
+import { getReadyPort } from './client-state.js';
+import { metrics } from '../lib/metrics.js';
+import { summarizeConnections, totalTokensPayed } from '../lib/connections.js';
+import { probeJson, probeJsonStats } from '../lib/readiness.js';
+
+const SAMPLE_INTERVAL_MS = 5_000;
+
+const state = {
+  samplers: new Map(),  // instance number → { httpPort, timer, stats, sampledAt, onSample }
+  published: { seq: 0, instance: null, stats: null, models: null },
+  subscribers: new Set(),
+};
+
+// Gauges lifted from the latest sample of each instance
+const seqnoGauge = metrics.gauge('cocoon_client_seqno', 'Highest proxy connection seqno (jsonstats)');
+const tokensPayedGauge = metrics.gauge('cocoon_client_tokens_payed', 'Stake deposited across proxies, in tokens (jsonstats)');
+const balanceGauge = metrics.gauge('cocoon_client_wallet_balance_nanoton', 'Node wallet balance (jsonstats)');
+const readyGauge = metrics.gauge('cocoon_client_proxy_connection_ready', 'Proxy connection handshake complete (jsonstats is_ready)');
+const sampleAgeGauge = metrics.gauge('cocoon_client_stats_age_seconds', 'Age of the latest jsonstats sample');
+
+metrics.addCollector(() => {
+  for (const g of [seqnoGauge, tokensPayedGauge, balanceGauge, readyGauge, sampleAgeGauge]) g.reset();
+  const now = Date.now();
+  for (const [instance, sampler] of state.samplers) {
+    if (!sampler.stats) continue;
+    const connections = summarizeConnections(sampler.stats);
+    seqnoGauge.set({ instance }, Math.max(0, ...connections.map(c => c.seqno)));
+    tokensPayedGauge.set({ instance }, totalTokensPayed(sampler.stats));
+    balanceGauge.set({ instance }, Number(sampler.stats.wallet?.balance ?? 0));
+    for (const conn of connections) {
+      readyGauge.set({ instance, connection: conn.index }, conn.ready ? 1 : 0);
+    }
+    sampleAgeGauge.set({ instance }, (now - sampler.sampledAt) / 1000);
+  }
+});
+
+function broadcast(message) {
+  for (const fn of state.subscribers) {
+    try { fn(message); } catch {}
+  }
+}
+
+/**
+ * Publish a sample of the instance /api/jsonstats serves. Switching source
+ * instance sends a fresh snapshot. A failed /v1/models read keeps the
+ * models published last.
+ */
+function publish(instance, stats, models) {
+  const pub = state.published;
+  if (pub.instance !== instance || pub.stats === null) {
+    state.published = { seq: pub.seq + 1, instance, stats, models };
+    broadcast(getStatsSnapshot());
+    return;
+  }
+  const ops = diffJson(pub.stats, stats);
+  const modelsChanged = models !== null && JSON.stringify(models) !== JSON.stringify(pub.models);
+  if (ops.length === 0 && !modelsChanged) return;
+  state.published = { seq: pub.seq + 1, instance, stats, models: modelsChanged ? models : pub.models };
+  broadcast({ type: 'stats_patch', seq: state.published.seq, instance, ops, ...(modelsChanged && { models }) });
+}
+
+/**
+ * Start sampling an instance (replaces any previous sampler for it).
+ * Samples never overlap: the next one is scheduled after the previous settles.
+ * @param {number} instance
+ * @param {number} httpPort
+ * @param {object} [opts]
+ * @param {(stats: object) => void} [opts.onSample]
+ * @param {number} [opts.intervalMs=5000]
+ */
+export function startSampler(instance, httpPort, opts = {}) {
+  const { onSample, intervalMs = SAMPLE_INTERVAL_MS } = opts;
+  stopSampler(instance);
+  const sampler = { httpPort, timer: null, stats: null, sampledAt: 0, onSample };
+  state.samplers.set(instance, sampler);
+
+  const tick = async () => {
+    const stats = await probeJsonStats(httpPort);
+    if (state.samplers.get(instance) !== sampler) return;
+    if (stats) {
+      sampler.stats = stats;
+      sampler.sampledAt = Date.now();
+      try { onSample?.(stats); } catch {}
+      // Only the published instance is asked for its models (and only once proxy-ready)
+      if (getReadyPort() === httpPort) {
+        const models = await probeJson(httpPort, '/v1/models');
+        if (state.samplers.get(instance) !== sampler) return;
+        publish(instance, stats, models);
+      }
+    }
+    sampler.timer = setTimeout(tick, intervalMs);
+  };
+  sampler.timer = setTimeout(tick, intervalMs);
+}
+
+/** Stop sampling an instance; publishes a null snapshot if it was the source. */
+export function stopSampler(instance) {
+  const sampler = state.samplers.get(instance);
+  if (!sampler) return;
+  clearTimeout(sampler.timer);
+  state.samplers.delete(instance);
+  if (state.published.instance === instance) {
+    state.published = { seq: state.published.seq + 1, instance: null, stats: null, models: null };
+    broadcast(getStatsSnapshot());
+  }
+}
+
+/** Latest sample of an instance, or null. */
+export function getLatestStats(instance) {
+  return state.samplers.get(instance)?.stats ?? null;
+}
+
+/** Full snapshot message of the published stats (sent to new subscribers). */
+export function getStatsSnapshot() {
+  const { seq, instance, stats, models } = state.published;
+  return { type: 'stats_snapshot', seq, instance, stats, models };
+}
+
+/**
+ * Subscribe to stats messages.
+ * @param {(message: object) => void} fn
+ * @returns {() => void} unsubscribe
+ */
+export function subscribeStats(fn) {
+  state.subscribers.add(fn);
+  return () => state.subscribers.delete(fn);
+}
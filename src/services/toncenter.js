@@ -1,5 +1,7 @@
-import { getApiKey } from '../lib/config.js';
+import { getApiKey, readWalletJson } from '../lib/config.js';
 import { toncenterLogger } from '../lib/logger.js';
+import { withRetry, getChainWatch, rawAddress } from '../lib/ton.js';
+import { createActionIndex } from './action-index.js';
 
 const BASE_URL = 'https://toncenter.com/api/v3';
 
@@ -10,27 +12,35 @@ const BASE_URL = 'https://toncenter.com/api/v3';
  * @param {string[]} [params.actionTypes] - cocoon action types to filter
  * @param {number} [params.limit=20]
  * @param {string} [params.sort='desc']
+ * @param {string} [params.startLt] - only actions from this logical time on
+ * @param {string} [params.endLt] - only actions up to this logical time
  * @returns {Promise<object>} raw API response
  */
-export async function queryActions({ account, actionTypes = [], limit = 20, sort = 'desc' }) {
+export async function queryActions({ account, actionTypes = [], limit = 20, sort = 'desc', startLt, endLt }) {
   const apiKey = getApiKey();
   const url = new URL(`${BASE_URL}/actions`);
   url.searchParams.set('account', account);
   url.searchParams.set('limit', String(limit));
   url.searchParams.set('sort', sort);
-  if (apiKey) url.searchParams.set('api_key', apiKey);
+  if (startLt) url.searchParams.set('start_lt', startLt);
+  if (endLt) url.searchParams.set('end_lt', endLt);
   for (const t of actionTypes) {
     url.searchParams.append('action_type', t);
   }
+  // Identical queries in flight (several dashboards) share one request
+  const key = `actions:${url.search}`;
+  if (apiKey) url.searchParams.set('api_key', apiKey);
 
-  toncenterLogger.debug({ account, actionTypes, limit }, 'Querying Toncenter actions');
-  const res = await fetch(url.toString(), { signal: AbortSignal.timeout(15000) });
-  if (!res.ok) {
-    const errMsg = `Toncenter API error: ${res.status}`;
-    toncenterLogger.error({ err: errMsg, status: res.status }, 'Toncenter API error');
-    throw new Error(errMsg);
-  }
-  return res.json();
+  return withRetry(async () => {
+    toncenterLogger.debug({ account, actionTypes, limit }, 'Querying Toncenter actions');
+    const res = await fetch(url.toString(), { signal: AbortSignal.timeout(15000) });
+    if (!res.ok) {
+      const errMsg = `Toncenter API error: ${res.status}`;
+      toncenterLogger.error({ err: errMsg, status: res.status }, 'Toncenter API error');
+      throw Object.assign(new Error(errMsg), { status: res.status });
+    }
+    return res.json();
+  }, 5, { key });
 }
 
 // Cocoon action type groups
@@ -61,51 +71,95 @@ export const ALL_COCOON_ACTIONS = [
   ...COCOON_PROXY_ACTIONS,
 ];
 
+const indexes = new Map();   // raw address → action index
+
+/**
+ * Raw form of `account` if it is the node or owner wallet, else null.
+ * Only those are indexed: each index is a file under .cocoon-state and a
+ * backfill, so arbitrary addresses from a request must not create one.
+ */
+export function indexedAccount(account) {
+  const wallet = readWalletJson();
+  let raw;
+  try {
+    raw = rawAddress(account);
+  } catch {
+    return null;
+  }
+  const own = [wallet?.node_wallet?.address, wallet?.owner_wallet?.address].filter(Boolean);
+  return own.some(a => rawAddress(a) === raw) ? raw : null;
+}
+
+/** The local action index for the node or owner wallet (loaded from disk on first use). */
+export function getActionIndex(account) {
+  const raw = indexedAccount(account);
+  if (!raw) {
+    throw Object.assign(new Error('Only the node and owner wallets are indexed'), { statusCode: 400 });
+  }
+  let index = indexes.get(raw);
+  if (!index) {
+    index = createActionIndex({
+      account: raw,
+      fetchPage: async ({ beforeLt, limit }) => {
+        const data = await queryActions({
+          account: raw, actionTypes: ALL_COCOON_ACTIONS, limit, sort: 'desc', endLt: beforeLt ?? undefined,
+        });
+        return data.actions || [];
+      },
+      isPayout: (entry) => COCOON_PAYOUT_ACTIONS.includes(entry.type),
+    });
+    indexes.set(raw, index);
+  }
+  return index;
+}
+
+/** Sync the index; on a Toncenter failure keep serving what is indexed. */
+async function syncIndex(index, opts) {
+  try {
+    await index.sync(opts);
+  } catch (err) {
+    if (index.stats().entries === 0) throw err;
+    toncenterLogger.warn({ err, account: index.stats().account }, 'Action index sync failed, serving indexed data');
+  }
+}
+
 /**
- * Get recent transaction history for a cocoon node.
+ * Get recent transaction history for a cocoon node. `complete` is false
+ * while older actions are still being backfilled.
  * @param {string} account - node wallet or owner wallet address
  * @param {number} [limit=20]
+ * @param {{ lt: string, id?: string }} [before] - page cursor (`nextBefore` of the previous page)
  */
-export async function getTransactionHistory(account, limit = 20) {
-  const data = await queryActions({
-    account,
-    actionTypes: ALL_COCOON_ACTIONS,
-    limit,
-  });
-
-  return (data.actions || []).map(action => ({
-    type: action.type,
-    success: action.success,
-    timestamp: action.end_utime,
-    details: action.details || {},
-    traceId: action.trace_id,
-  }));
+export async function getTransactionHistory(account, limit = 20, before) {
+  const index = getActionIndex(account);
+  await syncIndex(index);
+  const page = index.history({ limit, beforeLt: before?.lt, beforeId: before?.id });
+  const last = page.length === limit ? page[page.length - 1] : null;
+  return {
+    actions: page.map(({ type, success, timestamp, details, traceId, lt }) => ({ type, success, timestamp, details, traceId, lt })),
+    nextBeforeLt: last?.lt ?? null,
+    nextBeforeId: last?.id ?? null,
+    complete: index.complete(),
+  };
 }
 
 /**
- * Get earnings (payouts received) for a node.
+ * Get earnings (payouts received) for a node. `totalNano` covers every
+ * indexed payout, `payouts` only the newest `limit`; it is a partial sum
+ * while `complete` is false.
  * @param {string} account - node wallet address
  * @param {number} [limit=50]
  */
 export async function getEarnings(account, limit = 50) {
-  const data = await queryActions({
-    account,
-    actionTypes: COCOON_PAYOUT_ACTIONS,
-    limit,
-  });
-
-  let totalNano = 0n;
-  const payouts = (data.actions || []).map(action => {
-    const amount = BigInt(action.details?.amount || '0');
-    totalNano += amount;
-    return {
-      type: action.type,
-      amount: amount.toString(),
-      timestamp: action.end_utime,
-    };
-  });
-
-  return { payouts, totalNano: totalNano.toString() };
+  const index = getActionIndex(account);
+  await syncIndex(index);
+  const { payouts, totalNano, count } = index.earnings({ limit });
+  return {
+    payouts: payouts.map(p => ({ type: p.type, amount: String(p.details?.amount || '0'), timestamp: p.timestamp })),
+    totalNano,
+    count,
+    complete: index.complete(),
+  };
 }
 
 /**
@@ -114,15 +168,19 @@ export async function getEarnings(account, limit = 50) {
  * @param {string} account
  * @param {string} actionType
  * @param {number} afterTimestamp - unix timestamp, only return actions after this
+ * @param {number} [waitMs=0] - if not there yet, wait this long for it (long-poll)
  */
-export async function checkRecentAction(account, actionType, afterTimestamp) {
-  const data = await queryActions({
-    account,
-    actionTypes: [actionType],
-    limit: 5,
-    sort: 'desc',
-  });
-
-  const actions = data.actions || [];
-  return actions.find(a => a.end_utime > afterTimestamp && a.success) || null;
+export async function checkRecentAction(account, actionType, afterTimestamp, waitMs = 0) {
+  const index = getActionIndex(account);
+  const lookup = () => index.find(a => a.type === actionType && a.timestamp > afterTimestamp && a.success) || null;
+  // Confirmation checks want fresh data; the sync is incremental so this is one small query
+  await index.sync({ force: true });
+  if (lookup() || waitMs <= 0) return lookup();
+  // Re-sync only when the account actually gets a transaction
+  const found = await getChainWatch().waitFor(account, async (state) => {
+    if (state === null) return null;
+    await index.sync({ force: true });
+    return lookup();
+  }, { timeoutMs: waitMs, fallbackMs: waitMs });
+  return found || lookup();
 }
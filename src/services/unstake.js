@@ -0,0 +1,240 @@
+/**
+ * Unstake service — runs the unstake state machine (lib/unstake-machine.js)
+ * against the local client-runner and the chain, persisting every step to
+ * `.cocoon-state/unstake.json`. Shared by `cocoon unstake` and
+ * /api/wallet/unstake; either one resumes a run the other left unfinished.
+ * `unstake.lock` (the driving process's pid) keeps the two from driving
+ * the same run at once.
+ */
+
+import { existsSync, mkdirSync, readFileSync, writeFileSync, renameSync, rmSync } from 'fs';
+import { resolve } from 'path';
+import { Address } from '@ton/core';
+import { readWalletJson } from '../lib/config.js';
+import {
+  readAccountState, getCachedTonClient, getChainWatch, waitForBalance, waitForSeqnoChange, withRetry, asUserRequest,
+} from '../lib/ton.js';
+import { STATE_ROOT } from '../lib/state-dir.js';
+import { metrics } from '../lib/metrics.js';
+import { walletLogger } from '../lib/logger.js';
+import { SC_STATE, createRun, driveRun, overallStep, reconcileRun, unstakeableProxies } from '../lib/unstake-machine.js';
+import { transferToOwner } from './wallet.js';
+
+const STATE_PATH = resolve(STATE_ROOT, 'unstake.json');
+const LOCK_PATH = resolve(STATE_ROOT, 'unstake.lock');
+const CLOSE_TIMEOUT_MS = 120_000;
+// Older unfinished runs are not resumed: on-chain state has moved on, start over
+const RUN_MAX_AGE_MS = 24 * 60 * 60_000;
+const FUNDS_TIMEOUT_MS = 120_000;
+// A hung client-runner must fail the step, not hold the run (and its 409) forever
+const STATS_TIMEOUT_MS = 10_000;
+const REQUEST_TIMEOUT_MS = 30_000;
+
+const stepSeconds = metrics.histogram('cocoon_unstake_step_seconds',
+  'Time from entering an unstake step to completing it', [1, 2.5, 5, 10, 20, 30, 60, 120, 300]);
+
+const state = {
+  running: false,   // this process is driving a run
+};
+
+function load() {
+  try {
+    return JSON.parse(readFileSync(STATE_PATH, 'utf-8'));
+  } catch {
+    return null;
+  }
+}
+
+function save(run) {
+  try {
+    if (!existsSync(STATE_ROOT)) mkdirSync(STATE_ROOT, { recursive: true, mode: 0o700 });
+    const tmp = `${STATE_PATH}.tmp`;
+    writeFileSync(tmp, JSON.stringify(run, null, 2) + '\n', { mode: 0o600 });
+    renameSync(tmp, STATE_PATH);
+  } catch (err) {
+    walletLogger.warn({ err }, 'Could not persist unstake state');
+  }
+}
+
+function pidAlive(pid) {
+  try {
+    process.kill(pid, 0);
+    return true;
+  } catch (err) {
+    return err.code === 'EPERM';
+  }
+}
+
+/** Pid of the live process holding the unstake lock (this one included), or null. */
+export function getUnstakeOwner() {
+  let pid;
+  try {
+    pid = parseInt(readFileSync(LOCK_PATH, 'utf-8'), 10);
+  } catch {
+    return null;
+  }
+  return pid && pidAlive(pid) ? pid : null;
+}
+
+/** Take the lock; a lock left by a dead process is taken over. */
+function acquireLock() {
+  if (!existsSync(STATE_ROOT)) mkdirSync(STATE_ROOT, { recursive: true, mode: 0o700 });
+  for (let attempt = 0; attempt < 2; attempt++) {
+    try {
+      writeFileSync(LOCK_PATH, String(process.pid), { flag: 'wx', mode: 0o600 });
+      return;
+    } catch (err) {
+      if (err.code !== 'EEXIST') throw err;
+    }
+    const owner = getUnstakeOwner();
+    if (owner) throw new Error(`Unstake already in progress (pid ${owner})`);
+    rmSync(LOCK_PATH, { force: true });
+  }
+  throw new Error('Unstake already in progress');
+}
+
+function releaseLock() {
+  try {
+    if (parseInt(readFileSync(LOCK_PATH, 'utf-8'), 10) === process.pid) rmSync(LOCK_PATH, { force: true });
+  } catch {}
+}
+
+async function fetchStats(base) {
+  const res = await fetch(`${base}/jsonstats`, { signal: AbortSignal.timeout(STATS_TIMEOUT_MS) });
+  if (!res.ok) throw new Error(`HTTP ${res.status}: ${res.statusText}`);
+  return res.json();
+}
+
+async function sendRequest(base, action, proxyScAddress) {
+  const res = await fetch(`${base}/request/${action}?proxy=${encodeURIComponent(proxyScAddress)}`, {
+    signal: AbortSignal.timeout(REQUEST_TIMEOUT_MS),
+  });
+  const body = await res.text();
+  const clean = body.replace(/<[^>]*>/g, '').trim();
+  const ok = clean.toLowerCase().includes('request sent');
+  return { ok, message: clean };
+}
+
+/**
+ * Wait until the client-runner reports the proxy contract closed.
+ * jsonstats is re-read whenever the contract gets a transaction (chain
+ * watch), plus every 10s since the runner sees blocks a bit later.
+ */
+function waitClosed(base, proxyScAddress) {
+  return getChainWatch().waitFor(proxyScAddress, async () => {
+    const stats = await fetchStats(base);
+    const proxy = stats.proxies?.find(p => p.proxy_sc_address === proxyScAddress);
+    if (!proxy) return { removed: true };
+    return proxy.state >= SC_STATE.CLOSED ? proxy : null;
+  }, { timeoutMs: CLOSE_TIMEOUT_MS, fallbackMs: 10_000 });
+}
+
+function opsFor(port) {
+  const base = `http://127.0.0.1:${port}`;
+  const wallet = readWalletJson();
+  const nodeAddr = wallet?.node_wallet?.address;
+  return {
+    request: (action, proxy) => sendRequest(base, action, proxy),
+    waitClosed: (proxy) => waitClosed(base, proxy),
+    waitFunds: (minNano) => waitForBalance(nodeAddr, minNano, { timeoutMs: FUNDS_TIMEOUT_MS }),
+    transfer: () => transferToOwner(),
+    waitTransfer: (seqno) => {
+      const client = getCachedTonClient();
+      const addr = Address.parse(nodeAddr);
+      return waitForSeqnoChange(
+        () => withRetry(() => client.runMethod(addr, 'seqno')).then(r => r.stack.readNumber()),
+        seqno,
+        { address: addr, timeoutMs: 60_000 },
+      );
+    },
+  };
+}
+
+/** The persisted run, if any (finished, failed or interrupted). */
+export function getUnstakeRun() {
+  return load();
+}
+
+/** A run that was interrupted or failed recently and can be picked up again. */
+export function getResumableRun() {
+  const run = load();
+  if (!run || run.status === 'done') return null;
+  return Date.now() - (run.updatedAt ?? run.startedAt) < RUN_MAX_AGE_MS ? run : null;
+}
+
+/**
+ * Status for /api/wallet/unstake/status: the legacy `{ active, step,
+ * error, completedAt }` fields plus per-proxy steps and timings.
+ */
+export function getUnstakeStatus() {
+  const run = load();
+  // Also true while `cocoon unstake` drives the run from another process
+  const active = state.running || getUnstakeOwner() !== null;
+  return {
+    active,
+    step: overallStep(run),
+    error: run?.error ?? null,
+    completedAt: run?.completedAt ?? null,
+    resumable: !active && !!getResumableRun(),
+    run,
+  };
+}
+
+/**
+ * Start (or resume) an unstake. Resolves once the run is set up, with
+ * `done` settling when it finishes.
+ *
+ * @param {object} opts
+ * @param {number | string} opts.port - client-runner HTTP port
+ * @param {boolean} [opts.resume=true] - continue an unfinished run instead of starting over
+ * @param {(event: { target: string, step: string, ms: number }) => void} [opts.onStep]
+ * @returns {Promise<{ run: object, resumed: boolean, done: Promise<object> }>}
+ * @throws {Error} when there is nothing to unstake or a run is already going
+ *   (in this process or, per the lock file, in another one)
+ */
+export async function startUnstake({ port, resume = true, onStep }) {
+  if (state.running) throw new Error('Unstake already in progress');
+  acquireLock();
+  state.running = true;
+
+  try {
+    let run = resume ? getResumableRun() : null;
+    const resumed = !!run;
+    const stats = await fetchStats(`http://127.0.0.1:${port}`);
+    if (run) {
+      // Proxies staked or removed since the run was saved
+      const changes = reconcileRun(run, stats);
+      if (changes.added.length || changes.removed.length || changes.deferred.length) {
+        walletLogger.info({ op: 'unstake', run: run.id, ...changes }, 'Unstake run reconciled with jsonstats');
+      }
+      save(run);
+    } else {
+      const proxies = unstakeableProxies(stats);
+      if (proxies.length === 0) throw new Error('No active deposit to unstake');
+      const nodeAddr = readWalletJson()?.node_wallet?.address;
+      if (!nodeAddr) throw new Error('No wallet found');
+      // Fresh v2 read: settlement is detected against this baseline
+      const node = await readAccountState(nodeAddr);
+      run = createRun(proxies, node.balance);
+      save(run);
+    }
+
+    walletLogger.info({ op: 'unstake', run: run.id, proxies: run.proxies.length, resumed }, 'Unstake running');
+    const done = asUserRequest(() => driveRun(run, opsFor(port), {
+      save,
+      onStep: (event) => {
+        stepSeconds.observe({ step: event.step }, event.ms / 1000);
+        walletLogger.info({ op: 'unstake', ...event }, `Unstake ${event.target}: ${event.step} after ${event.ms}ms`);
+        onStep?.(event);
+      },
+    })).finally(() => {
+      state.running = false;
+      releaseLock();
+    });
+    return { run, resumed, done };
+  } catch (err) {
+    state.running = false;
+    releaseLock();
+    throw err;
+  }
+}
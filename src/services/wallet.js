@@ -4,12 +4,35 @@
  */
 
 import { readWalletJson } from '../lib/config.js';
-import { getCachedTonClient, getBalance } from '../lib/ton.js';
+import { getCachedTonClient, readAccountState, invalidateAccountStates } from '../lib/ton.js';
 import { sendFromCocoonWallet, sendFromOwnerWallet } from '../contracts/index.js';
 import { SC_RESERVE, OWNER_GAS_RESERVE, MIN_STAKE } from '../lib/constants.js';
 import { Address, toNano, fromNano } from '@ton/core';
 import { walletLogger } from '../lib/logger.js';
 
+/**
+ * Current balance from the v2 liteserver, bypassing the account-state
+ * cache and the v3 indexer (which can lag): amounts sent are computed
+ * from it.
+ * @param {string} address
+ * @returns {Promise<bigint>}
+ */
+async function freshBalance(address) {
+  return (await readAccountState(address)).balance;
+}
+
+/**
+ * Send, then drop the cached states of both ends so the next balance
+ * read reflects the transfer.
+ */
+async function sendAndInvalidate(send, from, to) {
+  try {
+    return await send();
+  } finally {
+    invalidateAccountStates([from, to]);
+  }
+}
+
 /**
  * Compute the available (withdrawable) balance for a wallet address.
  * Returns the nano amount after reserving SC_RESERVE, or 0n if the
@@ -19,8 +42,8 @@ import { walletLogger } from '../lib/logger.js';
  * @returns {Promise<bigint>}
  */
 export async function getAvailableBalance(address) {
-  const bal = await getBalance(address);
-  return bal.nano > SC_RESERVE ? bal.nano - SC_RESERVE : 0n;
+  const nano = await freshBalance(address);
+  return nano > SC_RESERVE ? nano - SC_RESERVE : 0n;
 }
 
 /**
@@ -54,7 +77,10 @@ export async function withdrawFunds({ amount } = {}) {
   }
 
   walletLogger.info({ op: 'withdraw', amount: fromNano(nanoAmount) }, 'Withdrawing from node wallet');
-  return sendFromCocoonWallet(client, cocoonAddress, nodeSecretKey, ownerAddress, nanoAmount);
+  return sendAndInvalidate(
+    () => sendFromCocoonWallet(client, cocoonAddress, nodeSecretKey, ownerAddress, nanoAmount),
+    cocoonAddr, wallet.owner_wallet.address,
+  );
 }
 
 /**
@@ -79,10 +105,10 @@ export async function stakeFunds({ amount } = {}) {
   const client = getCachedTonClient();
   const destAddress = Address.parse(cocoonAddr);
 
-  const ownerBal = await getBalance(ownerAddr);
+  const ownerNano = await freshBalance(ownerAddr);
   let nanoAmount;
   if (amount === 'max') {
-    nanoAmount = ownerBal.nano > OWNER_GAS_RESERVE ? ownerBal.nano - OWNER_GAS_RESERVE : 0n;
+    nanoAmount = ownerNano > OWNER_GAS_RESERVE ? ownerNano - OWNER_GAS_RESERVE : 0n;
     if (nanoAmount <= 0n) {
       throw new Error('Insufficient balance');
     }
@@ -95,12 +121,15 @@ export async function stakeFunds({ amount } = {}) {
     }
   }
 
-  if (nanoAmount + OWNER_GAS_RESERVE > ownerBal.nano) {
-    throw new Error(`Insufficient balance. Need ${fromNano(nanoAmount + OWNER_GAS_RESERVE)} TON (incl. 0.5 gas reserve), have ${fromNano(ownerBal.nano)} TON`);
+  if (nanoAmount + OWNER_GAS_RESERVE > ownerNano) {
+    throw new Error(`Insufficient balance. Need ${fromNano(nanoAmount + OWNER_GAS_RESERVE)} TON (incl. 0.5 gas reserve), have ${fromNano(ownerNano)} TON`);
   }
 
   walletLogger.info({ op: 'stake', amount: fromNano(nanoAmount) }, 'Staking to node wallet');
-  return sendFromOwnerWallet(client, mnemonic.split(' '), destAddress, nanoAmount);
+  return sendAndInvalidate(
+    () => sendFromOwnerWallet(client, mnemonic.split(' '), destAddress, nanoAmount),
+    ownerAddr, cocoonAddr,
+  );
 }
 
 /**
@@ -135,7 +164,10 @@ export async function cashoutFunds({ amount, destination }) {
   }
 
   walletLogger.info({ op: 'cashout', amount: fromNano(nanoAmount), destination }, 'Cashing out');
-  return sendFromOwnerWallet(client, mnemonic, destAddress, nanoAmount);
+  return sendAndInvalidate(
+    () => sendFromOwnerWallet(client, mnemonic, destAddress, nanoAmount),
+    wallet.owner_wallet.address, destination,
+  );
 }
 
 /**
@@ -159,7 +191,10 @@ export async function transferToOwner() {
   if (nanoAmount <= 0n) return null;
 
   walletLogger.info({ op: 'transferToOwner' }, 'Transferring node → owner');
-  return sendFromCocoonWallet(client, cocoonAddress, nodeSecretKey, ownerAddress, nanoAmount);
+  return sendAndInvalidate(
+    () => sendFromCocoonWallet(client, cocoonAddress, nodeSecretKey, ownerAddress, nanoAmount),
+    cocoonAddr, wallet.owner_wallet.address,
+  );
 }
 
 /**
@@ -184,13 +219,16 @@ export async function transferFunds({ to, amount }) {
 
   let nanoAmount;
   if (amount === 'max') {
-    const ownerBal = await getBalance(wallet.owner_wallet.address);
-    nanoAmount = ownerBal.nano > OWNER_GAS_RESERVE ? ownerBal.nano - OWNER_GAS_RESERVE : 0n;
+    const ownerNano = await freshBalance(wallet.owner_wallet.address);
+    nanoAmount = ownerNano > OWNER_GAS_RESERVE ? ownerNano - OWNER_GAS_RESERVE : 0n;
     if (nanoAmount <= 0n) throw new Error('Insufficient balance');
   } else {
     nanoAmount = toNano(amount);
   }
 
   walletLogger.info({ op: 'transfer', to, amount }, 'Transferring funds');
-  return sendFromOwnerWallet(client, mnemonic.split(' '), destination, nanoAmount);
+  return sendAndInvalidate(
+    () => sendFromOwnerWallet(client, mnemonic.split(' '), destination, nanoAmount),
+    wallet.owner_wallet.address, to,
+  );
 }
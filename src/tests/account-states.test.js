@@ -0,0 +1,96 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createAccountStates } from '../lib/account-states.js';
+
+const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+
+function fakeChain(balances, { delayMs = 0 } = {}) {
+  const calls = [];
+  return {
+    calls,
+    fetchMany: async (keys) => {
+      calls.push(keys);
+      // Read when the request goes out, answered after the delay
+      const states = new Map();
+      for (const key of keys) {
+        if (key in balances) {
+          states.set(key, { address: key, balance: balances[key], seqno: 1, status: 'active', lastTransactionLt: '10' });
+        }
+      }
+      if (delayMs) await sleep(delayMs);
+      return states;
+    },
+  };
+}
+
+describe('createAccountStates', () => {
+  it('batches lookups made in the same tick into one fetch', async () => {
+    const chain = fakeChain({ a: 1n, b: 2n });
+    const states = createAccountStates({ fetchMany: chain.fetchMany, normalize: (a) => a.toLowerCase() });
+
+    const [[a], [b, again]] = await Promise.all([states.get(['A']), states.get(['b', 'a'])]);
+    assert.deepEqual(chain.calls, [['a', 'b']]);
+    // Results keep the caller's spelling of the address
+    assert.equal(a.address, 'A');
+    assert.equal(a.balance, 1n);
+    assert.equal(b.balance, 2n);
+    assert.equal(again.balance, 1n);
+  });
+
+  it('serves cached states within the ttl unless a fresh read is asked for', async () => {
+    let t = 0;
+    const chain = fakeChain({ a: 1n });
+    const states = createAccountStates({ fetchMany: chain.fetchMany, ttlMs: 5000, now: () => t });
+
+    await states.get(['a']);
+    t = 4000;
+    await states.get(['a']);
+    assert.equal(chain.calls.length, 1);
+    await states.get(['a'], { maxAgeMs: 0 });
+    assert.equal(chain.calls.length, 2);
+    t = 10_000;
+    await states.get(['a']);
+    assert.equal(chain.calls.length, 3);
+    assert.equal(states.stats().hits, 1);
+  });
+
+  it('joins a batch in flight and reports unknown addresses as nonexistent', async () => {
+    const chain = fakeChain({ a: 1n }, { delayMs: 20 });
+    const states = createAccountStates({ fetchMany: chain.fetchMany });
+
+    const first = states.get(['a', 'new']);
+    await sleep(5);
+    const [second] = await states.get(['new'], { maxAgeMs: 0 });
+    assert.equal(chain.calls.length, 1);
+    assert.deepEqual(second, { address: 'new', balance: 0n, seqno: null, status: 'nonexist', lastTransactionLt: null });
+    assert.equal((await first)[0].balance, 1n);
+  });
+
+  it('does not cache a batch that started before invalidate()', async () => {
+    const balances = { a: 1n };
+    const chain = fakeChain(balances, { delayMs: 20 });
+    const states = createAccountStates({ fetchMany: chain.fetchMany });
+
+    const before = states.get(['a']);
+    await sleep(5);
+    balances.a = 5n;
+    states.invalidate(['a']);
+    const [after] = await states.get(['a']);
+    assert.equal((await before)[0].balance, 1n);
+    assert.equal(after.balance, 5n);
+    assert.equal((await states.get(['a']))[0].balance, 5n);
+    assert.equal(chain.calls.length, 2);
+  });
+
+  it('splits large lookups and rejects every waiter of a failed batch', async () => {
+    const chain = fakeChain({ a: 1n, b: 2n, c: 3n });
+    const states = createAccountStates({ fetchMany: chain.fetchMany, maxBatch: 2 });
+    await states.get(['a', 'b', 'c']);
+    assert.deepEqual(chain.calls, [['a', 'b'], ['c']]);
+
+    const failing = createAccountStates({ fetchMany: async () => { throw new Error('down'); } });
+    const results = await Promise.allSettled([failing.get(['x']), failing.get(['x', 'y'])]);
+    assert.ok(results.every(r => r.status === 'rejected' && r.reason.message === 'down'));
+    assert.equal(failing.stats().inflight, 0);
+  });
+});
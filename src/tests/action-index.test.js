@@ -0,0 +1,158 @@
+import { describe, it, beforeEach, afterEach } from 'node:test';
+import assert from 'node:assert/strict';
+import { mkdtempSync, rmSync, readFileSync } from 'fs';
+import { tmpdir } from 'os';
+import { join } from 'path';
+import { createActionIndex, PAGE_SIZE } from '../services/action-index.js';
+
+const isPayout = (e) => e.type === 'cocoon_worker_payout';
+
+/** A fake chain of `n` actions; every third is a 1 TON payout. */
+function chain(n) {
+  return Array.from({ length: n }, (_, i) => ({
+    action_id: `a${i}`,
+    start_lt: String(1000 + i * 10),
+    type: i % 3 === 0 ? 'cocoon_worker_payout' : 'cocoon_client_top_up',
+    success: true,
+    end_utime: 1_700_000_000 + i,
+    details: { amount: '1000000000' },
+    trace_id: `t${i}`,
+  }));
+}
+
+function fakeToncenter(actions) {
+  const calls = [];
+  const fetchPage = async ({ beforeLt, limit }) => {
+    calls.push(beforeLt);
+    return actions
+      .filter(a => beforeLt === null || BigInt(a.start_lt) <= BigInt(beforeLt))
+      .sort((a, b) => Number(BigInt(b.start_lt) - BigInt(a.start_lt)))
+      .slice(0, limit);
+  };
+  return { fetchPage, calls };
+}
+
+describe('createActionIndex', () => {
+  let root;
+  beforeEach(() => { root = mkdtempSync(join(tmpdir(), 'cocoon-actions-')); });
+  afterEach(() => { rmSync(root, { recursive: true, force: true }); });
+
+  it('backfills page by page and totals every payout', async () => {
+    const actions = chain(PAGE_SIZE * 2 + 5);
+    const { fetchPage, calls } = fakeToncenter(actions);
+    const index = createActionIndex({ account: 'EQabc', fetchPage, isPayout, root });
+    await index.sync();
+
+    assert.equal(index.stats().entries, actions.length);
+    assert.equal(calls.length, 3);
+    assert.equal(index.complete(), true);
+    const payouts = actions.filter(a => a.type === 'cocoon_worker_payout').length;
+    const { totalNano, count, payouts: recent } = index.earnings({ limit: 5 });
+    assert.equal(count, payouts);
+    assert.equal(totalNano, String(BigInt(payouts) * 1_000_000_000n));
+    assert.equal(recent.length, 5);
+  });
+
+  it('seeds from the newest actions and reports an unfinished backfill', async () => {
+    const actions = chain(PAGE_SIZE * 25);
+    const { fetchPage } = fakeToncenter(actions);
+    const index = createActionIndex({ account: 'EQabc', fetchPage, isPayout, root, minSyncIntervalMs: 0 });
+    await index.sync();
+
+    // History starts at the present even though the oldest pages are missing
+    assert.equal(index.history({ limit: 1 })[0].id, actions.at(-1).action_id);
+    assert.equal(index.complete(), false);
+    // 20 pages; each page after the first repeats its boundary action
+    assert.equal(index.stats().entries, PAGE_SIZE * 20 - 19);
+
+    // The remaining range survives a restart
+    const reloaded = createActionIndex({ account: 'EQabc', fetchPage, isPayout, root, minSyncIntervalMs: 0 });
+    assert.equal(reloaded.complete(), false);
+    await reloaded.sync();
+    assert.equal(reloaded.complete(), true);
+    assert.equal(reloaded.stats().entries, actions.length);
+    assert.equal(reloaded.history({ limit: 1, beforeLt: actions[1].start_lt })[0].id, 'a0');
+  });
+
+  it('syncs new actions down to the head and skips seen ones', async () => {
+    const actions = chain(10);
+    const { fetchPage, calls } = fakeToncenter(actions);
+    const index = createActionIndex({ account: 'EQabc', fetchPage, isPayout, root, minSyncIntervalMs: 0 });
+    await index.sync();
+    actions.push(...chain(12).slice(10));
+    await index.sync();
+
+    assert.deepEqual(calls, [null, null]);
+    assert.equal(index.stats().entries, 12);
+    assert.equal(index.stats().head, actions[11].start_lt);
+  });
+
+  it('fills a gap of new actions larger than one sync', async () => {
+    const actions = chain(10);
+    const { fetchPage } = fakeToncenter(actions);
+    const index = createActionIndex({ account: 'EQabc', fetchPage, isPayout, root, minSyncIntervalMs: 0 });
+    await index.sync();
+    actions.push(...chain(10 + PAGE_SIZE * 21).slice(10));
+    await index.sync();
+
+    assert.equal(index.complete(), false);
+    assert.equal(index.history({ limit: 1 })[0].id, actions.at(-1).action_id);
+    await index.sync();
+    assert.equal(index.complete(), true);
+    assert.equal(index.stats().entries, actions.length);
+  });
+
+  it('pages history newest first by lt', async () => {
+    const { fetchPage } = fakeToncenter(chain(25));
+    const index = createActionIndex({ account: 'EQabc', fetchPage, isPayout, root });
+    await index.sync();
+
+    const first = index.history({ limit: 10 });
+    assert.deepEqual(first.map(e => e.id).slice(0, 2), ['a24', 'a23']);
+    const second = index.history({ limit: 10, beforeLt: first.at(-1).lt });
+    assert.equal(second[0].id, 'a14');
+    assert.equal(index.history({ limit: 10, beforeLt: '1000' }).length, 0);
+  });
+
+  it('does not skip actions sharing an lt at a page boundary', async () => {
+    // Three actions of one transaction share start_lt
+    const actions = chain(6).map((a, i) => (i >= 2 && i <= 4 ? { ...a, start_lt: '5000' } : a));
+    const { fetchPage } = fakeToncenter(actions);
+    const index = createActionIndex({ account: 'EQabc', fetchPage, isPayout, root });
+    await index.sync();
+
+    const seen = [];
+    let cursor;
+    for (;;) {
+      const page = index.history({ limit: 2, beforeLt: cursor?.lt, beforeId: cursor?.id });
+      seen.push(...page.map(e => e.id));
+      if (page.length < 2) break;
+      cursor = page.at(-1);
+    }
+    assert.equal(seen.length, 6);
+    assert.deepEqual([...seen].sort(), actions.map(a => a.action_id).sort());
+  });
+
+  it('reloads the append-only file without refetching', async () => {
+    const { fetchPage } = fakeToncenter(chain(7));
+    const index = createActionIndex({ account: '0:ab/cd', fetchPage, isPayout, root });
+    await index.sync();
+    const file = join(root, 'actions', '0_ab_cd.jsonl');
+    assert.equal(readFileSync(file, 'utf-8').trim().split('\n').length, 7);
+
+    const reloaded = createActionIndex({ account: '0:ab/cd', fetchPage: async () => { throw new Error('offline'); }, isPayout, root });
+    assert.equal(reloaded.stats().entries, 7);
+    assert.equal(reloaded.earnings().count, 3);
+    assert.equal(reloaded.find(e => e.type === 'cocoon_client_top_up').id, 'a5');
+  });
+
+  it('shares one sync between concurrent callers and throttles repeats', async () => {
+    const { fetchPage, calls } = fakeToncenter(chain(3));
+    const index = createActionIndex({ account: 'EQabc', fetchPage, isPayout, root, minSyncIntervalMs: 60_000 });
+    await Promise.all([index.sync(), index.sync(), index.sync()]);
+    await index.sync();
+    assert.equal(calls.length, 1);
+    await index.sync({ force: true });
+    assert.equal(calls.length, 2);
+  });
+});
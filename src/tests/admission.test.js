@@ -0,0 +1,94 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createAdmission } from '../lib/admission.js';
+
+const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+
+/** A pool of `n` slots in the shape of acquireInstance() leases. */
+function slots(n) {
+  const pool = { free: n };
+  pool.tryAcquire = () => {
+    if (pool.free === 0) return null;
+    pool.free--;
+    return { release: () => { pool.free++; } };
+  };
+  return pool;
+}
+
+describe('createAdmission', () => {
+  it('admits up to capacity and queues the rest', async () => {
+    const pool = slots(2);
+    const a = createAdmission({ tryAcquire: pool.tryAcquire, capacity: () => 2 });
+    const l1 = await a.acquire();
+    await a.acquire();
+    let third = null;
+    a.acquire().then(l => { third = l; });
+    await sleep(0);
+    assert.equal(third, null);
+    assert.equal(a.depth(), 1);
+    l1.release();
+    await sleep(0);
+    assert.ok(third);
+    assert.equal(a.depth(), 0);
+    assert.equal(a.stats().admitted, 3);
+  });
+
+  it('serves interactive waiters before batch ones', async () => {
+    const pool = slots(1);
+    const a = createAdmission({ tryAcquire: pool.tryAcquire });
+    const first = await a.acquire('batch');
+    const order = [];
+    const waits = [
+      a.acquire('batch').then(l => { order.push('batch'); l.release(); }),
+      a.acquire('interactive').then(l => { order.push('interactive'); l.release(); }),
+    ];
+    assert.deepEqual(a.stats().depth, { interactive: 1, batch: 1 });
+    first.release();
+    await Promise.all(waits);
+    assert.deepEqual(order, ['interactive', 'batch']);
+  });
+
+  it('rejects with 429 once the queue budget runs out', async () => {
+    const pool = slots(1);
+    const reasons = [];
+    const a = createAdmission({ tryAcquire: pool.tryAcquire, budgetMs: 30, onReject: (p, r) => reasons.push(r) });
+    await a.acquire();
+    await assert.rejects(a.acquire(), (err) => err.statusCode === 429 && err.retryAfterMs >= 1000);
+    assert.deepEqual(reasons, ['timeout']);
+    assert.equal(a.depth(), 0);
+  });
+
+  it('rejects up front when the estimated wait is over budget', async () => {
+    const pool = slots(1);
+    let t = 0;
+    const a = createAdmission({ tryAcquire: pool.tryAcquire, budgetMs: 1000, now: () => t });
+    // One 5s hold sets the average slot time
+    const l = await a.acquire();
+    t = 5000;
+    l.release();
+    await a.acquire();
+    await assert.rejects(a.acquire(), (err) => err.reason === 'budget' && err.retryAfterMs === 5000);
+    assert.equal(a.depth(), 0);
+  });
+
+  it('rejects when the queue is full and drops aborted waiters', async () => {
+    const pool = slots(1);
+    const a = createAdmission({ tryAcquire: pool.tryAcquire, maxQueue: 1 });
+    await a.acquire();
+    const ctrl = new AbortController();
+    const waiting = a.acquire('batch', { signal: ctrl.signal });
+    await assert.rejects(a.acquire(), (err) => err.reason === 'queue_full');
+    ctrl.abort();
+    await assert.rejects(waiting, (err) => err.reason === 'aborted');
+    assert.equal(a.depth(), 0);
+  });
+
+  it('pump() admits waiters when capacity grows', async () => {
+    const pool = slots(0);
+    const a = createAdmission({ tryAcquire: pool.tryAcquire });
+    const waiting = a.acquire();
+    pool.free = 1;
+    a.pump();
+    assert.ok(await waiting);
+  });
+});
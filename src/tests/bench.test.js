@@ -0,0 +1,137 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { percentile, distribution, readCompletion, runLoad, summarize, compareResults, rotate } from '../lib/bench.js';
+
+const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+
+/** A fetch Response whose body arrives in the given chunks. */
+function streamed(chunks) {
+  const body = new ReadableStream({
+    start(controller) {
+      for (const c of chunks) controller.enqueue(new TextEncoder().encode(c));
+      controller.close();
+    },
+  });
+  return new Response(body);
+}
+
+describe('percentiles', () => {
+  it('uses nearest rank', () => {
+    const values = Array.from({ length: 100 }, (_, i) => i + 1);
+    assert.equal(percentile(values, 50), 50);
+    assert.equal(percentile(values, 95), 95);
+    assert.equal(percentile(values, 99), 99);
+    assert.equal(percentile([7], 99), 7);
+    assert.equal(percentile([], 50), null);
+    assert.deepEqual(distribution([3, 1, 2, null]), { mean: 2, p50: 2, p95: 3, p99: 3, max: 3 });
+  });
+});
+
+describe('rotate', () => {
+  it('spreads every model over every port and prompt', () => {
+    const seen = new Set();
+    for (let i = 0; i < 2 * 2 * 3; i++) seen.add(rotate(i, [2, 2, 3]).join(','));
+    assert.equal(seen.size, 12);
+    assert.deepEqual([0, 1, 2, 3].map(i => rotate(i, [2, 2, 3]).slice(0, 2).join(',')), ['0,0', '1,0', '0,1', '1,1']);
+  });
+});
+
+describe('readCompletion', () => {
+  it('times streamed events, with usage when reported', async () => {
+    let t = 0;
+    const now = () => (t += 10);
+    const res = streamed(['data: {"a":1}\n\n', 'data: {"a":2}\n\ndata: {"usage":{"completion_tokens":9}}\n\n', 'data: [DONE]\n\n']);
+    const r = await readCompletion(res, 0, now);
+    assert.equal(r.ttftMs, 10);
+    // Two events in the second chunk: the second one is 0 ms behind
+    assert.deepEqual(r.itlMs, [10, 0]);
+    assert.equal(r.tokens, 9);
+  });
+
+  it('handles events split across chunks and plain JSON bodies', async () => {
+    const split = await readCompletion(streamed(['data: {"a"', ':1}\n\ndata: {"a":2}\n\n']), 0);
+    assert.equal(split.tokens, 2);
+    assert.deepEqual(split.itlMs, [0]);
+    const plain = await readCompletion(streamed(['{"usage":{"completion_tokens":4}}']), 0);
+    assert.equal(plain.ttftMs, null);
+    assert.equal(plain.tokens, 4);
+  });
+});
+
+describe('runLoad', () => {
+  it('keeps at most `concurrency` requests in flight', async () => {
+    let inFlight = 0;
+    let peak = 0;
+    const { samples } = await runLoad({
+      concurrency: 3,
+      requests: 10,
+      send: async () => {
+        peak = Math.max(peak, ++inFlight);
+        await sleep(5);
+        inFlight--;
+        return { ok: true, status: 200, e2eMs: 5 };
+      },
+    });
+    assert.equal(samples.length, 10);
+    assert.equal(peak, 3);
+  });
+
+  it('paces starts to the rate', async () => {
+    const starts = [];
+    const t0 = performance.now();
+    await runLoad({
+      concurrency: 10,
+      ratePerSec: 100,
+      requests: 5,
+      send: async () => { starts.push(performance.now() - t0); return { ok: true, status: 200, e2eMs: 0 }; },
+    });
+    assert.ok(starts[4] >= 35, `5th start at ${starts[4]}ms, expected ~40ms`);
+  });
+});
+
+describe('summarize', () => {
+  it('reports error and 503/504 rates and throughput', () => {
+    const samples = [
+      { ok: true, status: 200, ttftMs: 100, itlMs: [10, 10], tokens: 3, e2eMs: 200 },
+      { ok: true, status: 200, ttftMs: 300, itlMs: [20], tokens: 2, e2eMs: 400 },
+      { ok: false, status: 503, e2eMs: 5 },
+      { ok: false, status: 504, e2eMs: 5000 },
+    ];
+    const s = summarize(samples, 2000);
+    assert.equal(s.errorRate, 0.5);
+    assert.equal(s.rate503, 0.25);
+    assert.equal(s.rate504, 0.25);
+    assert.equal(s.tokensPerSec, 2.5);
+    assert.equal(s.ttftMs.p50, 100);
+    assert.equal(s.e2eMs.max, 400);
+    assert.equal(s.decodeTokensPerSec.p50, 50);
+  });
+});
+
+describe('compareResults', () => {
+  const result = (metrics) => ({ metrics });
+
+  it('flags metrics that moved the wrong way beyond tolerance', () => {
+    const baseline = result({
+      linesPerSec: { value: 1000, better: 'higher' },
+      p95Ms: { value: 10, better: 'lower' },
+      rssMb: { value: 100, better: 'lower', tolerance: 0.5 },
+    });
+    const current = result({
+      linesPerSec: { value: 800, better: 'higher' },
+      p95Ms: { value: 9, better: 'lower' },
+      rssMb: { value: 140, better: 'lower', tolerance: 0.5 },
+      added: { value: 1, better: 'higher' },
+    });
+    const { rows, regressions } = compareResults(baseline, current, { tolerance: 0.1 });
+    assert.deepEqual(regressions.map(r => r.name), ['linesPerSec']);
+    assert.equal(rows.find(r => r.name === 'linesPerSec').change, -0.2);
+    assert.deepEqual(rows.find(r => r.name === 'added'), { name: 'added', baseline: null, current: 1, change: null, regressed: false });
+  });
+
+  it('needs an absolute move of minDelta from a zero baseline', () => {
+    const baseline = result({ errorRate: { value: 0, better: 'lower', minDelta: 0.01 } });
+    assert.equal(compareResults(baseline, result({ errorRate: { value: 0.005, better: 'lower', minDelta: 0.01 } })).regressions.length, 0);
+    assert.equal(compareResults(baseline, result({ errorRate: { value: 0.05, better: 'lower', minDelta: 0.01 } })).regressions.length, 1);
+  });
+});
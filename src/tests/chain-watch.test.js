@@ -0,0 +1,112 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createChainWatch } from '../lib/chain-watch.js';
+
+const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+
+/** A fake chain producing a block every `blockMs`; `send(addr, nano)` lands in the next block. */
+function fakeChain(blockMs = 40) {
+  const accounts = new Map();
+  const pending = [];
+  let seqno = 1;
+  let lt = 100n;
+  const calls = { masterchain: 0, account: 0 };
+  const timer = setInterval(() => {
+    seqno++;
+    for (const [addr, nano] of pending.splice(0)) {
+      const acc = accounts.get(addr) ?? { lt: null, balance: 0n };
+      accounts.set(addr, { lt: String(lt++), balance: acc.balance + nano });
+    }
+  }, blockMs);
+  return {
+    calls,
+    send: (addr, nano) => pending.push([addr, nano]),
+    stop: () => clearInterval(timer),
+    watch: () => createChainWatch({
+      blockIntervalMs: blockMs,
+      getMasterchainSeqno: async () => { calls.masterchain++; return seqno; },
+      getAccountState: async (addr) => { calls.account++; return accounts.get(addr) ?? { lt: null, balance: 0n }; },
+    }),
+  };
+}
+
+describe('createChainWatch', () => {
+  it('wakes a waiter on the first block with a transaction to its address', async () => {
+    const chain = fakeChain();
+    const watch = chain.watch();
+    try {
+      const balance = watch.waitFor('A', (state) => (state && state.balance >= 5n ? state.balance : null), { timeoutMs: 2000 });
+      await sleep(100);
+      chain.send('B', 9n);
+      await sleep(100);
+      chain.send('A', 5n);
+      assert.equal(await balance, 5n);
+      assert.equal(watch.stats().watched, 0);
+    } finally {
+      watch.close();
+      chain.stop();
+    }
+  });
+
+  it('only reads account state when a new block appears', async () => {
+    const chain = fakeChain(60);
+    const watch = chain.watch();
+    try {
+      const unsubscribe = watch.subscribe('A', () => {});
+      await sleep(400);
+      unsubscribe();
+      const { masterchainPolls, accountPolls } = watch.stats();
+      // ~6 blocks: one account read per block (+ baseline), masterchain polled more often
+      assert.ok(accountPolls <= 9, `accountPolls=${accountPolls}`);
+      assert.ok(masterchainPolls >= accountPolls - 1);
+    } finally {
+      watch.close();
+      chain.stop();
+    }
+  });
+
+  it('shares one loop between waiters on the same address', async () => {
+    const chain = fakeChain();
+    const watch = chain.watch();
+    try {
+      const a = watch.waitFor('A', (s) => s && 'a', { timeoutMs: 2000 });
+      const b = watch.waitFor('A', (s) => s && 'b', { timeoutMs: 2000 });
+      assert.equal(watch.stats().watched, 1);
+      chain.send('A', 1n);
+      assert.deepEqual(await Promise.all([a, b]), ['a', 'b']);
+    } finally {
+      watch.close();
+      chain.stop();
+    }
+  });
+
+  it('resolves null on timeout and on abort', async () => {
+    const chain = fakeChain();
+    const watch = chain.watch();
+    try {
+      assert.equal(await watch.waitFor('A', () => null, { timeoutMs: 80 }), null);
+      const ac = new AbortController();
+      const waiting = watch.waitFor('A', () => null, { timeoutMs: 5000, signal: ac.signal });
+      ac.abort();
+      assert.equal(await waiting, null);
+      await sleep(100);
+      assert.equal(watch.stats().watched, 0);
+    } finally {
+      watch.close();
+      chain.stop();
+    }
+  });
+
+  it('resolves immediately when the condition already holds', async () => {
+    const chain = fakeChain();
+    const watch = chain.watch();
+    try {
+      const start = Date.now();
+      assert.equal(await watch.waitFor('A', () => 'done', { timeoutMs: 2000 }), 'done');
+      assert.ok(Date.now() - start < 30);
+    } finally {
+      watch.close();
+      chain.stop();
+    }
+  });
+});
@@ -0,0 +1,139 @@
+import { describe, it, beforeEach } from 'node:test';
+import assert from 'node:assert/strict';
+import {
+  setClientState, clearClientState, setHandshaking, setProxyReady,
+  setInstanceConnections, getInstancePhase, getClientPhase, isProxyReady,
+  onPhaseChange, acquireInstance, setStandby, getReadyPort, getClientPort,
+} from '../services/client-state.js';
+
+const conn = (index, ready) => ({ index, address: null, proxyScAddress: null, ready, seqno: 0, tokensPayed: 0 });
+
+describe('client phase machine', () => {
+  beforeEach(() => clearClientState());
+
+  it('walks starting → handshaking → ready', () => {
+    setClientState(10000, 0);
+    assert.equal(getInstancePhase(0), 'starting');
+    setHandshaking(0);
+    assert.equal(getInstancePhase(0), 'handshaking');
+    assert.equal(isProxyReady(0), false);
+    setProxyReady(0);
+    assert.equal(getInstancePhase(0), 'ready');
+    assert.equal(isProxyReady(0), true);
+  });
+
+  it('degrades when a connection drops and recovers when all are ready', () => {
+    setClientState(10000, 0);
+    setProxyReady(0);
+    setInstanceConnections(0, [conn(0, true), conn(1, false)]);
+    assert.equal(getInstancePhase(0), 'degraded');
+    assert.equal(isProxyReady(0), true);
+    setInstanceConnections(0, [conn(0, true), conn(1, true)]);
+    assert.equal(getInstancePhase(0), 'ready');
+  });
+
+  it('lands in degraded when marked ready with a connection still pending', () => {
+    setClientState(10000, 0);
+    setInstanceConnections(0, [conn(0, true), conn(1, false)]);
+    setProxyReady(0);
+    assert.equal(getInstancePhase(0), 'degraded');
+  });
+
+  it('ignores backwards transitions', () => {
+    setClientState(10000, 0);
+    setProxyReady(0);
+    setHandshaking(0);
+    assert.equal(getInstancePhase(0), 'ready');
+  });
+
+  it('notifies listeners, including the final stopped transition', () => {
+    const seen = [];
+    const off = onPhaseChange(({ phase, prev }) => seen.push(`${prev}>${phase}`));
+    setClientState(10000, 0);
+    setHandshaking(0);
+    setProxyReady(0);
+    clearClientState(0);
+    off();
+    assert.deepEqual(seen, ['stopped>starting', 'starting>handshaking', 'handshaking>ready', 'ready>stopped']);
+    assert.equal(getClientPhase(), 'stopped');
+  });
+
+  it('reports the most advanced phase across the pool', () => {
+    setClientState(10000, 0);
+    setClientState(10010, 1);
+    setHandshaking(0);
+    assert.equal(getClientPhase(), 'handshaking');
+    setProxyReady(1);
+    assert.equal(getClientPhase(), 'ready');
+  });
+});
+
+describe('acquireInstance', () => {
+  beforeEach(() => clearClientState());
+
+  it('prefers ready instances, then the least loaded', () => {
+    setClientState(10000, 0);
+    setClientState(10010, 1);
+    setProxyReady(1);
+    const a = acquireInstance();
+    assert.equal(a.instance, 1);
+    setProxyReady(0);
+    const b = acquireInstance();
+    assert.equal(b.instance, 0);
+    a.release();
+    a.release();
+    const c = acquireInstance();
+    assert.equal(c.instance, 1);
+  });
+
+  it('returns null when nothing is running', () => {
+    assert.equal(acquireInstance(), null);
+  });
+
+  it('routes to a standby only while no serving instance is ready', () => {
+    setClientState(10000, 0);
+    setClientState(10010, 1, { standby: true });
+    setProxyReady(0);
+    setProxyReady(1);
+    assert.equal(acquireInstance().instance, 0);
+    assert.equal(getReadyPort(), 10000);
+
+    // Primary died: the ready standby takes over immediately
+    clearClientState(0);
+    assert.equal(acquireInstance().instance, 1);
+
+    // Restarted primary not ready yet: still the standby
+    setClientState(10000, 0);
+    assert.equal(acquireInstance().instance, 1);
+
+    // Failover promotion
+    setStandby(0, true);
+    setStandby(1, false);
+    assert.equal(getClientPort(), 10010);
+  });
+
+  it('orders instances of a tier by rank before load', () => {
+    setClientState(10000, 0, { maxCoefficient: 0 });
+    setClientState(10010, 1, { maxCoefficient: 1000 });
+    setProxyReady(0);
+    setProxyReady(1);
+    acquireInstance();
+    const byPrice = (inst) => (inst.maxCoefficient > 0 ? inst.maxCoefficient : Infinity);
+    // Instance 1 is busier but cheaper
+    assert.equal(acquireInstance({ rank: byPrice }).instance, 1);
+    assert.equal(acquireInstance({ rank: byPrice }).instance, 1);
+    assert.equal(acquireInstance().instance, 0);
+  });
+
+  it('skips instances at maxInFlight without spilling onto a standby', () => {
+    setClientState(10000, 0);
+    setClientState(10010, 1);
+    setClientState(10020, 2, { standby: true });
+    for (const i of [0, 1, 2]) setProxyReady(i);
+    const leases = [1, 2, 3, 4].map(() => acquireInstance({ maxInFlight: 2 }));
+    assert.deepEqual(leases.map(l => l.instance).sort(), [0, 0, 1, 1]);
+    assert.equal(acquireInstance({ maxInFlight: 2 }), null);
+    leases[0].release();
+    assert.ok(acquireInstance({ maxInFlight: 2 }));
+  });
+});
@@ -0,0 +1,104 @@
+import { describe, it, beforeEach, afterEach } from 'node:test';
+import assert from 'node:assert/strict';
+import { mkdtempSync, rmSync, readdirSync, statSync } from 'fs';
+import { tmpdir } from 'os';
+import { join } from 'path';
+import {
+  canonicalJson, completionKey, isCacheable, responseTokens, createCompletionCache,
+} from '../lib/completion-cache.js';
+
+const sse = (...events) => ({
+  status: 200,
+  contentType: 'text/event-stream',
+  chunks: events.map(e => Buffer.from(`data: ${e}\n\n`)),
+});
+
+describe('completion keys', () => {
+  it('ignores key order and the user field', () => {
+    assert.equal(canonicalJson({ b: [1, { d: 2, c: 3 }], a: null }), '{"a":null,"b":[1,{"c":3,"d":2}]}');
+    const a = completionKey({ model: 'm', temperature: 0, messages: [{ role: 'user', content: 'hi' }] });
+    const b = completionKey({ messages: [{ content: 'hi', role: 'user' }], temperature: 0, model: 'm', user: 'x' });
+    assert.equal(a, b);
+    assert.notEqual(a, completionKey({ model: 'm', temperature: 0, messages: [{ role: 'user', content: 'ho' }] }));
+  });
+
+  it('only caches deterministic single-choice requests', () => {
+    assert.equal(isCacheable({ temperature: 0 }), true);
+    assert.equal(isCacheable({ temperature: 0.7 }), false);
+    assert.equal(isCacheable({}), false);
+    assert.equal(isCacheable({ temperature: 0, n: 2 }), false);
+    assert.equal(isCacheable(null), false);
+  });
+
+  it('counts reported usage, else streamed events', () => {
+    assert.equal(responseTokens(sse('{"x":1}', '{"x":2}', '[DONE]')), 2);
+    assert.equal(responseTokens(sse('{"x":1}', '{"usage":{"total_tokens":40}}', '[DONE]')), 40);
+    assert.equal(responseTokens({ chunks: [Buffer.from('{"usage":{"total_tokens":7}}')] }), 7);
+  });
+});
+
+describe('createCompletionCache', () => {
+  let dir;
+  beforeEach(() => { dir = mkdtempSync(join(tmpdir(), 'cocoon-cc-')); });
+  afterEach(() => rmSync(dir, { recursive: true, force: true }));
+
+  it('replays the stored chunks and counts tokens saved', async () => {
+    const cache = createCompletionCache({ dir });
+    assert.equal(await cache.get('a'.repeat(64)), null);
+    await cache.put('a'.repeat(64), sse('{"x":1}', '{"x":2}', '[DONE]'));
+    const hit = await cache.get('a'.repeat(64));
+    assert.deepEqual(hit.chunks.map(String), ['data: {"x":1}\n\n', 'data: {"x":2}\n\n', 'data: [DONE]\n\n']);
+    assert.deepEqual(
+      [cache.stats().hits, cache.stats().misses, cache.stats().tokensSaved, cache.stats().hitRatio],
+      [1, 1, 2, 0.5],
+    );
+  });
+
+  it('evicts least recently used entries past the memory bound, keeping them on disk', async () => {
+    const entry = sse('x'.repeat(100));
+    const cache = createCompletionCache({ dir, maxMemoryBytes: 250 });
+    const [k1, k2, k3] = ['1', '2', '3'].map(c => c.repeat(64));
+    await cache.put(k1, entry);
+    await cache.put(k2, entry);
+    await cache.get(k1);
+    await cache.put(k3, entry);
+    assert.equal(cache.stats().entries, 2);
+    assert.equal(cache.stats().diskEntries, 3);
+    // k2 was evicted from memory, found again on disk
+    assert.ok(await cache.get(k2));
+  });
+
+  it('survives a restart through the disk tier and bounds it', async () => {
+    const first = createCompletionCache({ dir, maxDiskBytes: 600 });
+    for (const c of ['1', '2', '3', '4']) await first.put(c.repeat(64), sse('y'.repeat(100)));
+    const files = readdirSync(dir);
+    assert.ok(files.length < 4 && files.length > 0, `${files.length} files kept`);
+
+    const second = createCompletionCache({ dir, maxDiskBytes: 600 });
+    assert.ok(await second.get('4'.repeat(64)));
+    assert.equal(await second.get('1'.repeat(64)), null);
+  });
+
+  it('drops entries past the TTL', async () => {
+    let t = 0;
+    const cache = createCompletionCache({ dir, ttlMs: 1000, now: () => t });
+    await cache.put('a'.repeat(64), sse('{}'));
+    t = 1001;
+    assert.equal(await cache.get('a'.repeat(64)), null);
+    assert.equal(cache.stats().diskEntries, 0);
+  });
+
+  it('keeps an entry stored twice on disk', async () => {
+    const key = 'b'.repeat(64);
+    const first = createCompletionCache({ dir });
+    await Promise.all([first.put(key, sse('{"x":1}')), first.put(key, sse('{"x":1}'))]);
+    await first.put(key, sse('{"x":2}'));
+    assert.deepEqual(readdirSync(dir), [`${key}.json`]);
+    assert.equal(first.stats().diskEntries, 1);
+    assert.equal(first.stats().diskBytes, statSync(join(dir, `${key}.json`)).size);
+
+    const second = createCompletionCache({ dir });
+    const hit = await second.get(key);
+    assert.deepEqual(hit.chunks.map(String), ['data: {"x":2}\n\n']);
+  });
+});
@@ -3,7 +3,7 @@ import assert from 'node:assert/strict';
 import { mkdtempSync, rmSync, existsSync, writeFileSync } from 'fs';
 import { join } from 'path';
 import { tmpdir } from 'os';
-import { readClientConf, writeClientConf } from '../lib/config.js';
+import { readClientConf, writeClientConf, getRuntimeVars, perInstanceNumber } from '../lib/config.js';
 
 describe('readClientConf / writeClientConf roundtrip', () => {
   let tempDir;
@@ -90,3 +90,21 @@ describe('readClientConf / writeClientConf roundtrip', () => {
     assert.ok(existsSync(tempConf), 'conf file should exist after write');
   });
 });
+
+describe('per-instance limits', () => {
+  it('picks the pool entry of a comma list, repeating the last', () => {
+    assert.equal(perInstanceNumber(undefined), 0);
+    assert.equal(perInstanceNumber('1500'), 1500);
+    assert.equal(perInstanceNumber('0, 1500', 0), 0);
+    assert.equal(perInstanceNumber('0, 1500', 1), 1500);
+    assert.equal(perInstanceNumber('0, 1500', 4), 1500);
+    assert.equal(perInstanceNumber('abc'), 0);
+  });
+
+  it('renders max_coefficient / max_tokens as numbers per pool index', () => {
+    const vars = getRuntimeVars({ instance: '3', pool_index: '1', max_coefficient: '0,1200', max_tokens: '4096' });
+    assert.equal(vars.MAX_COEFFICIENT, 1200);
+    assert.equal(vars.MAX_TOKENS, 4096);
+    assert.equal(getRuntimeVars({}).MAX_COEFFICIENT, 0);
+  });
+});
@@ -0,0 +1,64 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import {
+  parseProxyConnections, summarizeConnections, countReadyConnections,
+  totalTokensPayed, isFullyReady,
+} from '../lib/connections.js';
+
+const stats = {
+  proxy_connections: [
+    { address: '[1.2.3.4:8888]', is_ready: false, proxy_sc_address: 'EQa', seqno: 0 },
+    { address: '[5.6.7.8:8888]', is_ready: true, proxy_sc_address: 'EQb', seqno: 3 },
+  ],
+  proxies: [
+    { proxy_sc_address: 'EQa', tokens_payed: 0 },
+    { proxy_sc_address: 'EQb', tokens_payed: 1500 },
+  ],
+};
+
+describe('parseProxyConnections', () => {
+  it('defaults to 1 when missing or invalid', () => {
+    assert.equal(parseProxyConnections(undefined), 1);
+    assert.equal(parseProxyConnections('abc'), 1);
+  });
+
+  it('clamps to the 1..8 range', () => {
+    assert.equal(parseProxyConnections('0'), 1);
+    assert.equal(parseProxyConnections('3'), 3);
+    assert.equal(parseProxyConnections('50'), 8);
+  });
+});
+
+describe('summarizeConnections', () => {
+  it('returns one entry per connection with stake joined by contract address', () => {
+    const conns = summarizeConnections(stats);
+    assert.equal(conns.length, 2);
+    assert.deepEqual(conns[1], {
+      index: 1, address: '5.6.7.8:8888', proxyScAddress: 'EQb', ready: true, seqno: 3, tokensPayed: 1500,
+    });
+    assert.equal(conns[0].ready, false);
+    assert.equal(conns[0].tokensPayed, 0);
+  });
+
+  it('handles missing arrays', () => {
+    assert.deepEqual(summarizeConnections(null), []);
+    assert.deepEqual(summarizeConnections({}), []);
+  });
+});
+
+describe('isFullyReady', () => {
+  it('is ready when any connection is ready and stake is deposited', () => {
+    assert.equal(countReadyConnections(stats), 1);
+    assert.equal(totalTokensPayed(stats), 1500);
+    assert.equal(isFullyReady(stats), true);
+  });
+
+  it('is not ready when no connection finished its handshake', () => {
+    const pending = { ...stats, proxy_connections: stats.proxy_connections.map(pc => ({ ...pc, is_ready: false })) };
+    assert.equal(isFullyReady(pending), false);
+  });
+
+  it('is not ready without stake', () => {
+    assert.equal(isFullyReady({ ...stats, proxies: [] }), false);
+  });
+});
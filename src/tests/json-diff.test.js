@@ -0,0 +1,56 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { diffJson, applyPatch } from '../lib/json-diff.js';
+
+describe('diffJson', () => {
+  it('returns no ops for equal documents', () => {
+    assert.deepEqual(diffJson({ a: 1, b: [1, 2] }, { a: 1, b: [1, 2] }), []);
+  });
+
+  it('emits leaf replaces, adds and removes', () => {
+    const ops = diffJson(
+      { wallet: { balance: 5, seqno: 1 }, gone: true },
+      { wallet: { balance: 6, seqno: 1 }, added: 'x' },
+    );
+    assert.deepEqual(ops, [
+      { op: 'remove', path: '/gone' },
+      { op: 'replace', path: '/wallet/balance', value: 6 },
+      { op: 'add', path: '/added', value: 'x' },
+    ]);
+  });
+
+  it('diffs equal-length arrays by index and replaces resized ones', () => {
+    assert.deepEqual(
+      diffJson({ pc: [{ is_ready: false }] }, { pc: [{ is_ready: true }] }),
+      [{ op: 'replace', path: '/pc/0/is_ready', value: true }],
+    );
+    assert.deepEqual(
+      diffJson({ pc: [1] }, { pc: [1, 2] }),
+      [{ op: 'replace', path: '/pc', value: [1, 2] }],
+    );
+  });
+
+  it('escapes / and ~ in keys', () => {
+    assert.deepEqual(diffJson({ 'a/b~': 1 }, { 'a/b~': 2 }), [{ op: 'replace', path: '/a~1b~0', value: 2 }]);
+  });
+});
+
+describe('applyPatch', () => {
+  it('roundtrips diffJson output', () => {
+    const prev = { status: { synced: 1 }, proxies: [{ tokens: 0 }, { tokens: 5 }], old: 1, 'k/x': 0 };
+    const next = { status: { synced: 2 }, proxies: [{ tokens: 3 }, { tokens: 5 }], fresh: [1], 'k/x': 1 };
+    assert.deepEqual(applyPatch(prev, diffJson(prev, next)), next);
+  });
+
+  it('does not mutate the input and shares unchanged subtrees', () => {
+    const prev = { a: { n: 1 }, b: { n: 2 } };
+    const out = applyPatch(prev, [{ op: 'replace', path: '/a/n', value: 9 }]);
+    assert.equal(prev.a.n, 1);
+    assert.equal(out.a.n, 9);
+    assert.equal(out.b, prev.b);
+  });
+
+  it('replaces the whole document for the root path', () => {
+    assert.deepEqual(applyPatch({ a: 1 }, [{ op: 'replace', path: '', value: { b: 2 } }]), { b: 2 });
+  });
+});
@@ -0,0 +1,49 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createKeyCache } from '../lib/key-cache.js';
+
+const WORDS = Array.from({ length: 24 }, (_, i) => `word${i}`);
+
+function fakeDerive() {
+  let calls = 0;
+  const derive = async (mnemonic) => {
+    calls++;
+    await new Promise(r => setTimeout(r, 10));
+    return { publicKey: Buffer.from(mnemonic[0]), secretKey: Buffer.alloc(64, 7) };
+  };
+  return { derive, calls: () => calls };
+}
+
+describe('createKeyCache', () => {
+  it('derives each mnemonic once, sharing concurrent calls', async () => {
+    const { derive, calls } = fakeDerive();
+    const cache = createKeyCache(derive);
+    const [a, b] = await Promise.all([cache.get(WORDS), cache.get([...WORDS])]);
+    assert.equal(a, b);
+    assert.equal(calls(), 1);
+    await cache.get(WORDS);
+    assert.equal(calls(), 1);
+    await cache.get(['other', ...WORDS.slice(1)]);
+    assert.equal(calls(), 2);
+    assert.equal(cache.size, 2);
+  });
+
+  it('zeroes secret keys on clear', async () => {
+    const cache = createKeyCache(fakeDerive().derive);
+    const keys = await cache.get(WORDS);
+    cache.clear();
+    assert.ok(keys.secretKey.every(b => b === 0));
+    assert.equal(cache.size, 0);
+  });
+
+  it('does not cache a failed derivation', async () => {
+    let fail = true;
+    const cache = createKeyCache(async () => {
+      if (fail) throw new Error('boom');
+      return { publicKey: Buffer.alloc(32), secretKey: Buffer.alloc(64, 1) };
+    });
+    await assert.rejects(cache.get(WORDS), /boom/);
+    fail = false;
+    assert.equal((await cache.get(WORDS)).secretKey[0], 1);
+  });
+});
@@ -0,0 +1,97 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import {
+  createLineSplitter, matchLifecycle, stripAnsi, LIFECYCLE_PATTERNS, MAX_LINE_BYTES,
+} from '../lib/line-parser.js';
+
+/** The pre-prefilter matcher: every pattern in order. */
+function matchSequential(line) {
+  for (const lp of LIFECYCLE_PATTERNS) {
+    const match = line.match(lp.pattern);
+    if (match) return { event: lp.event, match };
+  }
+  return null;
+}
+
+function collect(chunks) {
+  const lines = [];
+  const splitter = createLineSplitter(l => lines.push(l));
+  for (const c of chunks) splitter.push(Buffer.isBuffer(c) ? c : Buffer.from(c));
+  splitter.end();
+  return lines;
+}
+
+describe('matchLifecycle', () => {
+  const samples = [
+    '[ 3][t 1][2025-01-01 00:00:00.000][TonlibClient.cpp:42] TonLib is synced',
+    '[ 3][t 0][2025-01-01 00:00:00.000][Client.cpp:120] initialization completed',
+    '[ 3][t 2][2025-01-01 00:00:00.000][Proxy.cpp:88] OK, connecting to [1.2.3.4:8888]',
+    '[ 3][t 2][2025-01-01 00:00:00.000][Proxy.cpp:99] handshake completed successfully',
+    '[ 3][t 2][2025-01-01 00:00:00.000][Conn.cpp:10] outbound connection ready',
+    '[ 3][t 0][2025-01-01 00:00:00.000][TcpListener[port:10000]] 0.0.0.0 10000',
+    '[ 0][t 0][2025-01-01 00:00:00.000][Main.cpp:1] FATAL: bad config',
+    'Aborted (core dumped)',
+    '[ 0][t 4][2025-01-01 00:00:00.000][Rpc.cpp:5] Error: connection refused',
+    '[ 0][t 4][2025-01-01 00:00:00.000][Rpc.cpp:5] something else',
+    '[ 4][t 4][2025-01-01 00:00:00.000][Rpc.cpp:5] query error, retrying',
+    '[ 4][t 1][2025-01-01 00:00:00.000][Adnl.cpp:300] received packet from peer',
+    '',
+  ];
+
+  it('agrees with sequential matching on every sample', () => {
+    for (const line of samples) {
+      const got = matchLifecycle(line);
+      const want = matchSequential(line);
+      assert.equal(got?.event, want?.event, line);
+      assert.deepEqual(got ? [...got.match] : null, want ? [...want.match] : null, line);
+    }
+  });
+
+  it('extracts capture groups', () => {
+    assert.equal(matchLifecycle(samples[2]).match[1], '1.2.3.4:8888');
+    const listening = matchLifecycle(samples[5]);
+    assert.equal(listening.event, 'listening');
+    assert.deepEqual([listening.match[1], listening.match[2]], ['10000', '10000']);
+  });
+
+  it('keeps first-match priority', () => {
+    assert.equal(matchLifecycle('[ 0] initialization completed with error').event, 'initialized');
+  });
+
+  it('rejects noise', () => {
+    assert.equal(matchLifecycle(samples[11]), null);
+    assert.equal(matchLifecycle(samples[10]), null);
+  });
+});
+
+describe('stripAnsi', () => {
+  it('removes color codes and returns plain lines unchanged', () => {
+    assert.equal(stripAnsi('\x1b[1;31mred\x1b[0m text'), 'red text');
+    const plain = 'no codes here';
+    assert.equal(stripAnsi(plain), plain);
+  });
+});
+
+describe('createLineSplitter', () => {
+  it('splits lines across chunk boundaries', () => {
+    assert.deepEqual(collect(['ab', 'c\nde', 'f\n\ng', 'h']), ['abc', 'def', 'gh']);
+  });
+
+  it('drops trailing \\r and empty lines', () => {
+    assert.deepEqual(collect(['one\r\n\r\ntwo\r\n']), ['one', 'two']);
+  });
+
+  it('decodes multi-byte characters split between chunks', () => {
+    const bytes = Buffer.from('état → ok\n');
+    const chunks = [];
+    for (let i = 0; i < bytes.length; i++) chunks.push(bytes.subarray(i, i + 1));
+    assert.deepEqual(collect(chunks), ['état → ok']);
+  });
+
+  it('flushes an oversized partial line', () => {
+    const lines = collect([Buffer.alloc(MAX_LINE_BYTES + 1, 0x61), 'b\n']);
+    assert.equal(lines.length, 2);
+    assert.equal(lines[0].length, MAX_LINE_BYTES + 1);
+    assert.equal(lines[1], 'b');
+  });
+});
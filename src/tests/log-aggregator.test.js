@@ -0,0 +1,53 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createLogAggregator } from '../lib/log-aggregator.js';
+import { classifyEvent, resetClassifier } from '../lib/event-classifier.js';
+
+const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+
+describe('createLogAggregator', () => {
+  it('emits one frame per window', async () => {
+    const frames = [];
+    const agg = createLogAggregator({ onFrame: f => frames.push(f), windowMs: 20 });
+    for (let i = 0; i < 5; i++) agg.add({ message: `line ${i}`, timestamp: i });
+    assert.equal(frames.length, 0);
+    await sleep(40);
+    assert.equal(frames.length, 1);
+    assert.equal(frames[0].type, 'log_batch');
+    assert.equal(frames[0].message, '5 log lines');
+    assert.deepEqual(frames[0].lines.map(l => l.message), ['line 0', 'line 1', 'line 2', 'line 3', 'line 4']);
+  });
+
+  it('collapses noise into repeat counters', () => {
+    const frames = [];
+    const agg = createLogAggregator({ onFrame: f => frames.push(f) });
+    resetClassifier();
+    for (let i = 0; i < 312; i++) agg.add(classifyEvent('log', ['[ 4][adnl] dropping received message: bad seqno']));
+    agg.add(classifyEvent('log', ['[ 3] something else']));
+    agg.flush();
+    assert.equal(frames.length, 1);
+    assert.deepEqual(frames[0].repeats, [{ message: 'dropping received message', count: 312 }]);
+    assert.equal(frames[0].lines.length, 1);
+  });
+
+  it('caps lines per frame and counts the rest', () => {
+    const frames = [];
+    const agg = createLogAggregator({ onFrame: f => frames.push(f), maxLines: 2 });
+    for (let i = 0; i < 5; i++) agg.add({ message: 'x', timestamp: 0, instance: 1 });
+    agg.flush();
+    assert.equal(frames[0].lines.length, 2);
+    assert.equal(frames[0].lines[0].instance, 1);
+    assert.equal(frames[0].dropped, 3);
+    assert.equal(frames[0].message, '5 log lines');
+  });
+
+  it('does not emit empty frames and reset() discards pending lines', async () => {
+    const frames = [];
+    const agg = createLogAggregator({ onFrame: f => frames.push(f), windowMs: 10 });
+    agg.flush();
+    agg.add({ message: 'x', timestamp: 0 });
+    agg.reset();
+    await sleep(20);
+    assert.equal(frames.length, 0);
+  });
+});
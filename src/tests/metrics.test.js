@@ -0,0 +1,50 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createRegistry } from '../lib/metrics.js';
+
+describe('metrics registry', () => {
+  it('renders counters with sorted, escaped labels', () => {
+    const reg = createRegistry();
+    const c = reg.counter('req_total', 'Requests');
+    c.inc({ route: '/api/x', method: 'GET' });
+    c.inc({ method: 'GET', route: '/api/x' }, 2);
+    c.inc({ method: 'POST', route: 'a"b' });
+    assert.equal(reg.render(), [
+      '# HELP req_total Requests',
+      '# TYPE req_total counter',
+      'req_total{method="GET",route="/api/x"} 3',
+      'req_total{method="POST",route="a\\"b"} 1',
+      '',
+    ].join('\n'));
+  });
+
+  it('renders cumulative histogram buckets, sum and count', () => {
+    const reg = createRegistry();
+    const h = reg.histogram('lat_seconds', 'Latency', [0.1, 1]);
+    h.observe(0.05);
+    h.observe(0.5);
+    h.observe(3);
+    const out = reg.render();
+    assert.match(out, /^lat_seconds_bucket\{le="0.1"\} 1$/m);
+    assert.match(out, /^lat_seconds_bucket\{le="1"\} 2$/m);
+    assert.match(out, /^lat_seconds_bucket\{le="\+Inf"\} 3$/m);
+    assert.match(out, /^lat_seconds_sum 3.55$/m);
+    assert.match(out, /^lat_seconds_count 3$/m);
+  });
+
+  it('runs collectors before rendering and supports gauge reset', () => {
+    const reg = createRegistry();
+    const g = reg.gauge('subs', 'Subscribers');
+    let n = 2;
+    reg.addCollector(() => { g.reset(); if (n) g.set({ instance: 0 }, n); });
+    assert.match(reg.render(), /^subs\{instance="0"\} 2$/m);
+    n = 0;
+    assert.doesNotMatch(reg.render(), /^subs\{/m);
+  });
+
+  it('rejects a name reused with another type', () => {
+    const reg = createRegistry();
+    reg.counter('x', 'x');
+    assert.throws(() => reg.gauge('x', 'x'), /already registered/);
+  });
+});
@@ -0,0 +1,96 @@
+import { describe, it, before, after } from 'node:test';
+import assert from 'node:assert/strict';
+import { createServer as createHttpServer, request } from 'http';
+import { once } from 'events';
+
+process.env.LOG_LEVEL ??= 'silent';
+const { createServer } = await import('../api/server.js');
+const { register } = await import('../api/routes/proxy.js');
+const { setClientState, setProxyReady, clearClientState } = await import('../services/client-state.js');
+
+/** A client-runner that starts every completion stream and never finishes it. */
+function fakeUpstream() {
+  const closed = [];
+  const server = createHttpServer((req, res) => {
+    req.resume();
+    res.writeHead(200, { 'Content-Type': 'text/event-stream' });
+    res.write('data: {"choices":[{"delta":{"content":"hi"}}]}\n\n');
+    // The proxy aborting the request closes this side
+    res.on('close', () => closed.push(req.headers['x-request-id'] ?? null));
+  });
+  return { server, closed };
+}
+
+const until = async (cond, ms = 2000) => {
+  const deadline = Date.now() + ms;
+  while (!cond()) {
+    if (Date.now() > deadline) throw new Error('timed out');
+    await new Promise(r => setTimeout(r, 10));
+  }
+};
+
+describe('chat completion proxy', () => {
+  let api;
+  let upstream;
+  let base;
+
+  before(async () => {
+    upstream = fakeUpstream();
+    upstream.server.listen(0, '127.0.0.1');
+    await once(upstream.server, 'listening');
+    api = createServer(0);
+    register(api.router);
+    if (!api.server.listening) await once(api.server, 'listening');
+    base = { host: '127.0.0.1', port: api.server.address().port };
+    setClientState(upstream.server.address().port, 0);
+    setProxyReady(0);
+  });
+
+  after(() => {
+    clearClientState();
+    api.server.closeAllConnections?.();
+    api.server.close();
+    upstream.server.closeAllConnections?.();
+    upstream.server.close();
+  });
+
+  /** Open a stream and resolve once its first chunk arrives. */
+  function openStream(requestId) {
+    return new Promise((resolve, reject) => {
+      const req = request({
+        ...base, method: 'POST', path: '/api/v1/chat/completions',
+        headers: { Authorization: `Bearer ${api.token}`, 'Content-Type': 'application/json', 'X-Request-Id': requestId },
+      }, (res) => res.once('data', () => resolve({ req, res })));
+      req.on('error', reject);
+      req.end(JSON.stringify({ model: 'm', stream: true, messages: [{ role: 'user', content: 'hi' }] }));
+    });
+  }
+
+  function cancel(id) {
+    return fetch(`http://${base.host}:${base.port}/api/v1/chat/cancel/${id}`, {
+      method: 'POST', headers: { Authorization: `Bearer ${api.token}` },
+    });
+  }
+
+  it('aborts the upstream request when the downstream closes', async () => {
+    const { req } = await openStream('close-downstream-1');
+    assert.deepEqual(upstream.closed, []);
+    req.destroy();
+    await until(() => upstream.closed.length === 1);
+  });
+
+  it('cancels an active stream by id and 404s an unknown one', async () => {
+    const { res } = await openStream('cancel-me-0001');
+    // The proxy destroys the downstream too: the client sees a reset
+    const ended = new Promise(r => res.on('error', () => {}).on('close', r));
+
+    const ok = await cancel('cancel-me-0001');
+    assert.equal(ok.status, 200);
+    assert.deepEqual(await ok.json(), { status: 'cancelled', id: 'cancel-me-0001' });
+    await until(() => upstream.closed.length === 2);
+    await ended;
+
+    assert.equal((await cancel('cancel-me-0001')).status, 404);
+    assert.equal((await cancel('never-started-01')).status, 404);
+  });
+});
@@ -0,0 +1,81 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createReadiness } from '../lib/readiness.js';
+
+const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+const READY = { proxy_connections: [{ is_ready: true }], proxies: [{ tokens_payed: 1 }] };
+const NOT_READY = { proxy_connections: [{ is_ready: false }], proxies: [] };
+
+function fakeProbe(results) {
+  const calls = [];
+  return {
+    calls,
+    probe: async () => {
+      calls.push(Date.now());
+      return results.length > 1 ? results.shift() : results[0];
+    },
+  };
+}
+
+describe('createReadiness', () => {
+  it('does not probe before the client is listening', async () => {
+    const { probe, calls } = fakeProbe([READY]);
+    const r = createReadiness({ probe, backoff: [5] });
+    r.signal('ton_synced');
+    await sleep(30);
+    assert.equal(calls.length, 0);
+    r.cancel();
+    assert.equal(await r.promise, null);
+  });
+
+  it('resolves with the first ready probe, backing off in between', async () => {
+    const { probe, calls } = fakeProbe([NOT_READY, NOT_READY, READY]);
+    const r = createReadiness({ probe, backoff: [5, 10, 20] });
+    r.signal('listening');
+    assert.deepEqual(await r.promise, READY);
+    assert.equal(calls.length, 3);
+    assert.ok(calls[2] - calls[1] >= calls[1] - calls[0]);
+  });
+
+  it('holds probes back while a handshake is in flight', async () => {
+    const { probe, calls } = fakeProbe([READY]);
+    const r = createReadiness({ probe, backoff: [5], handshakeGraceMs: 1000 });
+    r.signal('listening');
+    r.signal('proxy_connecting');
+    await sleep(40);
+    assert.equal(calls.length, 0);
+    r.signal('proxy_ready');
+    assert.deepEqual(await r.promise, READY);
+  });
+
+  it('probes again after the handshake grace period', async () => {
+    const { probe } = fakeProbe([READY]);
+    const r = createReadiness({ probe, backoff: [5], handshakeGraceMs: 30 });
+    r.signal('listening');
+    r.signal('proxy_connecting');
+    assert.deepEqual(await r.promise, READY);
+  });
+
+  it('resolves null when the client exits', async () => {
+    const { probe } = fakeProbe([NOT_READY]);
+    const r = createReadiness({ probe, backoff: [5] });
+    r.signal('listening');
+    r.signal('exit');
+    assert.equal(await r.promise, null);
+  });
+
+  it('records the time spent in each phase', async () => {
+    const { probe } = fakeProbe([READY]);
+    const r = createReadiness({ probe, backoff: [5] });
+    r.signal('ton_synced');
+    r.signal('listening');
+    r.signal('proxy_connecting');
+    r.signal('proxy_ready');
+    r.signal('connection_ready');
+    await r.promise;
+    const phases = r.phases();
+    assert.deepEqual(phases.map(p => p.phase), ['launching', 'synced', 'listening', 'handshaking', 'connected', 'ready']);
+    assert.ok(phases.every(p => p.ms >= 0));
+    assert.ok(phases.find(p => p.phase === 'connected').ms >= 5);
+  });
+});
@@ -0,0 +1,60 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createRouteStats, parseRouteHint } from '../lib/route-stats.js';
+
+const inst = (instance, extra = {}) => ({ instance, inFlight: 0, maxCoefficient: 0, ...extra });
+
+describe('parseRouteHint', () => {
+  it('accepts latency / price only', () => {
+    assert.equal(parseRouteHint(' Latency '), 'latency');
+    assert.equal(parseRouteHint('price'), 'price');
+    assert.equal(parseRouteHint('cheap'), null);
+    assert.equal(parseRouteHint(undefined), null);
+  });
+});
+
+describe('createRouteStats', () => {
+  it('keeps smoothed per-model and per-instance series', () => {
+    const stats = createRouteStats({ alpha: 0.5 });
+    stats.record(0, 'llama', { ttftMs: 100, tokensPerSec: 20, ok: true });
+    stats.record(0, 'llama', { ttftMs: 300, tokensPerSec: null, ok: false });
+    stats.record(0, 'qwen', { ttftMs: 50, tokensPerSec: 40, ok: true });
+    const llama = stats.estimate(0, 'llama');
+    assert.equal(llama.ttftMs, 200);
+    assert.equal(llama.tokensPerSec, 20);
+    assert.equal(llama.errorRate, 0.5);
+    assert.equal(llama.requests, 2);
+    assert.equal(stats.estimate(0, 'unknown').requests, 3);
+    assert.deepEqual(stats.snapshot().map(s => s.model), ['*', 'llama', 'qwen']);
+  });
+
+  it('ranks by measured latency, load and errors; unmeasured first', () => {
+    const stats = createRouteStats();
+    stats.record(0, 'm', { ttftMs: 500, tokensPerSec: 10, ok: true });
+    stats.record(1, 'm', { ttftMs: 200, tokensPerSec: 10, ok: true });
+    const rank = stats.rank('latency', 'm');
+    assert.ok(rank(inst(1)) < rank(inst(0)));
+    // Three requests already on the fast instance make the slow one better
+    assert.ok(rank(inst(1, { inFlight: 3 })) > rank(inst(0)));
+    assert.equal(rank(inst(2)), 0);
+
+    stats.record(1, 'm', { ok: false });
+    stats.record(1, 'm', { ok: false });
+    assert.ok(stats.estimate(1, 'm').errorRate > 0.3);
+    assert.ok(rank(inst(1)) > 200);
+  });
+
+  it('ranks by price cap, uncapped last', () => {
+    const rank = createRouteStats().rank('price', null);
+    assert.ok(rank(inst(0, { maxCoefficient: 800 })) < rank(inst(1, { maxCoefficient: 1500 })));
+    assert.ok(rank(inst(1, { maxCoefficient: 1500 })) < rank(inst(2)));
+  });
+
+  it('forgets an instance', () => {
+    const stats = createRouteStats();
+    stats.record(0, 'm', { ttftMs: 100, ok: true });
+    stats.record(1, 'm', { ttftMs: 100, ok: true });
+    stats.forget(0);
+    assert.deepEqual([...new Set(stats.snapshot().map(s => s.instance))], [1]);
+  });
+});
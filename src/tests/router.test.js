@@ -0,0 +1,68 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createRouter } from '../api/server.js';
+
+const noop = async () => {};
+
+describe('createRouter', () => {
+  it('matches static and parametric segments per method', () => {
+    const router = createRouter();
+    router.get('/api/client/status', noop);
+    router.get('/api/setup/balance/:address', noop);
+    router.post('/api/v1/chat/cancel/:id', noop);
+
+    assert.equal(router.match('GET', '/api/client/status').path, '/api/client/status');
+    assert.deepEqual(router.match('GET', '/api/setup/balance/EQ%2Fabc').params, { address: 'EQ/abc' });
+    assert.deepEqual(router.match('POST', '/api/v1/chat/cancel/r1').params, { id: 'r1' });
+    assert.equal(router.match('GET', '/api/v1/chat/cancel/r1'), null);
+    assert.equal(router.match('GET', '/api/client/status/'), null);
+    assert.equal(router.match('GET', '/api/setup/balance/'), null);
+    assert.equal(router.match('GET', '/api/client'), null);
+  });
+
+  it('prefers static segments and backtracks into params', () => {
+    const router = createRouter();
+    router.get('/api/items/:id', noop);
+    router.get('/api/items/latest', noop);
+    router.get('/api/items/latest/:field', noop);
+    router.get('/api/items/:id/owner', noop);
+    router.get('/api/items/:id/owner/name', noop);
+
+    assert.equal(router.match('GET', '/api/items/latest').path, '/api/items/latest');
+    assert.equal(router.match('GET', '/api/items/7').path, '/api/items/:id');
+    assert.deepEqual(router.match('GET', '/api/items/latest/owner').params, { field: 'owner' });
+    // Nothing under latest/:field goes this deep: back up to :id
+    assert.deepEqual(router.match('GET', '/api/items/latest/owner/name').params, { id: 'latest' });
+    assert.equal(router.match('GET', '/api/items/latest/owner/x'), null);
+    assert.deepEqual(router.match('GET', '/api/items/9/owner').params, { id: '9' });
+  });
+
+  it('resolves per-route options with method defaults', () => {
+    const router = createRouter();
+    router.get('/api/a', noop);
+    router.post('/api/b', noop);
+    router.delete('/api/c', noop);
+    router.post('/api/d', noop, { body: 'raw', maxBodyBytes: 10, log: 0.1 });
+    router.get('/api/e', noop, { auth: true });
+    router.get('/api/events', noop, { stream: true });
+
+    const opts = (method, path) => {
+      const { body, auth, log, maxBodyBytes } = router.match(method, path).route;
+      return { body, auth, log, maxBodyBytes };
+    };
+    assert.deepEqual(opts('GET', '/api/a'), { body: 'none', auth: false, log: 0, maxBodyBytes: 1048576 });
+    assert.deepEqual(opts('POST', '/api/b'), { body: 'json', auth: true, log: 1, maxBodyBytes: 1048576 });
+    assert.deepEqual(opts('DELETE', '/api/c'), { body: 'none', auth: true, log: 1, maxBodyBytes: 1048576 });
+    assert.deepEqual(opts('POST', '/api/d'), { body: 'raw', auth: true, log: 0.1, maxBodyBytes: 10 });
+    assert.equal(opts('GET', '/api/e').auth, true);
+    assert.equal(router.match('GET', '/api/a').route.stream, false);
+    assert.equal(router.match('GET', '/api/events').route.stream, true);
+  });
+
+  it('rejects duplicate routes and unknown body modes', () => {
+    const router = createRouter();
+    router.get('/api/a/:x', noop);
+    assert.throws(() => router.get('/api/a/:y', noop), /Duplicate route/);
+    assert.throws(() => router.post('/api/b', noop, { body: 'form' }), /unknown body mode/);
+  });
+});
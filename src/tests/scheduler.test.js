@@ -0,0 +1,61 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createScheduler } from '../lib/scheduler.js';
+
+const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+
+describe('createScheduler', () => {
+  it('grants the burst immediately, then refills at the rate', async () => {
+    const s = createScheduler({ ratePerSec: 20, burst: 2 });
+    const start = Date.now();
+    const times = [];
+    await Promise.all([1, 2, 3, 4].map(() => s.take().then(() => times.push(Date.now() - start))));
+    assert.ok(times[1] < 20, `burst granted at ${times[1]}ms`);
+    assert.ok(times[3] >= 90, `4th token at ${times[3]}ms, expected ~100ms`);
+    assert.equal(s.stats().granted, 4);
+  });
+
+  it('serves user requests before queued background ones', async () => {
+    const s = createScheduler({ ratePerSec: 50, burst: 1 });
+    await s.take();
+    const order = [];
+    const waits = [
+      s.take('background').then(() => order.push('bg1')),
+      s.take('background').then(() => order.push('bg2')),
+      s.take('user').then(() => order.push('user')),
+    ];
+    assert.deepEqual(s.depth(), { user: 1, background: 2 });
+    await Promise.all(waits);
+    assert.deepEqual(order, ['user', 'bg1', 'bg2']);
+  });
+
+  it('runs identical in-flight work once', async () => {
+    const s = createScheduler({ ratePerSec: 10 });
+    let calls = 0;
+    const fn = async () => { calls++; await sleep(10); return calls; };
+    const results = await Promise.all([1, 2, 3].map(() => s.schedule(fn, { key: 'balance:a' })));
+    assert.deepEqual(results, [1, 1, 1]);
+    assert.equal(s.stats().deduped, 2);
+    assert.equal(s.stats().inflight, 0);
+    assert.equal(await s.schedule(fn, { key: 'balance:a' }), 2);
+  });
+
+  it('pause() holds every waiter until it expires', async () => {
+    const s = createScheduler({ ratePerSec: 100, burst: 5 });
+    s.pause(60);
+    const start = Date.now();
+    await s.take('user');
+    assert.ok(Date.now() - start >= 55);
+    assert.equal(s.stats().paused, 1);
+  });
+
+  it('reports how long each grant waited', async () => {
+    const waits = [];
+    const s = createScheduler({ ratePerSec: 50, burst: 1, onWait: (p, ms) => waits.push([p, ms]) });
+    await s.take('user');
+    await s.take('background');
+    assert.equal(waits[0][0], 'user');
+    assert.ok(waits[0][1] < 5);
+    assert.ok(waits[1][1] >= 15);
+  });
+});
@@ -0,0 +1,127 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createRingBuffer, createBroadcaster } from '../lib/sse-broadcaster.js';
+
+function fakeRes() {
+  return {
+    chunks: [],
+    writableLength: 0,
+    destroyed: false,
+    write(chunk) { this.chunks.push(chunk); return true; },
+    destroy() { this.destroyed = true; },
+    get text() { return this.chunks.join(''); },
+  };
+}
+
+function ids(text) {
+  return [...text.matchAll(/^id: (\d+)$/gm)].map(m => Number(m[1]));
+}
+
+describe('createRingBuffer', () => {
+  it('keeps the newest entries in order', () => {
+    const ring = createRingBuffer(3);
+    for (let i = 1; i <= 5; i++) ring.push(i);
+    assert.deepEqual(ring.toArray(), [3, 4, 5]);
+    assert.deepEqual(ring.toArray(2), [4, 5]);
+    assert.equal(ring.size, 3);
+    ring.clear();
+    assert.deepEqual(ring.toArray(), []);
+  });
+});
+
+describe('createBroadcaster', () => {
+  it('serializes once and assigns increasing ids', () => {
+    const b = createBroadcaster();
+    const a = fakeRes();
+    const c = fakeRes();
+    b.add(a);
+    b.add(c);
+    let calls = 0;
+    b.publish({ type: 'x', toJSON() { calls++; return { type: 'x' }; } });
+    b.publish({ type: 'y' });
+    assert.equal(calls, 1);
+    assert.equal(a.text, 'id: 1\ndata: {"type":"x"}\n\nid: 2\ndata: {"type":"y"}\n\n');
+    assert.equal(c.text, a.text);
+  });
+
+  it('replays only events after Last-Event-ID', () => {
+    const b = createBroadcaster({ capacity: 10 });
+    for (let i = 0; i < 6; i++) b.publish({ n: i });
+    const res = fakeRes();
+    b.add(res, '4');
+    assert.deepEqual(ids(res.text), [5, 6]);
+  });
+
+  it('replays the latest events for a new or unknown id', () => {
+    const b = createBroadcaster({ capacity: 10, replay: 3 });
+    for (let i = 0; i < 6; i++) b.publish({ n: i });
+    const fresh = fakeRes();
+    b.add(fresh);
+    assert.deepEqual(ids(fresh.text), [4, 5, 6]);
+    const restarted = fakeRes();
+    b.add(restarted, '999');
+    assert.deepEqual(ids(restarted.text), [4, 5, 6]);
+  });
+
+  it('does not buffer send() messages', () => {
+    const b = createBroadcaster();
+    const live = fakeRes();
+    b.add(live);
+    b.send({ type: 'stats_patch' });
+    assert.equal(live.text, 'data: {"type":"stats_patch"}\n\n');
+    assert.deepEqual(b.recent(), []);
+  });
+
+  it('drops messages for and then disconnects slow clients', () => {
+    const shed = [];
+    const b = createBroadcaster({ highWaterMark: 100, onShed: r => shed.push(r) });
+    const slow = fakeRes();
+    const fast = fakeRes();
+    b.add(slow);
+    b.add(fast);
+    slow.writableLength = 101;
+    b.send({ type: 'stats_patch' });
+    assert.equal(slow.chunks.length, 0);
+    assert.equal(fast.chunks.length, 1);
+    b.publish({ type: 'log' });
+    assert.equal(slow.destroyed, true);
+    assert.equal(b.size, 1);
+    assert.deepEqual(shed, ['dropped', 'disconnected']);
+  });
+
+  it('sends a resync snapshot to a client that missed a patch', () => {
+    const b = createBroadcaster({ highWaterMark: 100 });
+    const stats = { seq: 1, value: 'a' };
+    const snapshot = () => ({ type: 'stats_snapshot', seq: stats.seq, value: stats.value });
+    const patch = (seq, value) => {
+      Object.assign(stats, { seq, value });
+      b.send({ type: 'stats_patch', seq, value }, { resync: snapshot });
+    };
+    const slow = fakeRes();
+    const fast = fakeRes();
+    b.add(slow);
+    b.add(fast);
+
+    slow.writableLength = 101;
+    patch(2, 'b');
+    slow.writableLength = 0;
+    patch(3, 'c');
+    patch(4, 'd');
+
+    const received = (res) => res.chunks.map(c => JSON.parse(c.slice('data: '.length)));
+    assert.deepEqual(received(fast).map(m => m.type), ['stats_patch', 'stats_patch', 'stats_patch']);
+    // The snapshot carries the seq patch 4 applies on top of: no gap, no refetch
+    assert.deepEqual(received(slow), [
+      { type: 'stats_snapshot', seq: 3, value: 'c' },
+      { type: 'stats_patch', seq: 4, value: 'd' },
+    ]);
+  });
+
+  it('keeps ids increasing across clear()', () => {
+    const b = createBroadcaster();
+    b.publish({});
+    b.clear();
+    assert.equal(b.publish({}), 2);
+    assert.equal(b.recent().length, 1);
+  });
+});
@@ -0,0 +1,71 @@
+import { describe, it, before, after } from 'node:test';
+import assert from 'node:assert/strict';
+import { mkdtempSync, rmSync, readFileSync } from 'fs';
+import { resolve } from 'path';
+import { tmpdir } from 'os';
+import { percentile, summarize } from '../lib/stats.js';
+import {
+  startTrace, getStartupHistory, setStartupHistoryPath, STARTUP_PHASES, MAX_RUNS,
+} from '../services/startup-history.js';
+
+describe('percentile', () => {
+  it('interpolates between ranks', () => {
+    assert.equal(percentile([1, 2, 3, 4], 50), 2.5);
+    assert.equal(percentile([10, 0, 20], 50), 10);
+    assert.equal(percentile([1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21], 95), 20);
+    assert.equal(percentile([], 50), null);
+  });
+
+  it('summarizes', () => {
+    assert.deepEqual(summarize([3, 1, 2]), { count: 3, min: 1, max: 3, p50: 2, p95: 2.9 });
+  });
+});
+
+describe('startup history', () => {
+  let dir;
+  const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+  before(() => {
+    dir = mkdtempSync(resolve(tmpdir(), 'cocoon-history-test-'));
+    setStartupHistoryPath(resolve(dir, 'startup-history.json'));
+  });
+  after(() => { rmSync(dir, { recursive: true, force: true }); });
+
+  it('finishes a trace once every phase is reached and persists it', async () => {
+    const trace = startTrace(0, { warm: true });
+    for (const phase of STARTUP_PHASES) {
+      await sleep(2);
+      trace.mark(phase);
+    }
+    const history = getStartupHistory();
+    assert.equal(history.runs.length, 1);
+    assert.equal(history.runs[0].outcome, 'ready');
+    assert.equal(history.warm.ready.count, 1);
+    assert.equal(history.cold.ready.count, 0);
+    const phases = history.runs[0].phases;
+    assert.ok(phases.ready >= phases.ton_synced);
+    const onDisk = JSON.parse(readFileSync(resolve(dir, 'startup-history.json'), 'utf-8'));
+    assert.equal(onDisk.runs.length, 1);
+  });
+
+  it('keeps the first timestamp and records partial runs', () => {
+    const trace = startTrace(1);
+    trace.mark('ton_synced');
+    const first = getStartupHistory().runs.length;
+    trace.mark('ton_synced');
+    trace.finish('crashed');
+    trace.finish('stopped');
+    const history = getStartupHistory();
+    assert.equal(history.runs.length, first + 1);
+    assert.equal(history.runs[0].outcome, 'crashed');
+    assert.deepEqual(Object.keys(history.runs[0].phases), ['ton_synced']);
+    assert.equal(history.summary.ton_synced.count, 2);
+    assert.equal(history.summary.ready.count, 1);
+  });
+
+  it('keeps only the last MAX_RUNS runs', () => {
+    for (let i = 0; i < MAX_RUNS + 5; i++) startTrace(2).finish('stopped');
+    assert.equal(getStartupHistory().runs.length, MAX_RUNS);
+    setStartupHistoryPath(resolve(dir, 'startup-history.json'));
+    assert.equal(getStartupHistory().runs.length, MAX_RUNS);
+  });
+});
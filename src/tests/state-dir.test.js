@@ -0,0 +1,57 @@
+import { describe, it, beforeEach, afterEach } from 'node:test';
+import assert from 'node:assert/strict';
+import { mkdtempSync, rmSync, writeFileSync, existsSync, statSync, chmodSync, readFileSync } from 'fs';
+import { resolve } from 'path';
+import { tmpdir } from 'os';
+import { openStateDir, checkStateDir, stateFingerprint } from '../lib/state-dir.js';
+
+describe('openStateDir', () => {
+  let root;
+  beforeEach(() => { root = mkdtempSync(resolve(tmpdir(), 'cocoon-state-test-')); });
+  afterEach(() => { rmSync(root, { recursive: true, force: true }); });
+
+  const fp = stateFingerprint(['ton-config', 'key']);
+
+  it('starts cold, then warm with the same inputs', () => {
+    const first = openStateDir(0, fp, { root });
+    assert.equal(first.warm, false);
+    assert.equal(first.reason, 'missing');
+    assert.equal(statSync(first.dir).mode & 0o777, 0o700);
+    writeFileSync(resolve(first.dir, 'keystore'), 'x');
+
+    const second = openStateDir(0, fp, { root });
+    assert.equal(second.warm, true);
+    assert.equal(readFileSync(resolve(second.dir, 'keystore'), 'utf-8'), 'x');
+  });
+
+  it('wipes state when inputs change', () => {
+    const { dir } = openStateDir(1, fp, { root });
+    writeFileSync(resolve(dir, 'keystore'), 'x');
+    const next = openStateDir(1, stateFingerprint(['ton-config', 'other-key']), { root });
+    assert.equal(next.warm, false);
+    assert.equal(next.reason, 'inputs changed');
+    assert.equal(existsSync(resolve(dir, 'keystore')), false);
+  });
+
+  it('wipes state on a forced cold start', () => {
+    const { dir } = openStateDir(2, fp, { root });
+    writeFileSync(resolve(dir, 'keystore'), 'x');
+    const next = openStateDir(2, fp, { root, coldStart: true });
+    assert.equal(next.warm, false);
+    assert.equal(existsSync(resolve(dir, 'keystore')), false);
+  });
+
+  it('rejects directories with open permissions or a broken manifest', () => {
+    const { dir } = openStateDir(3, fp, { root });
+    chmodSync(dir, 0o755);
+    assert.equal(checkStateDir(dir, fp), 'permissions too open');
+    chmodSync(dir, 0o700);
+    writeFileSync(resolve(dir, 'state.json'), '{');
+    assert.equal(checkStateDir(dir, fp), 'manifest unreadable');
+  });
+
+  it('never stores the fingerprint inputs', () => {
+    const { dir } = openStateDir(4, stateFingerprint(['cfg', 'secret-wallet-key']), { root });
+    assert.equal(readFileSync(resolve(dir, 'state.json'), 'utf-8').includes('secret-wallet-key'), false);
+  });
+});
@@ -0,0 +1,90 @@
+import { describe, it, beforeEach, afterEach } from 'node:test';
+import assert from 'node:assert/strict';
+import { mkdtempSync, mkdirSync, rmSync, writeFileSync } from 'fs';
+import { tmpdir } from 'os';
+import { join } from 'path';
+import { brotliDecompressSync, gunzipSync } from 'zlib';
+import { createStaticAssets, isNotModified, negotiateEncoding } from '../lib/static-assets.js';
+
+describe('negotiateEncoding', () => {
+  it('prefers brotli, honours q-values and falls back to identity', () => {
+    assert.equal(negotiateEncoding('gzip, deflate, br', ['br', 'gzip']), 'br');
+    assert.equal(negotiateEncoding('gzip', ['br', 'gzip']), 'gzip');
+    assert.equal(negotiateEncoding('br;q=0.5, gzip;q=0.8', ['br', 'gzip']), 'gzip');
+    assert.equal(negotiateEncoding('br;q=0', ['br']), 'identity');
+    assert.equal(negotiateEncoding('*', ['br', 'gzip']), 'br');
+    assert.equal(negotiateEncoding(undefined, ['br']), 'identity');
+    assert.equal(negotiateEncoding('br', []), 'identity');
+  });
+});
+
+describe('isNotModified', () => {
+  const asset = { etag: '"abc"', mtimeMs: Date.parse('2026-01-01T00:00:00.500Z') };
+
+  it('matches ETags of any variant', () => {
+    assert.equal(isNotModified({ 'if-none-match': '"abc"' }, asset), true);
+    assert.equal(isNotModified({ 'if-none-match': 'W/"abc-br"' }, asset), true);
+    assert.equal(isNotModified({ 'if-none-match': '"x", "abc-gz"' }, asset), true);
+    assert.equal(isNotModified({ 'if-none-match': '"other"' }, asset), false);
+  });
+
+  it('uses If-Modified-Since only without If-None-Match, at second precision', () => {
+    assert.equal(isNotModified({ 'if-modified-since': 'Thu, 01 Jan 2026 00:00:00 GMT' }, asset), true);
+    assert.equal(isNotModified({ 'if-modified-since': 'Wed, 31 Dec 2025 23:59:59 GMT' }, asset), false);
+    assert.equal(isNotModified({ 'if-none-match': '"other"', 'if-modified-since': 'Thu, 01 Jan 2026 00:00:00 GMT' }, asset), false);
+    assert.equal(isNotModified({}, asset), false);
+  });
+});
+
+describe('createStaticAssets', () => {
+  let dir;
+  let assets;
+  beforeEach(() => {
+    dir = mkdtempSync(join(tmpdir(), 'cocoon-static-'));
+    mkdirSync(join(dir, 'assets'));
+  });
+  afterEach(() => {
+    assets?.close();
+    rmSync(dir, { recursive: true, force: true });
+  });
+
+  it('serves files with SPA fallback and compresses text in the background', async () => {
+    const js = 'console.log("hello");\n'.repeat(200);
+    writeFileSync(join(dir, 'index.html'), '<!doctype html><p>app</p>');
+    writeFileSync(join(dir, 'assets', 'app-1234.js'), js);
+    assets = createStaticAssets({ root: dir });
+    await assets.ready();
+
+    const app = assets.lookup('/assets/app-1234.js');
+    assert.equal(app.contentType, 'application/javascript');
+    assert.equal(app.cacheControl, 'public, max-age=31536000, immutable');
+    assert.equal(brotliDecompressSync(app.variants.br).toString(), js);
+    assert.equal(gunzipSync(app.variants.gzip).toString(), js);
+
+    const index = assets.lookup('/');
+    assert.equal(index.cacheControl, 'no-cache');
+    // Too small to compress
+    assert.deepEqual(Object.keys(index.variants), ['identity']);
+    assert.equal(assets.lookup('/wallet/settings'), index);
+    assert.equal(assets.size, 2);
+  });
+
+  it('uses precompressed siblings instead of listing them', async () => {
+    writeFileSync(join(dir, 'index.html'), 'x'.repeat(4096));
+    writeFileSync(join(dir, 'index.html.br'), 'prebuilt-br');
+    assets = createStaticAssets({ root: dir });
+    await assets.ready();
+    assert.equal(assets.size, 1);
+    assert.equal(assets.lookup('/index.html').variants.br.toString(), 'prebuilt-br');
+    assert.ok(assets.lookup('/index.html').variants.gzip);
+  });
+
+  it('returns null when nothing is built and picks up a rebuild on load()', () => {
+    assets = createStaticAssets({ root: join(dir, 'dist') });
+    assert.equal(assets.lookup('/'), null);
+    mkdirSync(join(dir, 'dist'));
+    writeFileSync(join(dir, 'dist', 'index.html'), 'v2');
+    assert.equal(assets.load(), 1);
+    assert.equal(assets.lookup('/').variants.identity.toString(), 'v2');
+  });
+});
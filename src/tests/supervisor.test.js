@@ -0,0 +1,57 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createRestartPolicy, exitReason } from '../lib/supervisor.js';
+
+describe('exitReason', () => {
+  it('detects proxy stake rejection', () => {
+    assert.equal(exitReason(['[ 0] Error : 653 : cancelled']), 'stake_unconfirmed');
+    assert.equal(exitReason('Segmentation fault'), 'crash');
+  });
+});
+
+describe('createRestartPolicy', () => {
+  it('backs off exponentially up to the cap', () => {
+    let t = 0;
+    const policy = createRestartPolicy({ baseDelayMs: 100, maxDelayMs: 500, crashLoopCount: 100 }, () => (t += 60_000));
+    const delays = Array.from({ length: 5 }, () => policy.onExit('crash').delayMs);
+    assert.deepEqual(delays, [100, 200, 400, 500, 500]);
+    policy.onHealthy();
+    assert.equal(policy.onExit('crash').delayMs, 100);
+  });
+
+  it('gives up on a crash loop inside the window only', () => {
+    let t = 0;
+    const policy = createRestartPolicy({ crashLoopCount: 3, crashLoopWindowMs: 1000 }, () => t);
+    assert.equal(policy.onExit('crash').action, 'restart');
+    t = 2000;
+    assert.equal(policy.onExit('crash').action, 'restart');
+    t = 2100;
+    assert.equal(policy.onExit('crash').action, 'restart');
+    t = 2200;
+    const decision = policy.onExit('crash');
+    assert.equal(decision.action, 'give_up');
+    assert.match(decision.why, /crash loop/);
+  });
+
+  it('still detects a crash loop when each run reaches ready first', () => {
+    let t = 0;
+    const policy = createRestartPolicy({ crashLoopCount: 3, crashLoopWindowMs: 10_000 }, () => t);
+    const cycle = () => {
+      policy.onHealthy();
+      t += 1000;
+      return policy.onExit('crash');
+    };
+    assert.deepEqual(cycle(), { action: 'restart', delayMs: 1000 });
+    assert.deepEqual(cycle(), { action: 'restart', delayMs: 1000 });
+    const decision = cycle();
+    assert.equal(decision.action, 'give_up');
+    assert.match(decision.why, /3 crashes/);
+  });
+
+  it('retries unconfirmed stake on a fixed delay, boundedly', () => {
+    const policy = createRestartPolicy({ stakeRetryDelayMs: 60_000, maxStakeRetries: 2 });
+    assert.deepEqual(policy.onExit('stake_unconfirmed'), { action: 'restart', delayMs: 60_000 });
+    assert.deepEqual(policy.onExit('stake_unconfirmed'), { action: 'restart', delayMs: 60_000 });
+    assert.equal(policy.onExit('stake_unconfirmed').action, 'give_up');
+  });
+});
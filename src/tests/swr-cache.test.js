@@ -0,0 +1,65 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import { createSwrCache } from '../lib/swr-cache.js';
+
+const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+
+describe('createSwrCache', () => {
+  it('coalesces concurrent misses into one load', async () => {
+    const cache = createSwrCache({ ttlMs: 1000 });
+    let calls = 0;
+    const loader = async () => { calls++; await sleep(20); return calls; };
+
+    const results = await Promise.all([1, 2, 3].map(() => cache.get('k', loader)));
+    assert.equal(calls, 1);
+    assert.deepEqual(results.map(r => r.value), [1, 1, 1]);
+    assert.deepEqual(results.map(r => r.source), ['miss', 'coalesced', 'coalesced']);
+
+    const again = await cache.get('k', loader);
+    assert.equal(again.source, 'hit');
+    assert.deepEqual(cache.stats(), { hits: 1, staleHits: 0, misses: 1, coalesced: 2, refreshes: 0, errors: 0, entries: 1, inflight: 0 });
+  });
+
+  it('serves stale values while a single refresh runs', async () => {
+    const cache = createSwrCache({ ttlMs: 10, staleMs: 1000 });
+    let calls = 0;
+    const loader = async () => { calls++; await sleep(20); return calls; };
+
+    await cache.get('k', loader);
+    await sleep(15);
+    const [a, b] = await Promise.all([cache.get('k', loader), cache.get('k', loader)]);
+    assert.equal(a.source, 'stale');
+    assert.equal(b.source, 'stale');
+    assert.equal(a.value, 1);
+    await sleep(30);
+    assert.equal(calls, 2);
+    assert.equal(cache.stats().refreshes, 1);
+    assert.equal((await cache.get('k', loader)).value, 2);
+  });
+
+  it('shares failures with every waiter and does not cache them', async () => {
+    const cache = createSwrCache({ ttlMs: 1000 });
+    let calls = 0;
+    const loader = async () => { calls++; await sleep(5); throw new Error('down'); };
+
+    const results = await Promise.allSettled([cache.get('k', loader), cache.get('k', loader)]);
+    assert.equal(calls, 1);
+    assert.ok(results.every(r => r.status === 'rejected' && r.reason.message === 'down'));
+    assert.equal(cache.stats().errors, 1);
+    assert.equal(cache.stats().entries, 0);
+  });
+
+  it('skips values rejected by shouldCache', async () => {
+    const cache = createSwrCache({ ttlMs: 1000, shouldCache: (v) => v.status < 400 });
+    await cache.get('k', async () => ({ status: 503 }));
+    assert.equal(cache.stats().entries, 0);
+  });
+
+  it('drops loads that settle after clear()', async () => {
+    const cache = createSwrCache({ ttlMs: 1000 });
+    const pending = cache.get('k', async () => { await sleep(10); return 'old'; });
+    cache.clear();
+    await pending;
+    assert.equal(cache.stats().entries, 0);
+  });
+});
@@ -0,0 +1,153 @@
+import { describe, it } from 'node:test';
+import assert from 'node:assert/strict';
+import {
+  SC_STATE, createRun, driveRun, fundsLandedNano, overallStep, reconcileRun, unstakeableProxies,
+} from '../lib/unstake-machine.js';
+
+const sleep = (ms) => new Promise(r => setTimeout(r, ms));
+
+function fakeOps(overrides = {}) {
+  const calls = [];
+  const ops = {
+    request: async (action, proxy) => { calls.push(`${action}:${proxy}`); return { ok: true, message: 'request sent' }; },
+    waitClosed: async (proxy) => { calls.push(`wait:${proxy}`); await sleep(50); return { state: SC_STATE.CLOSED }; },
+    waitFunds: async () => { calls.push('funds'); return true; },
+    transfer: async () => { calls.push('transfer'); return { seqno: 7 }; },
+    waitTransfer: async (seqno) => { calls.push(`confirm:${seqno}`); return true; },
+    ...overrides,
+  };
+  return { ops, calls };
+}
+
+const PROXIES = [
+  { proxy_sc_address: 'P1', state: SC_STATE.ACTIVE, tokens_payed: 5 },
+  { proxy_sc_address: 'P2', state: SC_STATE.CLOSING, tokens_payed: 3 },
+];
+
+describe('unstakeableProxies', () => {
+  it('skips active proxies without escrow', () => {
+    const list = unstakeableProxies({ proxies: [...PROXIES, { proxy_sc_address: 'P3', state: SC_STATE.ACTIVE, tokens_payed: 0 }] });
+    assert.deepEqual(list.map(p => p.proxy_sc_address), ['P1', 'P2']);
+  });
+});
+
+describe('driveRun', () => {
+  it('drives every proxy in parallel, then transfers once', async () => {
+    const run = createRun(PROXIES, 0n);
+    assert.deepEqual(run.proxies.map(p => p.step), ['active', 'close_sent']);
+    const { ops, calls } = fakeOps();
+    const saves = [];
+    const steps = [];
+    const start = Date.now();
+    await driveRun(run, ops, { save: (r) => saves.push(overallStep(r)), onStep: (e) => steps.push(`${e.target}:${e.step}`) });
+
+    assert.equal(run.status, 'done');
+    assert.ok(Date.now() - start < 90, 'proxies waited on concurrently');
+    assert.deepEqual(run.proxies.map(p => p.step), ['settled', 'settled']);
+    assert.equal(run.transfer.step, 'confirmed');
+    assert.deepEqual(calls.filter(c => c === 'transfer'), ['transfer']);
+    assert.ok(steps.includes('P1:close_sent') && steps.includes('P2:closed') && steps.includes('transfer:confirmed'));
+    assert.equal(typeof run.proxies[0].timings.closed, 'number');
+    assert.equal(saves.at(-1), 'done');
+  });
+
+  it('resumes from the saved step without re-sending requests', async () => {
+    let saved;
+    const first = fakeOps({ waitClosed: async () => null });
+    const run = createRun([PROXIES[0]], 0n);
+    await driveRun(run, first.ops, { save: (r) => { saved = JSON.parse(JSON.stringify(r)); } });
+    assert.equal(run.status, 'failed');
+    assert.match(run.error, /not closed yet/);
+    assert.equal(saved.proxies[0].step, 'close_sent');
+
+    const second = fakeOps();
+    await driveRun(saved, second.ops);
+    assert.equal(saved.status, 'done');
+    assert.ok(!second.calls.includes('close:P1'), 'close not sent twice');
+    assert.ok(second.calls.includes('withdraw:P1'));
+  });
+
+  it('does not transfer again once a transfer was sent', async () => {
+    const run = createRun([{ proxy_sc_address: 'P1', state: SC_STATE.CLOSED }], 0n);
+    run.proxies[0].step = 'settled';
+    run.transfer.step = 'sent';
+    run.transfer.seqno = 4;
+    const { ops, calls } = fakeOps();
+    await driveRun(run, ops);
+    assert.deepEqual(calls, ['confirm:4']);
+    assert.equal(run.transfer.step, 'confirmed');
+  });
+
+  it('keeps an unconfirmed transfer resumable and only re-checks it', async () => {
+    const run = createRun([{ proxy_sc_address: 'P1', state: SC_STATE.CLOSED }], 0n);
+    run.proxies[0].step = 'settled';
+    const first = fakeOps({ waitTransfer: async () => false });
+    await driveRun(run, first.ops);
+    assert.equal(run.status, 'failed');
+    assert.match(run.error, /transfer unconfirmed/);
+    assert.equal(run.transfer.step, 'sent');
+
+    const second = fakeOps();
+    await driveRun(run, second.ops);
+    assert.deepEqual(second.calls, ['confirm:7']);
+    assert.equal(run.status, 'done');
+    assert.equal(run.transfer.step, 'confirmed');
+  });
+
+  it('waits for the escrow of every withdrawn proxy, less fees', async () => {
+    const run = createRun([
+      { proxy_sc_address: 'P1', state: SC_STATE.CLOSED, tokens_payed: 400_000_000 },
+      { proxy_sc_address: 'P2', state: SC_STATE.CLOSED, tokens_payed: 2_500_000_000 },
+    ], 10_000_000_000n);
+    let waitedFor = null;
+    const { ops } = fakeOps({ waitFunds: async (minNano) => { waitedFor = minNano; return true; } });
+    await driveRun(run, ops);
+    assert.equal(waitedFor, 10_000_000_000n + 2_900_000_000n - 200_000_000n);
+    // Escrow smaller than the fee margin: any growth over the baseline
+    assert.equal(fundsLandedNano('5', [{ expectedNano: '1000' }]), 6n);
+  });
+
+  it('treats a removed proxy and "proxy not found" as settled', async () => {
+    const run = createRun([PROXIES[1], { proxy_sc_address: 'P3', state: SC_STATE.CLOSED }], 0n);
+    const { ops, calls } = fakeOps({
+      waitClosed: async () => ({ removed: true }),
+      request: async () => ({ ok: false, message: 'proxy not found' }),
+    });
+    await driveRun(run, ops);
+    assert.equal(run.status, 'done');
+    assert.deepEqual(run.proxies.map(p => p.step), ['settled', 'settled']);
+    assert.ok(!calls.includes('funds'), 'no withdraw in flight, nothing to wait for');
+  });
+
+  it('reconciles a saved run with the current proxies before resuming', () => {
+    const run = createRun(PROXIES, 0n);
+    run.proxies[0].step = 'close_sent';
+    run.proxies[0].error = 'close: timeout';
+    const changes = reconcileRun(run, {
+      proxies: [
+        { proxy_sc_address: 'P1', state: SC_STATE.CLOSED, tokens_payed: 5 },
+        { proxy_sc_address: 'P4', state: SC_STATE.ACTIVE, tokens_payed: 2 },
+      ],
+    });
+    assert.deepEqual(changes, { added: ['P4'], removed: ['P2'], deferred: [] });
+    assert.deepEqual(run.proxies.map(p => `${p.address}:${p.step}`), ['P1:closed', 'P2:settled', 'P4:active']);
+    assert.equal(run.proxies[0].error, null);
+    assert.deepEqual(run.proxies.map(p => p.expectedNano), ['5', '3', '2']);
+
+    // Once the transfer went out, new stake waits for the next run
+    run.transfer.step = 'sent';
+    const later = reconcileRun(run, { proxies: [{ proxy_sc_address: 'P5', state: SC_STATE.ACTIVE, tokens_payed: 1 }] });
+    assert.deepEqual(later.deferred, ['P5']);
+    assert.equal(run.proxies.length, 3);
+  });
+
+  it('reports the coarse step for the WebUI', () => {
+    const run = createRun(PROXIES, 0n);
+    assert.equal(overallStep(run), 'closing');
+    run.proxies.forEach(p => { p.step = 'closed'; });
+    assert.equal(overallStep(run), 'withdrawing');
+    run.proxies.forEach(p => { p.step = 'settled'; });
+    assert.equal(overallStep(run), 'transferring');
+    assert.equal(overallStep(null), null);
+  });
+});
@@ -5,6 +5,7 @@ import cocoonAnim from '../assets/cocoon.json';
 import userAnim from '../assets/user.json';
 import type { ChatMessage } from '../stores/chatStore';
 import { cn } from '../lib/utils';
+import { splitMarkdownBlocks } from '../lib/markdownBlocks';
 import { Bot, ChevronDown, Copy, Check } from 'lucide-react';
 
 interface Props {
@@ -18,6 +19,22 @@ function parseThinking(content: string): { thinking: string; reply: string } {
   return { thinking: match[1].trim(), reply: content.slice(match[0].length) };
 }
 
+const MarkdownBlock = memo(function MarkdownBlock({ text }: { text: string }) {
+  return <ReactMarkdown>{text}</ReactMarkdown>;
+});
+
+/** Streaming reply: closed blocks are memoized, only the open tail block re-parses per update. */
+function StreamingMarkdown({ text }: { text: string }) {
+  const blocks = splitMarkdownBlocks(text);
+  return (
+    <>
+      {blocks.map((block, i) => (
+        <MarkdownBlock key={i} text={block} />
+      ))}
+    </>
+  );
+}
+
 const MessageBubble = memo(function MessageBubble({ message, isStreaming }: Props) {
   const isUser = message.role === 'user';
   const [thinkOpen, setThinkOpen] = useState(false);
@@ -75,7 +92,9 @@ const MessageBubble = memo(function MessageBubble({ message, isStreaming }: Prop
             {/* Reply content */}
             <div className="px-4 py-2.5">
               <div className="prose prose-invert prose-sm max-w-none">
-                {reply ? (
+                {reply && isStreaming ? (
+                  <StreamingMarkdown text={reply} />
+                ) : reply ? (
                   <ReactMarkdown>{reply}</ReactMarkdown>
                 ) : isStreaming && !isThinking ? (
                   <Lottie animationData={cocoonAnim} loop className="h-6 w-6" />
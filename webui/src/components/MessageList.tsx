@@ -1,24 +1,38 @@
-import { useEffect, useRef } from 'react';
-import type { ChatMessage } from '../stores/chatStore';
+import { useLayoutEffect, useRef } from 'react';
+import type { ChatMessage, StreamingMessage } from '../stores/chatStore';
+import { useVirtualList } from '../hooks/useVirtualList';
 import MessageBubble from './MessageBubble';
 
 interface Props {
   messages: ChatMessage[];
+  streaming: StreamingMessage | null;
   isStreaming: boolean;
 }
 
-export default function MessageList({ messages, isStreaming }: Props) {
-  const endRef = useRef<HTMLDivElement>(null);
+// Within this distance of the bottom the list keeps following new content
+const PIN_THRESHOLD_PX = 80;
+
+export default function MessageList({ messages, streaming, isStreaming }: Props) {
+  const { container, containerRef, measureRef, onScroll, start, end, padTop, padBottom, totalHeight } =
+    useVirtualList<HTMLDivElement>(messages.map((m) => m.id));
+  const pinnedRef = useRef(true);
   const prevCountRef = useRef(messages.length);
 
-  useEffect(() => {
+  const handleScroll = () => {
+    if (container) {
+      pinnedRef.current = container.scrollHeight - container.scrollTop - container.clientHeight < PIN_THRESHOLD_PX;
+    }
+    onScroll();
+  };
+
+  // Follow the conversation: always on a new message, while streaming only if pinned to the bottom
+  useLayoutEffect(() => {
     const isNewMessage = messages.length !== prevCountRef.current;
     prevCountRef.current = messages.length;
-
-    endRef.current?.scrollIntoView({
-      behavior: isStreaming && !isNewMessage ? 'instant' : 'smooth',
-    });
-  }, [messages, isStreaming]);
+    if (!container || (!isNewMessage && !pinnedRef.current)) return;
+    pinnedRef.current = true;
+    container.scrollTop = container.scrollHeight;
+  }, [container, messages, streaming?.content, totalHeight]);
 
   if (messages.length === 0) {
     return (
@@ -33,17 +47,19 @@ export default function MessageList({ messages, isStreaming }: Props) {
     );
   }
 
+  const lastId = messages[messages.length - 1].id;
+
   return (
-    <div className="flex-1 overflow-y-auto px-4 py-4">
-      <div className="mx-auto max-w-3xl space-y-4">
-        {messages.map((msg) => (
-          <MessageBubble
-            key={msg.id}
-            message={msg}
-            isStreaming={isStreaming && msg.id === messages[messages.length - 1].id && msg.role === 'assistant'}
-          />
+    <div ref={containerRef} onScroll={handleScroll} className="flex-1 overflow-y-auto px-4 py-4">
+      <div className="mx-auto max-w-3xl" style={{ paddingTop: padTop, paddingBottom: padBottom }}>
+        {messages.slice(start, end).map((msg) => (
+          <div key={msg.id} ref={measureRef} data-key={msg.id} className="pb-4">
+            <MessageBubble
+              message={streaming?.messageId === msg.id ? { ...msg, content: streaming.content } : msg}
+              isStreaming={isStreaming && msg.id === lastId && msg.role === 'assistant'}
+            />
+          </div>
         ))}
-        <div ref={endRef} />
       </div>
     </div>
   );
@@ -1,8 +1,9 @@
 import { useState, useEffect, useCallback } from 'react';
 import { useMutation, useQuery, useQueryClient } from '@tanstack/react-query';
-import { walletApi, clientApi, proxyApi, type WalletInfo, type UnstakeStatus } from '../lib/api';
+import { walletApi, clientApi, type WalletInfo, type UnstakeStatus } from '../lib/api';
 import { QK } from '../lib/queryKeys';
 import { usePollingInterval } from '../hooks/usePollingInterval';
+import { useJsonStats } from '../hooks/useJsonStats';
 import { Card, CardContent } from './ui/card';
 import { Input } from './ui/input';
 import { Button } from './ui/button';
@@ -71,12 +72,7 @@ export default function WithdrawAllForm({ info }: Props) {
   const isClientRunning = clientStatus?.running === true;
 
   // JsonStats — only when client is running
-  const { data: stats } = useQuery({
-    queryKey: QK.jsonStats,
-    queryFn: proxyApi.getJsonStats,
-    refetchInterval: pollingInterval,
-    enabled: isClientRunning,
-  });
+  const { data: stats } = useJsonStats(isClientRunning);
 
   // Unstake status polling
   const { data: unstakeStatus } = useQuery({
@@ -4,21 +4,21 @@ import { proxyApi } from '../lib/api';
 import { streamChat } from '../lib/stream';
 
 export function useChat() {
-  const {
-    conversations,
-    activeConversationId,
-    settings,
-    createConversation,
-    addMessage,
-    updateStreamingMessage,
-  } = useChatStore();
+  const activeConversationId = useChatStore((s) => s.activeConversationId);
+  const activeConversation = useChatStore((s) =>
+    s.conversations.find((c) => c.id === s.activeConversationId),
+  );
+  const streaming = useChatStore((s) => s.streaming);
+  const settings = useChatStore((s) => s.settings);
+  const createConversation = useChatStore((s) => s.createConversation);
+  const addMessage = useChatStore((s) => s.addMessage);
+  const startStreaming = useChatStore((s) => s.startStreaming);
+  const updateStreamingMessage = useChatStore((s) => s.updateStreamingMessage);
+  const finishStreaming = useChatStore((s) => s.finishStreaming);
 
   const [isStreaming, setIsStreaming] = useState(false);
   const abortRef = useRef<AbortController | null>(null);
-
-  const activeConversation = conversations.find(
-    (c) => c.id === activeConversationId,
-  );
+  const requestIdRef = useRef<string | null>(null);
 
   const sendMessage = useCallback(
     async (content: string) => {
@@ -42,12 +42,17 @@ export function useChat() {
 
       messages.push(...conv.messages.map((m) => ({ role: m.role, content: m.content })));
 
-      // Add empty assistant message for streaming
-      addMessage(convId, { role: 'assistant', content: '' });
+      // Add empty assistant message; tokens go to the store's streaming slot until done
+      const assistantId = crypto.randomUUID();
+      addMessage(convId, { id: assistantId, role: 'assistant', content: '' });
+      startStreaming(convId, assistantId);
 
       setIsStreaming(true);
       const controller = new AbortController();
       abortRef.current = controller;
+      const requestId = crypto.randomUUID();
+      requestIdRef.current = requestId;
+      let accumulated = '';
 
       try {
         const response = await proxyApi.chatCompletions(
@@ -58,6 +63,7 @@ export function useChat() {
             temperature: settings.temperature,
           },
           controller.signal,
+          requestId,
         );
 
         if (!response.ok) {
@@ -66,7 +72,6 @@ export function useChat() {
           return;
         }
 
-        let accumulated = '';
         for await (const chunk of streamChat(response)) {
           accumulated += chunk;
           updateStreamingMessage(convId, accumulated);
@@ -75,28 +80,37 @@ export function useChat() {
         if (err instanceof Error && err.name === 'AbortError') {
           // User stopped streaming
         } else {
-          const currentConv = useChatStore.getState().conversations.find((c) => c.id === convId);
-          const lastMsg = currentConv?.messages[currentConv.messages.length - 1];
           const errMsg = err instanceof Error ? err.message : 'Unknown error';
-          updateStreamingMessage(
-            convId,
-            (lastMsg?.content || '') + `\n\n[Error: ${errMsg}]`,
-          );
+          updateStreamingMessage(convId, accumulated + `\n\n[Error: ${errMsg}]`);
         }
       } finally {
+        finishStreaming();
         setIsStreaming(false);
         abortRef.current = null;
+        requestIdRef.current = null;
       }
     },
-    [activeConversationId, settings, createConversation, addMessage, updateStreamingMessage],
+    [
+      activeConversationId,
+      settings,
+      createConversation,
+      addMessage,
+      startStreaming,
+      updateStreamingMessage,
+      finishStreaming,
+    ],
   );
 
   const stopStreaming = useCallback(() => {
+    // Cancel upstream explicitly too — the abort alone only closes our side
+    const requestId = requestIdRef.current;
+    if (requestId) proxyApi.cancelChat(requestId).catch(() => {});
     abortRef.current?.abort();
   }, []);
 
   return {
     activeConversation,
+    streaming: streaming?.conversationId === activeConversationId ? streaming : null,
     isStreaming,
     sendMessage,
     stopStreaming,
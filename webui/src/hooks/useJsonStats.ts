@@ -0,0 +1,25 @@
+import { useQuery } from '@tanstack/react-query';
+import { proxyApi } from '../lib/api';
+import { QK } from '../lib/queryKeys';
+import { useSSEEvents } from './useSSEContext';
+import { usePollingInterval } from './usePollingInterval';
+
+/**
+ * Client-runner /jsonstats.
+ *
+ * While SSE is connected the server's stats publisher keeps the cache up to
+ * date (snapshot + patches, see useSSEQuerySync), so the query never polls
+ * and never goes stale. When SSE is down it falls back to regular polling.
+ */
+export function useJsonStats(enabled: boolean) {
+  const { connected } = useSSEEvents();
+  const pollingInterval = usePollingInterval();
+
+  return useQuery({
+    queryKey: QK.jsonStats,
+    queryFn: proxyApi.getJsonStats,
+    refetchInterval: connected ? false : pollingInterval,
+    staleTime: connected ? Infinity : 0,
+    enabled,
+  });
+}
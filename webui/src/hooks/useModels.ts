@@ -0,0 +1,24 @@
+import { useQuery } from '@tanstack/react-query';
+import { proxyApi } from '../lib/api';
+import { QK } from '../lib/queryKeys';
+import { useSSEEvents } from './useSSEContext';
+import { usePollingInterval } from './usePollingInterval';
+
+/**
+ * Client-runner /v1/models.
+ *
+ * Published with the stats snapshot / patches (see useSSEQuerySync), so
+ * like useJsonStats it only polls while SSE is down.
+ */
+export function useModels(enabled = true) {
+  const { connected } = useSSEEvents();
+  const pollingInterval = usePollingInterval();
+
+  return useQuery({
+    queryKey: QK.models,
+    queryFn: proxyApi.getModels,
+    refetchInterval: connected ? false : pollingInterval,
+    staleTime: connected ? Infinity : 0,
+    enabled,
+  });
+}
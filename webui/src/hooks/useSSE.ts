@@ -1,4 +1,5 @@
 import { useEffect, useRef, useState, useCallback } from 'react';
+import { isStatsMessage, type StatsMessage } from '../lib/jsonPatch';
 
 export interface SSEEvent {
   type: string;
@@ -8,29 +9,76 @@ export interface SSEEvent {
   timestamp: number;
 }
 
+/** Batched debug lines from the server's log aggregator. */
+interface LogBatch {
+  type: 'log_batch';
+  lines: { message: string; timestamp: number }[];
+  repeats: { message: string; count: number }[];
+  dropped: number;
+  timestamp: number;
+}
+
 const MAX_EVENTS = 100;
 
-export function useSSE(url: string = '/api/client/events', onEvent?: (event: SSEEvent) => void) {
+/** Expand a log batch into Event Log rows (repeats as "×N message"). */
+function expandLogBatch(batch: LogBatch): SSEEvent[] {
+  const rows: SSEEvent[] = batch.lines.map((line) => ({
+    type: 'log', level: 'debug', category: 'debug', message: line.message, timestamp: line.timestamp,
+  }));
+  for (const r of batch.repeats) {
+    rows.push({ type: 'log', level: 'debug', category: 'debug', message: `×${r.count} ${r.message}`, timestamp: batch.timestamp });
+  }
+  if (batch.dropped > 0) {
+    rows.push({ type: 'log', level: 'debug', category: 'debug', message: `${batch.dropped} more lines not shown`, timestamp: batch.timestamp });
+  }
+  return rows;
+}
+
+export function useSSE(
+  url: string = '/api/client/events',
+  onEvent?: (event: SSEEvent) => void,
+  onStats?: (message: StatsMessage) => void,
+) {
   const [events, setEvents] = useState<SSEEvent[]>([]);
   const [connected, setConnected] = useState(false);
   const esRef = useRef<EventSource | null>(null);
   const reconnectTimer = useRef<ReturnType<typeof setTimeout> | null>(null);
+  // Id of the last buffered event seen; reconnects resume after it
+  const lastEventId = useRef<string>('');
   const onEventRef = useRef(onEvent);
   onEventRef.current = onEvent;
+  const onStatsRef = useRef(onStats);
+  onStatsRef.current = onStats;
 
   const connect = useCallback(() => {
     if (esRef.current) {
       esRef.current.close();
     }
 
-    const es = new EventSource(url);
+    // A new EventSource does not send Last-Event-ID, so pass it as a query param
+    const resumeUrl = lastEventId.current
+      ? `${url}${url.includes('?') ? '&' : '?'}lastEventId=${encodeURIComponent(lastEventId.current)}`
+      : url;
+    const es = new EventSource(resumeUrl);
     esRef.current = es;
 
     es.onopen = () => setConnected(true);
 
     es.onmessage = (event) => {
+      if (event.lastEventId) lastEventId.current = event.lastEventId;
       try {
         const data = JSON.parse(event.data);
+        // Stats snapshots/patches are data, not log entries
+        if (isStatsMessage(data)) {
+          onStatsRef.current?.(data);
+          return;
+        }
+        // Log frames only feed the Event Log — they never trigger refetches
+        if (data.type === 'log_batch') {
+          const rows = expandLogBatch(data as LogBatch);
+          setEvents((prev) => [...prev, ...rows].slice(-MAX_EVENTS));
+          return;
+        }
         const sseEvent: SSEEvent = { ...data, timestamp: data.timestamp || Date.now() };
         setEvents((prev) => [...prev, sseEvent].slice(-MAX_EVENTS));
         onEventRef.current?.(sseEvent);
@@ -56,5 +104,12 @@ export function useSSE(url: string = '/api/client/events', onEvent?: (event: SSE
 
   const clearEvents = useCallback(() => setEvents([]), []);
 
-  return { events, connected, clearEvents };
+  // Reopen the stream now (resuming after the last event id); the server
+  // starts every stream with a stats snapshot
+  const reconnect = useCallback(() => {
+    if (reconnectTimer.current) clearTimeout(reconnectTimer.current);
+    connect();
+  }, [connect]);
+
+  return { events, connected, clearEvents, reconnect };
 }
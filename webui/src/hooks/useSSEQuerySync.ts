@@ -1,23 +1,26 @@
-import { useCallback } from 'react';
+import { useCallback, useRef } from 'react';
 import { useQueryClient } from '@tanstack/react-query';
 import { useSSE, type SSEEvent } from './useSSE';
 import { QK } from '../lib/queryKeys';
+import { applyPatch, type StatsMessage } from '../lib/jsonPatch';
+import type { JsonStats, ModelsResponse } from '../lib/api';
 
-const LIFECYCLE_QUERIES = [QK.clientStatus, QK.jsonStats, QK.models];
+// jsonStats and models arrive as stats_snapshot / stats_patch messages
+const LIFECYCLE_QUERIES = [QK.clientStatus];
 
 const EVENT_QUERY_MAP: Record<string, readonly (readonly string[])[]> = {
   starting: LIFECYCLE_QUERIES,
   stopping: LIFECYCLE_QUERIES,
-  stopped: LIFECYCLE_QUERIES,
-  fatal: LIFECYCLE_QUERIES,
-  exit: LIFECYCLE_QUERIES,
+  stopped: [...LIFECYCLE_QUERIES, QK.startupHistory],
+  fatal: [...LIFECYCLE_QUERIES, QK.startupHistory],
+  exit: [...LIFECYCLE_QUERIES, QK.startupHistory],
   initialized: LIFECYCLE_QUERIES,
-  connection_ready: [QK.clientStatus, QK.jsonStats, QK.models],
-  proxy_ready: [QK.clientStatus, QK.jsonStats, QK.models],
-  proxy_connecting: [QK.jsonStats],
-  staked: [QK.jsonStats, QK.walletInfo],
-  ton_synced: [QK.jsonStats, QK.walletInfo],
-  milestone: [QK.jsonStats, QK.walletInfo],
+  connection_ready: [QK.clientStatus],
+  proxy_ready: [QK.clientStatus],
+  proxy_connecting: [],
+  staked: [QK.walletInfo],
+  ton_synced: [QK.walletInfo],
+  milestone: [QK.walletInfo, QK.startupHistory],
   listening: [QK.clientStatus],
 };
 
@@ -38,5 +41,44 @@ export function useSSEQuerySync(url?: string) {
     [queryClient],
   );
 
-  return useSSE(url, onEvent);
+  // Patches apply on top of the last seq seen; a gap means one was missed
+  const seqRef = useRef<number | null>(null);
+  const reconnectRef = useRef<() => void>(() => {});
+
+  const onStats = useCallback(
+    (message: StatsMessage) => {
+      if (message.type === 'stats_snapshot') {
+        seqRef.current = message.seq;
+        if (message.stats) {
+          queryClient.setQueryData(QK.jsonStats, message.stats as JsonStats);
+        } else {
+          queryClient.removeQueries({ queryKey: QK.jsonStats });
+        }
+        if (message.models) {
+          queryClient.setQueryData(QK.models, message.models as ModelsResponse);
+        } else {
+          queryClient.removeQueries({ queryKey: QK.models });
+        }
+        return;
+      }
+      // Waiting for the snapshot of a resync already under way
+      if (seqRef.current === null) return;
+      const cached = queryClient.getQueryData<JsonStats>(QK.jsonStats);
+      if (message.seq !== seqRef.current + 1 || !cached) {
+        // The server replaces patches it drops with a snapshot, so this is
+        // rare; reconnecting gets a snapshot (and its seq) to resume from
+        seqRef.current = null;
+        reconnectRef.current();
+        return;
+      }
+      seqRef.current = message.seq;
+      queryClient.setQueryData(QK.jsonStats, applyPatch(cached, message.ops));
+      if (message.models) queryClient.setQueryData(QK.models, message.models as ModelsResponse);
+    },
+    [queryClient],
+  );
+
+  const sse = useSSE(url, onEvent, onStats);
+  reconnectRef.current = sse.reconnect;
+  return sse;
 }
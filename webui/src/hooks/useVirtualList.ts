@@ -0,0 +1,98 @@
+import { useCallback, useEffect, useRef, useState } from 'react';
+
+interface Options {
+  /** Height assumed for rows not measured yet (px) */
+  estimate?: number;
+  /** Extra height rendered above and below the viewport (px) */
+  overscan?: number;
+}
+
+/**
+ * Windowed rendering for a vertical list of variable-height rows.
+ *
+ * Rows are measured with a ResizeObserver once mounted (attach `measureRef`
+ * and `data-key` to each row). Only the rows intersecting the viewport,
+ * plus `overscan`, are in [start, end); `padTop`/`padBottom` stand in for
+ * the rest so the scrollbar keeps its size.
+ */
+export function useVirtualList<T extends HTMLElement>(keys: string[], { estimate = 120, overscan = 800 }: Options = {}) {
+  const [container, containerRef] = useState<T | null>(null);
+  const heights = useRef(new Map<string, number>());
+  const nodes = useRef(new Map<Element, string>());
+  const observer = useRef<ResizeObserver | null>(null);
+  const [, setVersion] = useState(0);
+  const [viewport, setViewport] = useState({ top: 0, height: 0 });
+
+  useEffect(() => {
+    const ro = new ResizeObserver((entries) => {
+      let changed = false;
+      for (const entry of entries) {
+        if (container && entry.target === container) {
+          setViewport({ top: container.scrollTop, height: container.clientHeight });
+          continue;
+        }
+        const key = nodes.current.get(entry.target);
+        if (!key) continue;
+        const height = (entry.target as HTMLElement).offsetHeight;
+        if (heights.current.get(key) !== height) {
+          heights.current.set(key, height);
+          changed = true;
+        }
+      }
+      if (changed) setVersion((v) => v + 1);
+    });
+    observer.current = ro;
+    if (container) ro.observe(container);
+    // Rows mounted before this effect ran
+    nodes.current.forEach((_, el) => ro.observe(el));
+    return () => {
+      ro.disconnect();
+      observer.current = null;
+    };
+  }, [container]);
+
+  const measureRef = useCallback((el: HTMLElement | null) => {
+    if (!el) return;
+    nodes.current.set(el, el.dataset.key ?? '');
+    observer.current?.observe(el);
+    return () => {
+      nodes.current.delete(el);
+      observer.current?.unobserve(el);
+    };
+  }, []);
+
+  const onScroll = useCallback(() => {
+    if (container) setViewport({ top: container.scrollTop, height: container.clientHeight });
+  }, [container]);
+
+  // Drop heights of rows that left the list
+  if (heights.current.size > keys.length * 2) {
+    const live = new Set(keys);
+    for (const key of heights.current.keys()) if (!live.has(key)) heights.current.delete(key);
+  }
+
+  const offsets: number[] = [];
+  let total = 0;
+  for (const key of keys) {
+    offsets.push(total);
+    total += heights.current.get(key) ?? estimate;
+  }
+  const from = viewport.top - overscan;
+  const to = viewport.top + viewport.height + overscan;
+  let start = 0;
+  while (start < keys.length - 1 && offsets[start] + (heights.current.get(keys[start]) ?? estimate) < from) start++;
+  let end = start;
+  while (end < keys.length && offsets[end] < to) end++;
+
+  return {
+    container,
+    containerRef,
+    measureRef,
+    onScroll,
+    start,
+    end,
+    padTop: offsets[start] ?? 0,
+    padBottom: total - (offsets[end] ?? total),
+    totalHeight: total,
+  };
+}
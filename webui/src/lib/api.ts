@@ -44,11 +44,69 @@ export interface TransferResult {
   status: 'sent' | 'confirmed' | 'timeout';
 }
 
+export interface ProxyConnectionState {
+  index: number;
+  address: string | null;
+  proxyScAddress: string | null;
+  ready: boolean;
+  seqno: number;
+  tokensPayed: number;
+}
+
+export type ClientPhase = 'stopped' | 'starting' | 'handshaking' | 'ready' | 'degraded';
+
+export interface ClientInstance {
+  instance: number;
+  httpPort: number;
+  startedAt: number;
+  phase: ClientPhase;
+  proxyReady: boolean;
+  inFlight: number;
+  connections: ProxyConnectionState[];
+  readyConnections: number;
+  /** Warm standby: only receives traffic while no serving instance is ready */
+  standby: boolean;
+}
+
+export interface SupervisorStatus {
+  enabled: boolean;
+  standby?: number[];
+  restarting?: { instance: number; at: number }[];
+}
+
 export interface ClientStatus {
   running: boolean;
+  phase?: ClientPhase;
   pid?: number;
   httpPort?: number;
   uptime?: number;
+  instances?: ClientInstance[];
+  supervisor?: SupervisorStatus;
+}
+
+export interface PhaseSummary {
+  count: number;
+  min: number | null;
+  max: number | null;
+  p50: number | null;
+  p95: number | null;
+}
+
+export interface StartupRun {
+  instance: number;
+  startedAt: number;
+  warm: boolean;
+  outcome: 'ready' | 'stopped' | 'crashed' | null;
+  /** ms after spawn, per phase reached */
+  phases: Record<string, number>;
+}
+
+export interface StartupHistory {
+  phases: string[];
+  summary: Record<string, PhaseSummary>;
+  warm: Record<string, PhaseSummary>;
+  cold: Record<string, PhaseSummary>;
+  runs: StartupRun[];
 }
 
 export interface ClientStartResult {
@@ -59,6 +117,9 @@ export interface ClientStartResult {
 export interface WalletBalanceInfo {
   address: string;
   balance: { nano: string; ton: string } | null;
+  /** null for non-wallet contracts or when the lookup failed */
+  seqno: number | null;
+  status: 'active' | 'uninit' | 'frozen' | 'nonexist' | null;
 }
 
 export interface WalletInfo {
@@ -102,6 +163,7 @@ export interface JsonStats {
     address: string;
     is_ready: boolean;
     proxy_sc_address: string;
+    seqno?: number;
   }>;
   proxies: Array<{
     proxy_sc_address: string;
@@ -136,6 +198,20 @@ export interface ModelsResponse {
   data: Model[];
 }
 
+/** GET /api/proxy/completion-cache — only `enabled` while the cache is off. */
+export interface CompletionCacheStats {
+  enabled: boolean;
+  hits?: number;
+  misses?: number;
+  stores?: number;
+  tokensSaved?: number;
+  hitRatio?: number;
+  entries?: number;
+  memoryBytes?: number;
+  diskEntries?: number;
+  diskBytes?: number;
+}
+
 // --- Fetch helper ---
 
 class ApiError extends Error {
@@ -194,7 +270,11 @@ export const setupApi = {
 
 export const clientApi = {
   getStatus: queryFn<ClientStatus>('/api/client/status'),
-  start: (opts?: { routerPolicy?: 'any' | 'tdx'; verbosity?: string }) =>
+  getStartupHistory: queryFn<StartupHistory>('/api/client/startup-history'),
+  start: (opts?: {
+    routerPolicy?: 'any' | 'tdx'; verbosity?: string; instances?: number;
+    supervise?: boolean; standby?: boolean;
+  }) =>
     post<ClientStartResult>('/api/client/start', opts),
   stop: () => post<{ status: 'stopping' }>('/api/client/stop'),
 };
@@ -204,6 +284,7 @@ export const clientApi = {
 export const proxyApi = {
   getJsonStats: queryFn<JsonStats>('/api/jsonstats'),
   getModels: queryFn<ModelsResponse>('/api/v1/models'),
+  getCompletionCache: queryFn<CompletionCacheStats>('/api/proxy/completion-cache'),
   chatCompletions: (
     body: {
       model: string;
@@ -212,16 +293,23 @@ export const proxyApi = {
       temperature?: number;
     },
     signal?: AbortSignal,
+    requestId?: string,
   ) =>
     fetch('/api/v1/chat/completions', {
       method: 'POST',
       headers: {
         'Content-Type': 'application/json',
         ...(AUTH_TOKEN ? { 'Authorization': `Bearer ${AUTH_TOKEN}` } : {}),
+        ...(requestId ? { 'X-Request-Id': requestId } : {}),
+        // Chat typed in the WebUI is served ahead of batch API callers
+        'X-Priority': 'interactive',
       },
       body: JSON.stringify({ ...body, stream: true }),
       signal,
     }),
+  /** Abort a streaming completion upstream (frees the client-runner right away). */
+  cancelChat: (requestId: string) =>
+    post<{ status: 'cancelled'; id: string }>(`/api/v1/chat/cancel/${encodeURIComponent(requestId)}`),
 };
 
 // --- Toncenter API ---
@@ -232,11 +320,26 @@ export interface ToncenterAction {
   timestamp: number;
   details: Record<string, string>;
   traceId: string;
+  /** Logical time, the index's sort key */
+  lt: string;
+}
+
+export interface HistoryResponse {
+  actions: ToncenterAction[];
+  /** Pass as `before` / `beforeId` for the next (older) page; null on the last page */
+  nextBeforeLt: string | null;
+  nextBeforeId: string | null;
+  /** False while older actions are still being backfilled */
+  complete: boolean;
 }
 
 export interface EarningsResponse {
   payouts: Array<{ type: string; amount: string; timestamp: number }>;
+  /** Sum over every indexed payout, not just the ones listed */
   totalNano: string;
+  count: number;
+  /** False while older actions are still being backfilled (the total is partial) */
+  complete: boolean;
 }
 
 export interface ConfirmResponse {
@@ -245,19 +348,46 @@ export interface ConfirmResponse {
 }
 
 export const toncenterApi = {
-  history: (limit = 20) => queryFn<{ actions: ToncenterAction[] }>(`/api/toncenter/history?limit=${limit}`),
+  history: (limit = 20, before?: { lt: string; id: string | null }) =>
+    queryFn<HistoryResponse>(
+      `/api/toncenter/history?limit=${limit}${before ? `&before=${before.lt}${before.id ? `&beforeId=${encodeURIComponent(before.id)}` : ''}` : ''}`,
+    ),
   earnings: queryFn<EarningsResponse>('/api/toncenter/earnings'),
-  confirm: (type: string, after: number) =>
-    request<ConfirmResponse>(`/api/toncenter/confirm?type=${encodeURIComponent(type)}&after=${after}`),
+  /** `wait` (seconds, max 60) holds the request until the action lands */
+  confirm: (type: string, after: number, wait = 0) =>
+    request<ConfirmResponse>(`/api/toncenter/confirm?type=${encodeURIComponent(type)}&after=${after}${wait ? `&wait=${wait}` : ''}`),
 };
 
 // --- Wallet API ---
 
+export interface UnstakeStepTimings {
+  [step: string]: number;
+}
+
+export interface UnstakeRun {
+  id: string;
+  status: 'running' | 'done' | 'failed';
+  startedAt: number;
+  completedAt: number | null;
+  error: string | null;
+  proxies: Array<{
+    address: string;
+    step: 'active' | 'close_sent' | 'closed' | 'withdraw_sent' | 'settled';
+    /** ms spent reaching each step */
+    timings: UnstakeStepTimings;
+    error: string | null;
+  }>;
+  transfer: { step: 'pending' | 'sent' | 'skipped' | 'confirmed'; seqno: number | null; timings: UnstakeStepTimings };
+}
+
 export interface UnstakeStatus {
   active: boolean;
   step: string | null;
   error: string | null;
   completedAt: number | null;
+  /** An interrupted / failed run that POST /api/wallet/unstake picks up */
+  resumable: boolean;
+  run: UnstakeRun | null;
 }
 
 export const walletApi = {
@@ -0,0 +1,115 @@
+import type { Conversation } from '../stores/chatStore';
+
+/**
+ * IndexedDB persistence for chat history: one record per conversation.
+ *
+ * Writes are queued per conversation and flushed together in a single
+ * transaction when the browser is idle (or the page is hidden), so
+ * nothing touches storage on the token path and a change to one
+ * conversation never rewrites the others.
+ */
+
+const DB_NAME = 'cocoon-chat';
+const DB_VERSION = 1;
+const STORE = 'conversations';
+const IDLE_TIMEOUT_MS = 1000;
+
+let dbPromise: Promise<IDBDatabase> | null = null;
+// conversation id → latest version to write, or null to delete
+const queue = new Map<string, Conversation | null>();
+let scheduled = false;
+let flushing: Promise<boolean> = Promise.resolve(true);
+
+function openDb(): Promise<IDBDatabase> {
+  if (!dbPromise) {
+    dbPromise = new Promise((resolve, reject) => {
+      const req = indexedDB.open(DB_NAME, DB_VERSION);
+      req.onupgradeneeded = () => {
+        if (!req.result.objectStoreNames.contains(STORE)) {
+          req.result.createObjectStore(STORE, { keyPath: 'id' });
+        }
+      };
+      req.onsuccess = () => resolve(req.result);
+      req.onerror = () => reject(req.error);
+    });
+    // A failed open (private mode, quota) is retried on the next call
+    dbPromise.catch(() => { dbPromise = null; });
+  }
+  return dbPromise;
+}
+
+/** All stored conversations, newest first. */
+export async function loadConversations(): Promise<Conversation[]> {
+  try {
+    const db = await openDb();
+    const all = await new Promise<Conversation[]>((resolve, reject) => {
+      const req = db.transaction(STORE, 'readonly').objectStore(STORE).getAll();
+      req.onsuccess = () => resolve(req.result as Conversation[]);
+      req.onerror = () => reject(req.error);
+    });
+    return all.sort((a, b) => b.createdAt - a.createdAt);
+  } catch {
+    return [];
+  }
+}
+
+function schedule() {
+  if (scheduled) return;
+  scheduled = true;
+  const run = () => { void flushChatDb(); };
+  if (typeof requestIdleCallback === 'function') requestIdleCallback(run, { timeout: IDLE_TIMEOUT_MS });
+  else setTimeout(run, 200);
+}
+
+/** Queue a conversation write; repeated saves before the flush collapse into one. */
+export function saveConversation(conversation: Conversation) {
+  queue.set(conversation.id, conversation);
+  schedule();
+}
+
+export function deleteStoredConversation(id: string) {
+  queue.set(id, null);
+  schedule();
+}
+
+/**
+ * Write everything queued so far in one transaction. Resolves to whether
+ * it committed; on failure the batch stays queued for the next flush.
+ */
+export function flushChatDb(): Promise<boolean> {
+  scheduled = false;
+  if (queue.size === 0) return flushing;
+  const batch = [...queue];
+  queue.clear();
+  flushing = flushing.then(async () => {
+    try {
+      const db = await openDb();
+      await new Promise<void>((resolve, reject) => {
+        const tx = db.transaction(STORE, 'readwrite');
+        const store = tx.objectStore(STORE);
+        for (const [id, conversation] of batch) {
+          if (conversation) store.put(conversation);
+          else store.delete(id);
+        }
+        tx.oncomplete = () => resolve();
+        tx.onerror = () => reject(tx.error);
+        tx.onabort = () => reject(tx.error);
+      });
+      return true;
+    } catch {
+      // Keep the batch for the next flush unless newer versions were queued meanwhile
+      for (const [id, conversation] of batch) {
+        if (!queue.has(id)) queue.set(id, conversation);
+      }
+      return false;
+    }
+  });
+  return flushing;
+}
+
+// Don't lose queued writes when the tab goes away
+if (typeof document !== 'undefined') {
+  document.addEventListener('visibilitychange', () => {
+    if (document.visibilityState === 'hidden') void flushChatDb();
+  });
+}
@@ -0,0 +1,69 @@
+// Client side of src/lib/json-diff.js — applies the add/remove/replace
+// operations streamed by the server's stats publisher.
+
+export interface PatchOp {
+  op: 'add' | 'remove' | 'replace';
+  path: string;
+  value?: unknown;
+}
+
+export interface StatsSnapshotMessage {
+  type: 'stats_snapshot';
+  seq: number;
+  instance: number | null;
+  stats: unknown;
+  /** /v1/models of the same instance */
+  models: unknown;
+}
+
+export interface StatsPatchMessage {
+  type: 'stats_patch';
+  seq: number;
+  instance: number;
+  ops: PatchOp[];
+  /** Present (whole) only when /v1/models changed */
+  models?: unknown;
+}
+
+export type StatsMessage = StatsSnapshotMessage | StatsPatchMessage;
+
+export function isStatsMessage(data: { type?: unknown }): data is StatsMessage {
+  return data.type === 'stats_snapshot' || data.type === 'stats_patch';
+}
+
+type Container = Record<string, unknown> | unknown[];
+
+function unescapeToken(token: string): string {
+  return token.replaceAll('~1', '/').replaceAll('~0', '~');
+}
+
+function setIn(node: unknown, tokens: string[], op: PatchOp['op'], value: unknown): Container {
+  const [head, ...rest] = tokens;
+  const copy: Container = Array.isArray(node) ? [...node] : { ...(node as Record<string, unknown>) };
+  const record = copy as Record<string, unknown>;
+  if (rest.length === 0) {
+    if (op === 'remove') {
+      if (Array.isArray(copy)) copy.splice(Number(head), 1);
+      else delete record[head];
+    } else {
+      record[head] = value;
+    }
+    return copy;
+  }
+  const child = (node as Record<string, unknown> | undefined)?.[head];
+  record[head] = setIn(child ?? {}, rest, op, value);
+  return copy;
+}
+
+/** Apply patch operations without mutating `doc` (unchanged subtrees are shared). */
+export function applyPatch<T>(doc: T, ops: PatchOp[]): T {
+  let root: unknown = doc;
+  for (const { op, path, value } of ops) {
+    if (path === '') {
+      root = op === 'remove' ? undefined : value;
+      continue;
+    }
+    root = setIn(root, path.slice(1).split('/').map(unescapeToken), op, value);
+  }
+  return root as T;
+}
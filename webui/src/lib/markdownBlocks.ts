@@ -0,0 +1,35 @@
+/**
+ * Split markdown into top-level blocks at blank lines outside fenced code.
+ *
+ * While a reply streams only its last block can still change, so the
+ * blocks before it are rendered once and memoized instead of re-parsing
+ * the whole reply on every token. Indented lines after a blank line
+ * continue the previous block (list items, nested content).
+ */
+export function splitMarkdownBlocks(text: string): string[] {
+  const blocks: string[] = [];
+  let fence: string | null = null;
+  let start = 0;
+  let blankAt: number | null = null;
+  for (let pos = 0; pos < text.length; ) {
+    let eol = text.indexOf('\n', pos);
+    if (eol === -1) eol = text.length;
+    const line = text.slice(pos, eol);
+    const marker = line.match(/^ {0,3}(`{3,}|~{3,})/)?.[1];
+    if (fence) {
+      if (marker && marker[0] === fence[0] && marker.length >= fence.length) fence = null;
+    } else if (line.trim() === '') {
+      blankAt ??= pos;
+    } else {
+      if (blankAt !== null && !/^[ \t]/.test(line)) {
+        if (blankAt > start) blocks.push(text.slice(start, blankAt));
+        start = pos;
+      }
+      blankAt = null;
+      if (marker) fence = marker;
+    }
+    pos = eol + 1;
+  }
+  if (start < text.length) blocks.push(text.slice(start));
+  return blocks;
+}
@@ -1,9 +1,11 @@
 export const QK = {
   setupStatus: ['setupStatus'] as const,
   clientStatus: ['clientStatus'] as const,
+  startupHistory: ['startupHistory'] as const,
   jsonStats: ['jsonStats'] as const,
   walletInfo: ['walletInfo'] as const,
   models: ['models'] as const,
+  completionCache: ['completionCache'] as const,
   balance: ['balance'] as const,
   txHistory: ['txHistory'] as const,
   earnings: ['earnings'] as const,
@@ -1,8 +1,6 @@
-import { useQuery } from '@tanstack/react-query';
-import { proxyApi } from '../lib/api';
 import { useChatStore } from '../stores/chatStore';
 import { useChat } from '../hooks/useChat';
-import { usePollingInterval } from '../hooks/usePollingInterval';
+import { useModels } from '../hooks/useModels';
 import MessageList from '../components/MessageList';
 import ChatInput from '../components/ChatInput';
 import { Select } from '../components/ui/select';
@@ -13,7 +11,7 @@ import cocoonAnim from '../assets/cocoon.json';
 import { useEffect, useState } from 'react';
 
 export default function ChatContainer() {
-  const { activeConversation, isStreaming, sendMessage, stopStreaming } = useChat();
+  const { activeConversation, streaming, isStreaming, sendMessage, stopStreaming } = useChat();
   const settings = useChatStore(s => s.settings);
   const setModel = useChatStore(s => s.setModel);
   const toggleNoThink = useChatStore(s => s.toggleNoThink);
@@ -21,13 +19,8 @@ export default function ChatContainer() {
   const clearConversation = useChatStore(s => s.clearConversation);
   const activeConversationId = useChatStore(s => s.activeConversationId);
   const [showSettings, setShowSettings] = useState(false);
-  const pollingInterval = usePollingInterval();
 
-  const { data: models } = useQuery({
-    queryKey: ['models'],
-    queryFn: proxyApi.getModels,
-    refetchInterval: pollingInterval,
-  });
+  const { data: models } = useModels();
 
   // Auto-select first model if none selected
   useEffect(() => {
@@ -118,6 +111,7 @@ export default function ChatContainer() {
         ) : (
           <MessageList
             messages={activeConversation?.messages ?? []}
+            streaming={streaming}
             isStreaming={isStreaming}
           />
         )}
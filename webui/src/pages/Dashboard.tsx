@@ -6,10 +6,13 @@ import { QK } from '../lib/queryKeys';
 import { Skeleton } from '../components/ui/skeleton';
 import { useSSEEvents } from '../hooks/useSSEContext';
 import { usePollingInterval } from '../hooks/usePollingInterval';
+import { useJsonStats } from '../hooks/useJsonStats';
+import { useModels } from '../hooks/useModels';
 import { cn } from '../lib/utils';
 import { Loader2, AlertTriangle, CheckCircle2, Circle, ChevronDown } from 'lucide-react';
 import TransactionsCard from './dashboard/TransactionsCard';
 import EventLog from './dashboard/EventLog';
+import StartupHistoryCard from './dashboard/StartupHistoryCard';
 
 // Lifecycle steps — derived from jsonstats, shown as a vertical timeline
 const LIFECYCLE_STEPS = [
@@ -29,8 +32,9 @@ function derivePhaseFromStats(
   // Phase 1: TON synced
   if (!(stats.status?.ton_last_synced_at > 0)) return 0;
   // Phase 2: Registering (waiting for proxy connection or stake)
-  const staked = (stats.proxies?.[0]?.tokens_payed ?? 0) > 0;
-  const proxyReady = stats.proxy_connections?.[0]?.is_ready === true;
+  // Any ready connection / any staked proxy counts — the binary keeps several open
+  const staked = stats.proxies?.some(p => (p.tokens_payed ?? 0) > 0) === true;
+  const proxyReady = stats.proxy_connections?.some(pc => pc.is_ready) === true;
   if (!staked && !proxyReady) return 2;
   // Phase 3: Staking (stake deposited, waiting for proxy to accept)
   if (staked && !proxyReady) return 3;
@@ -52,12 +56,7 @@ export default function Dashboard() {
 
   const isRunning = clientStatus?.running === true;
 
-  const { data: stats } = useQuery({
-    queryKey: QK.jsonStats,
-    queryFn: proxyApi.getJsonStats,
-    refetchInterval: pollingInterval,
-    enabled: isRunning,
-  });
+  const { data: stats } = useJsonStats(isRunning);
 
   const { data: walletInfo, isLoading: walletLoading } = useQuery({
     queryKey: QK.walletInfo,
@@ -65,9 +64,11 @@ export default function Dashboard() {
     refetchInterval: pollingInterval,
   });
 
-  const { data: models } = useQuery({
-    queryKey: QK.models,
-    queryFn: proxyApi.getModels,
+  const { data: models } = useModels(isRunning);
+
+  const { data: completionCache } = useQuery({
+    queryKey: QK.completionCache,
+    queryFn: proxyApi.getCompletionCache,
     enabled: isRunning,
     refetchInterval: pollingInterval,
   });
@@ -121,11 +122,13 @@ export default function Dashboard() {
   }, [isRunning, isFullyReady]);
 
   // Proxy details from jsonstats
-  const proxyConn = stats?.proxy_connections?.[0];
-  const proxyInfo = stats?.proxies?.[0];
+  const proxyConns = stats?.proxy_connections ?? [];
+  const readyConnCount = proxyConns.filter(pc => pc.is_ready).length;
+  const proxyConn = proxyConns.find(pc => pc.is_ready) ?? proxyConns[0];
+  const proxyInfo = stats?.proxies?.find(p => p.proxy_sc_address === proxyConn?.proxy_sc_address) ?? stats?.proxies?.[0];
   const pricePerToken = stats?.root_contract_config?.price_per_token ?? 0;
   const tokensToTon = (tokens: number) => (tokens * pricePerToken / 1e9).toFixed(4);
-  const isProxyReady = proxyConn?.is_ready === true;
+  const isProxyReady = readyConnCount > 0;
   const isStaked = (proxyInfo?.tokens_payed ?? 0) > 0;
 
 
@@ -174,6 +177,23 @@ export default function Dashboard() {
                   <span className="font-mono tabular-nums tracking-tight">:{clientStatus.httpPort}</span>
                 )}
               </div>
+              {(clientStatus?.instances?.length ?? 0) > 1 && (
+                <div className="mt-2.5 space-y-1">
+                  {clientStatus!.instances!.map((inst) => (
+                    <div key={inst.instance} className="flex items-center justify-between text-xs">
+                      <span className="flex items-center gap-1.5 text-[var(--text-secondary)]">
+                        <span className={cn('h-1.5 w-1.5 rounded-full', inst.phase === 'ready' ? 'bg-[var(--green-pastel)]' : inst.phase === 'degraded' ? 'bg-[var(--amber-pastel)]' : 'bg-[var(--accent-pastel)] animate-pulse')} />
+                        #{inst.instance}
+                        <span className="font-mono tabular-nums text-[var(--text-muted)]">:{inst.httpPort}</span>
+                      </span>
+                      <span className="font-mono tabular-nums tracking-tight text-[var(--text-muted)]">
+                        {inst.connections.length > 1 && `${inst.readyConnections}/${inst.connections.length} conn · `}
+                        {inst.inFlight} in flight
+                      </span>
+                    </div>
+                  ))}
+                </div>
+              )}
             </>
           ) : (
             <>
@@ -286,7 +306,7 @@ export default function Dashboard() {
               isProxyReady ? (
                 <span className="inline-flex items-center gap-1.5 rounded-full bg-[var(--green-pastel-bg)] px-2.5 py-0.5 text-[11px] font-medium text-[var(--green-pastel)]">
                   <span className="h-1.5 w-1.5 rounded-full bg-[var(--green-pastel)]" />
-                  Connected
+                  {proxyConns.length > 1 ? `${readyConnCount}/${proxyConns.length} connected` : 'Connected'}
                 </span>
               ) : (
                 <span className="inline-flex items-center gap-1.5 rounded-full bg-[var(--accent-pastel-bg)] px-2.5 py-0.5 text-[11px] font-medium text-[var(--accent-pastel)]">
@@ -329,6 +349,17 @@ export default function Dashboard() {
                       <span className="ml-1.5 text-[var(--text-muted)]">{(proxyInfo.tokens_used_proxy_max ?? 0).toLocaleString()} tok</span>
                     </span>
                   </div>
+                  {completionCache?.enabled && (
+                    <div className="flex items-center justify-between">
+                      <span className="text-xs text-[var(--text-secondary)]">Cache saved</span>
+                      <span className="font-mono text-xs tabular-nums tracking-tight text-[var(--text-primary)]">
+                        {tokensToTon(completionCache.tokensSaved ?? 0)} TON
+                        <span className="ml-1.5 text-[var(--text-muted)]">
+                          {(completionCache.tokensSaved ?? 0).toLocaleString()} tok · {((completionCache.hitRatio ?? 0) * 100).toFixed(0)}% hits
+                        </span>
+                      </span>
+                    </div>
+                  )}
                   {proxyInfo.tokens_payed > 0 && (() => {
                     const remaining = Math.min(100, Math.max(0, ((proxyInfo.tokens_payed - (proxyInfo.tokens_used_proxy_max ?? 0)) / proxyInfo.tokens_payed) * 100));
                     return (
@@ -354,7 +385,16 @@ export default function Dashboard() {
                   {stats.root_contract_config?.registered_proxies?.length ?? 0} proxies
                 </span>
               </div>
-              {proxyConn?.address && (
+              {proxyConns.length > 1 ? (
+                <div className="space-y-1">
+                  {proxyConns.map((pc, i) => (
+                    <div key={i} className="flex items-center gap-1.5 text-[11px]">
+                      <span className={cn('h-1.5 w-1.5 shrink-0 rounded-full', pc.is_ready ? 'bg-[var(--green-pastel)]' : 'bg-[var(--accent-pastel)] animate-pulse')} />
+                      <span className="truncate font-mono text-[var(--text-muted)]">{pc.address || `connection ${i + 1}`}</span>
+                    </div>
+                  ))}
+                </div>
+              ) : proxyConn?.address && (
                 <p className="truncate font-mono text-[11px] text-[var(--text-muted)]">{proxyConn.address}</p>
               )}
             </div>
@@ -399,6 +439,9 @@ export default function Dashboard() {
         </div>
       )}
 
+      {/* Launch timings (p50/p95 per phase) */}
+      <StartupHistoryCard />
+
       {/* On-Chain Activity */}
       <TransactionsCard />
     </div>
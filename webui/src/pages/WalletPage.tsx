@@ -1,9 +1,10 @@
 import { useState } from 'react';
 import { useQuery } from '@tanstack/react-query';
-import { walletApi, proxyApi, clientApi } from '../lib/api';
+import { walletApi, clientApi } from '../lib/api';
 import { formatTon } from '../lib/format';
 import { QK } from '../lib/queryKeys';
 import { usePollingInterval } from '../hooks/usePollingInterval';
+import { useJsonStats } from '../hooks/useJsonStats';
 import { Skeleton } from '../components/ui/skeleton';
 import { cn } from '../lib/utils';
 import StakeForm from '../components/StakeForm';
@@ -31,12 +32,7 @@ export default function WalletPage() {
     refetchInterval: pollingInterval,
   });
 
-  const { data: stats } = useQuery({
-    queryKey: QK.jsonStats,
-    queryFn: proxyApi.getJsonStats,
-    refetchInterval: pollingInterval,
-    enabled: clientStatus?.running === true,
-  });
+  const { data: stats } = useJsonStats(clientStatus?.running === true);
 
   const ownerBal = info?.owner.balance ? formatTon(info.owner.balance.nano) : '0';
   const nodeBal = info?.cocoon.balance ? formatTon(info.cocoon.balance.nano) : '0';
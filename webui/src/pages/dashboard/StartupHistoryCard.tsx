@@ -0,0 +1,79 @@
+import { useQuery } from '@tanstack/react-query';
+import { clientApi, type StartupRun } from '../../lib/api';
+import { QK } from '../../lib/queryKeys';
+import { cn } from '../../lib/utils';
+
+const PHASE_LABELS: Record<string, string> = {
+  ton_synced: 'TON synced',
+  initialized: 'Initialized',
+  proxy_connecting: 'Proxy connecting',
+  proxy_ready: 'Proxy handshake',
+  first_seqno: 'First seqno',
+  stake_visible: 'Stake visible',
+  ready: 'Ready',
+};
+
+function formatMs(ms: number | null | undefined): string {
+  if (ms == null) return '—';
+  if (ms < 1000) return `${Math.round(ms)}ms`;
+  return `${(ms / 1000).toFixed(1)}s`;
+}
+
+const OUTCOME_CLASS: Record<NonNullable<StartupRun['outcome']>, string> = {
+  ready: 'text-[var(--green)]',
+  stopped: 'text-[var(--text-muted)]',
+  crashed: 'text-[var(--red)]',
+};
+
+export default function StartupHistoryCard() {
+  const { data } = useQuery({
+    queryKey: QK.startupHistory,
+    queryFn: clientApi.getStartupHistory,
+    staleTime: 60_000,
+  });
+
+  if (!data || data.runs.length === 0) return null;
+  const last = data.runs[0];
+
+  return (
+    <div className="glass-card p-5">
+      <div className="mb-3 flex items-center justify-between">
+        <span className="text-[15px] font-semibold tracking-[-0.01em] text-[var(--text-primary)]">
+          Startup History
+        </span>
+        <span className="text-[11px] text-[var(--text-muted)]">
+          {data.runs.length} run{data.runs.length === 1 ? '' : 's'}
+        </span>
+      </div>
+
+      <table className="w-full text-sm">
+        <thead>
+          <tr className="text-left text-[11px] uppercase tracking-wide text-[var(--text-muted)]">
+            <th className="pb-1.5 font-medium">Phase</th>
+            <th className="pb-1.5 text-right font-medium">Last</th>
+            <th className="pb-1.5 text-right font-medium">p50</th>
+            <th className="pb-1.5 text-right font-medium">p95</th>
+          </tr>
+        </thead>
+        <tbody>
+          {data.phases.map((phase) => {
+            const s = data.summary[phase];
+            return (
+              <tr key={phase} className="border-t border-[var(--separator)]">
+                <td className="py-1.5 text-[var(--text-secondary)]">{PHASE_LABELS[phase] ?? phase}</td>
+                <td className="py-1.5 text-right font-mono tabular-nums text-[var(--text-primary)]">{formatMs(last.phases[phase])}</td>
+                <td className="py-1.5 text-right font-mono tabular-nums text-[var(--text-muted)]">{formatMs(s?.p50)}</td>
+                <td className="py-1.5 text-right font-mono tabular-nums text-[var(--text-muted)]">{formatMs(s?.p95)}</td>
+              </tr>
+            );
+          })}
+        </tbody>
+      </table>
+
+      <p className="mt-2 text-[11px] text-[var(--text-muted)]">
+        Last run: {new Date(last.startedAt).toLocaleString()} · {last.warm ? 'warm' : 'cold'} start ·{' '}
+        <span className={cn(last.outcome && OUTCOME_CLASS[last.outcome])}>{last.outcome ?? 'in progress'}</span>
+      </p>
+    </div>
+  );
+}
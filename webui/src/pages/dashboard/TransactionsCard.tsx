@@ -73,6 +73,8 @@ export default function TransactionsCard() {
 
   const actions: ToncenterAction[] = historyData?.actions?.slice(0, 10) ?? [];
   const earnedTon = earningsData?.totalNano ? formatTon(earningsData.totalNano) : '0';
+  // The index is still backfilling older actions: the total is a lower bound
+  const earnedPartial = earningsData ? !earningsData.complete : false;
 
   return (
     <div className="glass-card p-5">
@@ -82,7 +84,7 @@ export default function TransactionsCard() {
           On-Chain Activity
         </span>
         <span className="font-mono text-xs tabular-nums tracking-tight text-[var(--green)]">
-          Earned: {earnedTon} TON
+          Earned: {earnedPartial ? '≥ ' : ''}{earnedTon} TON
         </span>
       </div>
 
@@ -1,5 +1,6 @@
 import { create } from 'zustand';
 import { persist } from 'zustand/middleware';
+import { deleteStoredConversation, flushChatDb, loadConversations, saveConversation } from '../lib/chatDb';
 
 export interface ChatMessage {
   id: string;
@@ -20,27 +21,44 @@ interface ChatSettings {
   temperature: number;
 }
 
+/** The assistant reply being streamed; merged into its conversation once, on finish. */
+export interface StreamingMessage {
+  conversationId: string;
+  messageId: string;
+  content: string;
+}
+
 interface ChatState {
   conversations: Conversation[];
   activeConversationId: string | null;
   settings: ChatSettings;
+  streaming: StreamingMessage | null;
 
   createConversation: () => string;
   deleteConversation: (id: string) => void;
   setActiveConversation: (id: string | null) => void;
   addMessage: (conversationId: string, message: Omit<ChatMessage, 'id'> & { id?: string }) => void;
+  startStreaming: (conversationId: string, messageId: string) => void;
   updateStreamingMessage: (conversationId: string, content: string) => void;
+  finishStreaming: () => void;
   setModel: (model: string) => void;
   toggleNoThink: () => void;
   setTemperature: (temp: number) => void;
   clearConversation: (id: string) => void;
 }
 
+// Latest streamed content not yet rendered; flushed once per animation frame
+let pendingContent: string | null = null;
+let frame: number | null = null;
+// Histories from older versions, kept in localStorage until IndexedDB holds them
+let legacyConversations: Conversation[] | null = null;
+
 export const useChatStore = create<ChatState>()(
   persist(
-    (set) => ({
+    (set, get) => ({
       conversations: [],
       activeConversationId: null,
+      streaming: null,
       settings: {
         model: '',
         noThink: false,
@@ -93,16 +111,39 @@ export const useChatStore = create<ChatState>()(
         }));
       },
 
+      startStreaming: (conversationId, messageId) => {
+        pendingContent = null;
+        set({ streaming: { conversationId, messageId, content: '' } });
+      },
+
       updateStreamingMessage: (conversationId, content) => {
+        if (get().streaming?.conversationId !== conversationId) return;
+        pendingContent = content;
+        if (frame !== null) return;
+        frame = requestAnimationFrame(() => {
+          frame = null;
+          const streaming = get().streaming;
+          if (!streaming || pendingContent === null) return;
+          set({ streaming: { ...streaming, content: pendingContent } });
+          pendingContent = null;
+        });
+      },
+
+      finishStreaming: () => {
+        if (frame !== null) cancelAnimationFrame(frame);
+        frame = null;
+        const streaming = get().streaming;
+        if (!streaming) return;
+        const content = pendingContent ?? streaming.content;
+        pendingContent = null;
         set((state) => ({
+          streaming: null,
           conversations: state.conversations.map((c) => {
-            if (c.id !== conversationId) return c;
-            const messages = [...c.messages];
-            const last = messages[messages.length - 1];
-            if (last && last.role === 'assistant') {
-              messages[messages.length - 1] = { ...last, content };
-            }
-            return { ...c, messages };
+            if (c.id !== streaming.conversationId) return c;
+            return {
+              ...c,
+              messages: c.messages.map((m) => (m.id === streaming.messageId ? { ...m, content } : m)),
+            };
           }),
         }));
       },
@@ -131,6 +172,53 @@ export const useChatStore = create<ChatState>()(
     }),
     {
       name: 'cocoon-chat',
+      // History lives in IndexedDB (see lib/chatDb); localStorage keeps only the small bits
+      partialize: (state) => ({
+        activeConversationId: state.activeConversationId,
+        settings: state.settings,
+        ...(legacyConversations ? { conversations: legacyConversations } : {}),
+      }),
     },
   ),
 );
+
+// Mirror history changes into IndexedDB, one record per changed conversation
+let hydrating = false;
+useChatStore.subscribe((state, prev) => {
+  if (hydrating || state.conversations === prev.conversations) return;
+  const before = new Map(prev.conversations.map((c) => [c.id, c]));
+  for (const c of state.conversations) {
+    if (before.get(c.id) !== c) saveConversation(c);
+    before.delete(c.id);
+  }
+  for (const id of before.keys()) deleteStoredConversation(id);
+});
+
+// Histories persisted by older versions came back from localStorage: move them over
+const legacy = useChatStore.getState().conversations;
+if (legacy.length) {
+  legacyConversations = legacy;
+  legacy.forEach(saveConversation);
+  // Rewrite localStorage without them only once the transaction committed;
+  // if IndexedDB is unavailable they stay there and migrate on a later load
+  void flushChatDb().then((committed) => {
+    if (!committed) return;
+    legacyConversations = null;
+    useChatStore.setState({});
+  });
+}
+
+void loadConversations().then((stored) => {
+  if (stored.length === 0) return;
+  hydrating = true;
+  useChatStore.setState((state) => {
+    const known = new Set(state.conversations.map((c) => c.id));
+    const conversations = [...state.conversations, ...stored.filter((c) => !known.has(c.id))]
+      .sort((a, b) => b.createdAt - a.createdAt);
+    const activeConversationId = conversations.some((c) => c.id === state.activeConversationId)
+      ? state.activeConversationId
+      : conversations[0]?.id ?? null;
+    return { conversations, activeConversationId };
+  });
+  hydrating = false;
+});